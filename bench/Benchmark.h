@@ -85,6 +85,10 @@ public:
                              skia_private::TArray<SkString>* keys,
                              skia_private::TArray<double>* values) {}
 
+    // Results other than time (e.g. the size of an encoder's output), logged with the timings.
+    virtual void getMetrics(skia_private::TArray<SkString>* keys,
+                            skia_private::TArray<double>* values) {}
+
     // Replaces the GrRecordingContext's dmsaaStats() with a single frame of this benchmark.
     virtual bool getDMSAAStats(GrRecordingContext*) { return false; }
 
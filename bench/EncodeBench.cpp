@@ -7,6 +7,7 @@
 
 #include "bench/Benchmark.h"
 #include "include/core/SkBitmap.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkStream.h"
 #include "include/encode/SkJpegEncoder.h"
 #include "include/encode/SkPngEncoder.h"
@@ -33,6 +34,18 @@ public:
 
     void onDelayedSetup() override {
         SkAssertResult(ToolUtils::GetResourceAsBitmap(fSourceFilename, &fBitmap));
+
+        SkPixmap pixmap;
+        SkAssertResult(fBitmap.peekPixels(&pixmap));
+        SkNullWStream dst;
+        SkAssertResult(fEncoder(&dst, pixmap));
+        fEncodedBytes = dst.bytesWritten();
+    }
+
+    void getMetrics(skia_private::TArray<SkString>* keys,
+                    skia_private::TArray<double>* values) override {
+        keys->push_back(SkString("bytes"));
+        values->push_back(fEncodedBytes);
     }
 
     void onDraw(int loops, SkCanvas*) override {
@@ -50,6 +63,7 @@ private:
     Encoder     fEncoder;
     SkString    fName;
     SkBitmap    fBitmap;
+    size_t      fEncodedBytes = 0;
 };
 
 static bool encode_jpeg(SkWStream* dst, const SkPixmap& src) {
@@ -58,6 +72,14 @@ static bool encode_jpeg(SkWStream* dst, const SkPixmap& src) {
     return SkJpegEncoder::Encode(dst, src, opts);
 }
 
+static bool encode_jpeg_threaded(SkWStream* dst, const SkPixmap& src) {
+    static SkExecutor* executor = SkExecutor::MakeFIFOThreadPool().release();
+    SkJpegEncoder::Options opts;
+    opts.fQuality = 90;
+    opts.fExecutor = executor;
+    return SkJpegEncoder::Encode(dst, src, opts);
+}
+
 static bool encode_webp_lossy(SkWStream* dst, const SkPixmap& src) {
     SkWebpEncoder::Options opts;
     opts.fCompression = SkWebpEncoder::Compression::kLossy;
@@ -85,11 +107,31 @@ static bool encode_png(SkWStream* dst,
 #define PNG(FLAG, ZLIBLEVEL) [](SkWStream* d, const SkPixmap& s) { \
            return encode_png(d, s, SkPngEncoder::FilterFlag::FLAG, ZLIBLEVEL); }
 
-static const char* srcs[2] = {"images/mandrill_512.png", "images/color_wheel.jpg"};
+static bool encode_png_fast(SkWStream* dst, const SkPixmap& src) {
+    SkPngEncoder::Options opts;
+    opts.fProfile = SkPngEncoder::Profile::kFast;
+    return SkPngEncoder::Encode(dst, src, opts);
+}
+
+static bool encode_png_threaded(SkWStream* dst, const SkPixmap& src, int zlibLevel) {
+    static SkExecutor* executor = SkExecutor::MakeFIFOThreadPool().release();
+    SkPngEncoder::Options opts;
+    opts.fZLibLevel = zlibLevel;
+    opts.fExecutor = executor;
+    return SkPngEncoder::Encode(dst, src, opts);
+}
+
+#define PNG_THREADED(ZLIBLEVEL) [](SkWStream* d, const SkPixmap& s) { \
+           return encode_png_threaded(d, s, ZLIBLEVEL); }
+
+static const char* srcs[3] = {"images/mandrill_512.png", "images/color_wheel.jpg",
+                              "images/text.png"};
 
 // The Android Photos app uses a quality of 90 on JPEG encodes
 DEF_BENCH(return new EncodeBench(srcs[0], &encode_jpeg, "JPEG"));
 DEF_BENCH(return new EncodeBench(srcs[1], &encode_jpeg, "JPEG"));
+DEF_BENCH(return new EncodeBench(srcs[0], &encode_jpeg_threaded, "JPEG_threaded"));
+DEF_BENCH(return new EncodeBench(srcs[1], &encode_jpeg_threaded, "JPEG_threaded"));
 
 // TODO: What is the appropriate quality to use to benchmark WEBP encodes?
 DEF_BENCH(return new EncodeBench(srcs[0], encode_webp_lossy, "WEBP"));
@@ -122,4 +164,17 @@ DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 6), "PNG_6n"));
 DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 3), "PNG_3n"));
 DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 1), "PNG_1n"));
 
+// Filters and compresses bands of rows in parallel. Compare with PNG and PNG_1 above.
+DEF_BENCH(return new EncodeBench(srcs[0], PNG_THREADED(6), "PNG_threaded"));
+DEF_BENCH(return new EncodeBench(srcs[0], PNG_THREADED(1), "PNG_1_threaded"));
+DEF_BENCH(return new EncodeBench(srcs[1], PNG_THREADED(6), "PNG_threaded"));
+DEF_BENCH(return new EncodeBench(srcs[1], PNG_THREADED(1), "PNG_1_threaded"));
+
+// Screenshot-like content, where the fast profile should shine. Compare speed and size with PNG.
+DEF_BENCH(return new EncodeBench(srcs[2], PNG(kAll, 6), "PNG"));
+DEF_BENCH(return new EncodeBench(srcs[2], encode_png_fast, "PNG_fast"));
+DEF_BENCH(return new EncodeBench(srcs[0], encode_png_fast, "PNG_fast"));
+DEF_BENCH(return new EncodeBench(srcs[1], encode_png_fast, "PNG_fast"));
+
+#undef PNG_THREADED
 #undef PNG
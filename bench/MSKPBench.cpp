@@ -7,8 +7,10 @@
 
 #include "bench/MSKPBench.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkData.h"
 #include "include/gpu/GrDirectContext.h"
 #include "include/gpu/GrRecordingContext.h"
+#include "include/utils/SkPictureDelta.h"
 #include "tools/MSKPPlayer.h"
 
 MSKPBench::MSKPBench(SkString name, std::unique_ptr<MSKPPlayer> player)
@@ -48,3 +50,30 @@ void MSKPBench::onPostDraw(SkCanvas*) {
     // nanobench can tear down the 3D API context/device before destroying the benchmarks.
     fPlayer->resetLayers();
 }
+
+MSKPDeltaBench::MSKPDeltaBench(SkString name, std::vector<sk_sp<SkPicture>> frames)
+        : fName(std::move(name)), fFrames(std::move(frames)) {
+    SkASSERT(!fFrames.empty());
+    SkPictureDeltaEncoder encoder;
+    for (const sk_sp<SkPicture>& frame : fFrames) {
+        fDeltaBytes += encoder.encode(frame.get())->size();
+        fFullBytes += frame->serialize()->size();
+    }
+}
+
+bool MSKPDeltaBench::isSuitableFor(Backend backend) {
+    return backend == Backend::kNonRendering;
+}
+
+void MSKPDeltaBench::onDraw(int loops, SkCanvas*) {
+    for (int i = 0; i < loops; ++i) {
+        SkPictureDeltaEncoder encoder;
+        SkPictureDeltaDecoder decoder;
+        for (const sk_sp<SkPicture>& frame : fFrames) {
+            sk_sp<SkData> delta = encoder.encode(frame.get());
+            SkAssertResult(decoder.decode(delta->data(), delta->size()));
+        }
+    }
+}
+
+const char* MSKPDeltaBench::onGetName() { return fName.c_str(); }
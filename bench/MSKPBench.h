@@ -9,6 +9,9 @@
 #define MSKPBench_DEFINED
 
 #include "bench/Benchmark.h"
+#include "include/core/SkPicture.h"
+
+#include <vector>
 
 class MSKPPlayer;
 
@@ -29,4 +32,25 @@ private:
     std::unique_ptr<MSKPPlayer> fPlayer;
 };
 
+// Streams an MSKP's frames, in order, through SkPictureDeltaEncoder and SkPictureDeltaDecoder.
+class MSKPDeltaBench : public Benchmark {
+public:
+    MSKPDeltaBench(SkString name, std::vector<sk_sp<SkPicture>> frames);
+
+    // The average size of a frame's delta, and of the frame serialized on its own.
+    double deltaBytesPerFrame() const { return fDeltaBytes / fFrames.size(); }
+    double fullBytesPerFrame() const { return fFullBytes / fFrames.size(); }
+
+protected:
+    bool isSuitableFor(Backend) override;
+    void onDraw(int loops, SkCanvas*) override;
+    const char* onGetName() override;
+
+private:
+    SkString fName;
+    std::vector<sk_sp<SkPicture>> fFrames;
+    double fDeltaBytes = 0;
+    double fFullBytes = 0;
+};
+
 #endif
@@ -8,21 +8,30 @@
 #include "bench/Benchmark.h"
 
 #include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
 #include "include/core/SkData.h"
 #include "include/core/SkExecutor.h"
+#include "include/core/SkFont.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkPixmap.h"
 #include "include/core/SkStream.h"
+#include "include/core/SkString.h"
+#include "include/core/SkTextBlob.h"
 #include "include/effects/SkGradientShader.h"
 #include "include/private/base/SkTo.h"
 #include "src/base/SkRandom.h"
 #include "src/core/SkAutoPixmapStorage.h"
+#include "src/pdf/SkDeflate.h"
 #include "src/pdf/SkPDFUnion.h"
 #include "src/utils/SkFloatToDecimal.h"
 #include "tools/DecodeUtils.h"
+#include "tools/ProcStats.h"
 #include "tools/Resources.h"
 #include "tools/fonts/FontToolUtils.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace {
 struct WStreamWriteTextBenchmark : public Benchmark {
     std::unique_ptr<SkWStream> fWStream;
@@ -305,6 +314,294 @@ struct PDFClipPathBenchmark : public Benchmark {
     }
 };
 
+// A catalog: every page draws the same product images, each decoded afresh (so each is a new
+// SkImage). Reports the size of the document, and of one whose copies differ by one pixel and so
+// can't be deduplicated.
+struct PDFImageDedupBench : public Benchmark {
+    static constexpr int kPages = 20;
+    static constexpr int kImagesPerPage = 4;
+    std::vector<SkBitmap> fProducts;
+    size_t fDedupedBytes = 0;
+    size_t fDistinctBytes = 0;
+
+    const char* onGetName() override { return "PDFImageDedup"; }
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+
+    size_t makePDF(SkWStream* stream, bool distinct) const {
+        SkPDF::Metadata metadata;
+        auto doc = SkPDF::MakeDocument(stream, metadata);
+        int copies = 0;
+        for (int page = 0; page < kPages; ++page) {
+            SkCanvas* canvas = doc->beginPage(612, 792);
+            for (int i = 0; i < kImagesPerPage; ++i) {
+                const SkBitmap& product = fProducts[i % fProducts.size()];
+                SkBitmap copy;
+                copy.allocPixels(product.info());
+                product.readPixels(copy.pixmap());
+                if (distinct) {
+                    copy.erase(SkColorSetARGB(0xFF, 0, 0, SkToU8(copies++)),
+                               SkIRect::MakeWH(1, 1));
+                }
+                canvas->drawImage(copy.asImage(), 36 + 144.0f * i, 36);
+            }
+            doc->endPage();
+        }
+        doc->close();
+        return stream->bytesWritten();
+    }
+
+    void onDelayedSetup() override {
+        for (const char* path : {"images/color_wheel.png", "images/mandrill_128.png"}) {
+            SkBitmap bitmap;
+            if (sk_sp<SkImage> img = ToolUtils::GetResourceAsImage(path);
+                img && bitmap.tryAllocPixels(SkImageInfo::MakeN32Premul(img->dimensions())) &&
+                img->readPixels(nullptr, bitmap.pixmap(), 0, 0)) {
+                fProducts.push_back(bitmap);
+            }
+        }
+        if (fProducts.empty()) {
+            return;
+        }
+        SkNullWStream deduped, distinct;
+        fDedupedBytes = this->makePDF(&deduped, false);
+        fDistinctBytes = this->makePDF(&distinct, true);
+    }
+
+    void getMetrics(skia_private::TArray<SkString>* keys,
+                    skia_private::TArray<double>* values) override {
+        keys->push_back(SkString("bytes"));
+        values->push_back(fDedupedBytes);
+        keys->push_back(SkString("distinct_bytes"));
+        values->push_back(fDistinctBytes);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        if (fProducts.empty()) {
+            return;
+        }
+        while (loops-- > 0) {
+            SkNullWStream wStream;
+            (void)this->makePDF(&wStream, false);
+        }
+    }
+};
+
+// A long report: text and a small chart on every page. Reports how far the resident set grows
+// while the document is written, with and without SkPDF::Metadata::fIncremental.
+struct PDFLongDocBench : public Benchmark {
+    static constexpr int kPages = 2000;
+    const bool fIncremental;
+    SkString fName;
+    SkBitmap fChart;
+    size_t fBytes = 0;
+    int64_t fResidentGrowth = -1;
+
+    explicit PDFLongDocBench(bool incremental) : fIncremental(incremental) {
+        fName.printf("PDFLongDoc_%s", incremental ? "incremental" : "default");
+    }
+    const char* onGetName() override { return fName.c_str(); }
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+
+    // Returns the largest growth of the resident set seen at the end of a page, if known.
+    int64_t makePDF(SkWStream* stream) {
+        SkPDF::Metadata metadata;
+        metadata.fIncremental = fIncremental;
+        auto doc = SkPDF::MakeDocument(stream, metadata);
+        SkFont font = ToolUtils::DefaultFont();
+        const int64_t baseline = sk_tools::getCurrResidentSetSizeBytes();
+        int64_t peak = 0;
+        for (int page = 0; page < kPages; ++page) {
+            SkCanvas* canvas = doc->beginPage(612, 792);
+            for (int line = 0; line < 40; ++line) {
+                SkString text = SkStringPrintf("Page %d, line %d: lorem ipsum dolor sit amet",
+                                               page, line);
+                canvas->drawString(text, 36, 72 + 14.0f * line, font, SkPaint());
+            }
+            // A new chart on every page.
+            fChart.erase(SkColorSetARGB(0xFF, SkToU8(page), 0x80, 0x40),
+                         SkIRect::MakeWH(fChart.width(), page % fChart.height() + 1));
+            canvas->drawImage(fChart.asImage(), 36, 660);
+            doc->endPage();
+            peak = std::max(peak, sk_tools::getCurrResidentSetSizeBytes() - baseline);
+        }
+        doc->close();
+        return baseline < 0 ? -1 : peak;
+    }
+
+    void onDelayedSetup() override {
+        fChart.allocN32Pixels(128, 96);
+        fChart.eraseColor(SK_ColorWHITE);
+        SkNullWStream wStream;
+        fResidentGrowth = this->makePDF(&wStream);
+        fBytes = wStream.bytesWritten();
+    }
+
+    void getMetrics(skia_private::TArray<SkString>* keys,
+                    skia_private::TArray<double>* values) override {
+        keys->push_back(SkString("bytes"));
+        values->push_back(fBytes);
+        if (fResidentGrowth >= 0) {
+            keys->push_back(SkString("resident_growth_bytes"));
+            values->push_back(fResidentGrowth);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        while (loops-- > 0) {
+            SkNullWStream wStream;
+            (void)this->makePDF(&wStream);
+        }
+    }
+};
+
+// A table-heavy document: every page is a grid of short cells. Each row is drawn either as one
+// text blob with a run per cell, which SkPDFDevice shows in a single text object, or as a
+// separate drawString() per cell. Also reports the size of the uncompressed output.
+struct PDFTableBench : public Benchmark {
+    static constexpr int kPages = 10;
+    static constexpr int kRows = 50;
+    static constexpr int kColumns = 6;
+    const bool fRowsAsBlobs;
+    SkString fName;
+    SkFont fFont;
+    std::vector<sk_sp<SkTextBlob>> fRows;
+    std::vector<SkString> fCells;
+    size_t fUncompressedBytes = 0;
+
+    explicit PDFTableBench(bool rowsAsBlobs) : fRowsAsBlobs(rowsAsBlobs) {
+        fName.printf("PDFTable_%s", rowsAsBlobs ? "blobs" : "strings");
+    }
+    const char* onGetName() override { return fName.c_str(); }
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+
+    static SkPoint cell_origin(int row, int column) {
+        return {36.0f + 90 * column, 48.0f + 14 * row};
+    }
+
+    void onDelayedSetup() override {
+        fFont = ToolUtils::DefaultFont();
+        fFont.setSize(10);
+        SkRandom random(42);
+        for (int row = 0; row < kRows; ++row) {
+            SkTextBlobBuilder builder;
+            for (int column = 0; column < kColumns; ++column) {
+                SkString cell = SkStringPrintf("%u.%02u", random.nextULessThan(100000),
+                                               random.nextULessThan(100));
+                int count = fFont.countText(cell.c_str(), cell.size(), SkTextEncoding::kUTF8);
+                SkPoint origin = cell_origin(row, column);
+                const auto& run = builder.allocRun(fFont, count, origin.x(), origin.y());
+                fFont.textToGlyphs(cell.c_str(), cell.size(), SkTextEncoding::kUTF8,
+                                   run.glyphs, count);
+                fCells.push_back(std::move(cell));
+            }
+            fRows.push_back(builder.make());
+        }
+        SkNullWStream wStream;
+        this->makePDF(&wStream, SkPDF::Metadata::CompressionLevel::None);
+        fUncompressedBytes = wStream.bytesWritten();
+    }
+
+    void getMetrics(skia_private::TArray<SkString>* keys,
+                    skia_private::TArray<double>* values) override {
+        keys->push_back(SkString("uncompressed_bytes"));
+        values->push_back(fUncompressedBytes);
+    }
+
+    void makePDF(SkWStream* stream, SkPDF::Metadata::CompressionLevel compression) {
+        SkPDF::Metadata metadata;
+        metadata.fCompressionLevel = compression;
+        auto doc = SkPDF::MakeDocument(stream, metadata);
+        for (int page = 0; page < kPages; ++page) {
+            SkCanvas* canvas = doc->beginPage(612, 792);
+            for (int row = 0; row < kRows; ++row) {
+                if (fRowsAsBlobs) {
+                    canvas->drawTextBlob(fRows[row], 0, 0, SkPaint());
+                    continue;
+                }
+                for (int column = 0; column < kColumns; ++column) {
+                    SkPoint origin = cell_origin(row, column);
+                    canvas->drawString(fCells[row * kColumns + column], origin.x(), origin.y(),
+                                       fFont, SkPaint());
+                }
+            }
+            doc->endPage();
+        }
+        doc->close();
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        while (loops-- > 0) {
+            SkNullWStream wStream;
+            this->makePDF(&wStream, SkPDF::Metadata::CompressionLevel::Default);
+        }
+    }
+};
+
+// Deflates 8MB of PDF content stream with each SkDeflateWStream::Profile, on one thread or
+// split into blocks on a thread pool. Also reports the bytes each loop deflates, so that MB/s can
+// be derived from the time per loop, and the compression ratio.
+struct PDFDeflateBench : public Benchmark {
+    static constexpr size_t kCorpusSize = 8 << 20;
+    const SkDeflateWStream::Profile fProfile;
+    const bool fThreaded;
+    SkString fName;
+    sk_sp<SkData> fCorpus;
+    std::unique_ptr<SkExecutor> fExecutor;
+    size_t fCompressedBytes = 0;
+
+    PDFDeflateBench(SkDeflateWStream::Profile profile, bool threaded)
+            : fProfile(profile), fThreaded(threaded) {
+        const char* names[] = {"fast", "default", "max"};
+        fName.printf("PDFDeflate_%s_%s", names[(int)profile], threaded ? "threaded" : "serial");
+    }
+    const char* onGetName() override { return fName.c_str(); }
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+
+    size_t deflate() {
+        SkNullWStream wStream;
+        SkDeflateWStream deflateWStream(&wStream, fProfile, false, fExecutor.get());
+        deflateWStream.write(fCorpus->data(), fCorpus->size());
+        deflateWStream.finalize();
+        return wStream.bytesWritten();
+    }
+
+    void onDelayedSetup() override {
+        sk_sp<SkData> stream = GetResourceAsData("pdf_command_stream.txt");
+        if (!stream || stream->isEmpty()) {
+            return;
+        }
+        SkDynamicMemoryWStream corpus;
+        while (corpus.bytesWritten() < kCorpusSize) {
+            corpus.write(stream->data(),
+                         std::min(stream->size(), kCorpusSize - corpus.bytesWritten()));
+        }
+        fCorpus = corpus.detachAsData();
+        if (fThreaded) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool();
+        }
+        fCompressedBytes = this->deflate();
+    }
+
+    void getMetrics(skia_private::TArray<SkString>* keys,
+                    skia_private::TArray<double>* values) override {
+        if (fCorpus) {
+            keys->push_back(SkString("bytes_per_loop"));
+            values->push_back((double)fCorpus->size());
+            keys->push_back(SkString("compression_ratio"));
+            values->push_back((double)fCompressedBytes / fCorpus->size());
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        if (!fCorpus) {
+            return;
+        }
+        while (loops-- > 0) {
+            (void)this->deflate();
+        }
+    }
+};
+
 }  // namespace
 DEF_BENCH(return new PDFImageBench;)
 DEF_BENCH(return new PDFJpegImageBench;)
@@ -313,6 +610,17 @@ DEF_BENCH(return new PDFColorComponentBench;)
 DEF_BENCH(return new PDFShaderBench;)
 DEF_BENCH(return new WritePDFTextBenchmark;)
 DEF_BENCH(return new PDFClipPathBenchmark;)
+DEF_BENCH(return new PDFImageDedupBench;)
+DEF_BENCH(return new PDFLongDocBench(false);)
+DEF_BENCH(return new PDFLongDocBench(true);)
+DEF_BENCH(return new PDFTableBench(false);)
+DEF_BENCH(return new PDFTableBench(true);)
+DEF_BENCH(return new PDFDeflateBench(SkDeflateWStream::Profile::kFast, false);)
+DEF_BENCH(return new PDFDeflateBench(SkDeflateWStream::Profile::kFast, true);)
+DEF_BENCH(return new PDFDeflateBench(SkDeflateWStream::Profile::kDefault, false);)
+DEF_BENCH(return new PDFDeflateBench(SkDeflateWStream::Profile::kDefault, true);)
+DEF_BENCH(return new PDFDeflateBench(SkDeflateWStream::Profile::kMax, false);)
+DEF_BENCH(return new PDFDeflateBench(SkDeflateWStream::Profile::kMax, true);)
 
 #ifdef SK_PDF_ENABLE_SLOW_TESTS
 #include "include/core/SkExecutor.h"
@@ -5,17 +5,25 @@
  * found in the LICENSE file.
  */
 #include <memory>
+#include <optional>
 
 #include "bench/Benchmark.h"
 #include "include/core/SkBBHFactory.h"
+#include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
+#include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkImage.h"
 #include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
 #include "include/core/SkPicture.h"
 #include "include/core/SkPictureRecorder.h"
 #include "include/core/SkPoint.h"
 #include "include/core/SkRect.h"
+#include "include/core/SkSerialProcs.h"
 #include "include/core/SkString.h"
+#include "include/encode/SkPngEncoder.h"
 #include "src/base/SkRandom.h"
 
 // This is designed to emulate about 4 screens of textual content
@@ -25,14 +33,15 @@
 // Chrome draws into small tiles with impl-side painting.
 // This benchmark measures the relative performance of our bounding-box hierarchies,
 // both when querying tiles perfectly and when not.
-enum BBH  { kNone, kRTree };
+enum BBH  { kNone, kRTree, kPackedRTree };
 enum Mode { kTiled, kRandom };
 class TiledPlaybackBench : public Benchmark {
 public:
     TiledPlaybackBench(BBH bbh, Mode mode) : fBBH(bbh), fMode(mode), fName("tiled_playback") {
         switch (fBBH) {
-            case kNone:     fName.append("_none"    ); break;
-            case kRTree:    fName.append("_rtree"   ); break;
+            case kNone:        fName.append("_none"        ); break;
+            case kRTree:       fName.append("_rtree"       ); break;
+            case kPackedRTree: fName.append("_packed_rtree"); break;
         }
         switch (fMode) {
             case kTiled:  fName.append("_tiled" ); break;
@@ -46,8 +55,9 @@ public:
     void onDelayedSetup() override {
         std::unique_ptr<SkBBHFactory> factory;
         switch (fBBH) {
-            case kNone:                                                   break;
-            case kRTree:    factory = std::make_unique<SkRTreeFactory>(); break;
+            case kNone:                                                               break;
+            case kRTree:       factory = std::make_unique<SkRTreeFactory>();       break;
+            case kPackedRTree: factory = std::make_unique<SkPackedRTreeFactory>(); break;
         }
 
         SkPictureRecorder recorder;
@@ -94,7 +104,125 @@ private:
     sk_sp<SkPicture>    fPic;
 };
 
-DEF_BENCH( return new TiledPlaybackBench(kNone,     kRandom); )
-DEF_BENCH( return new TiledPlaybackBench(kNone,     kTiled ); )
-DEF_BENCH( return new TiledPlaybackBench(kRTree,    kRandom); )
-DEF_BENCH( return new TiledPlaybackBench(kRTree,    kTiled ); )
+DEF_BENCH( return new TiledPlaybackBench(kNone,        kRandom); )
+DEF_BENCH( return new TiledPlaybackBench(kNone,        kTiled ); )
+DEF_BENCH( return new TiledPlaybackBench(kRTree,       kRandom); )
+DEF_BENCH( return new TiledPlaybackBench(kRTree,       kTiled ); )
+DEF_BENCH( return new TiledPlaybackBench(kPackedRTree, kRandom); )
+DEF_BENCH( return new TiledPlaybackBench(kPackedRTree, kTiled ); )
+
+// Measures loading a serialized picture and drawing it for the first time, e.g. a tile of an SKP
+// that has just been read from disk, with SkPicture::MakeFromData() or MakeFromDataInPlace().
+class PictureLoadAndDrawBench : public Benchmark {
+public:
+    explicit PictureLoadAndDrawBench(bool inPlace)
+            : fInPlace(inPlace)
+            , fName(inPlace ? "picture_load_and_draw_in_place" : "picture_load_and_draw") {}
+
+    const char* onGetName() override { return fName.c_str(); }
+    SkISize onGetSize() override { return SkISize::Make(1024,1024); }
+
+    void onDelayedSetup() override {
+        SkPictureRecorder recorder;
+        SkCanvas* canvas = recorder.beginRecording(1024, 1024);
+        SkRandom rand;
+        for (int i = 0; i < 10000; i++) {
+            SkScalar x = rand.nextRangeScalar(0, 1024),
+                     y = rand.nextRangeScalar(0, 1024),
+                     w = rand.nextRangeScalar(0, 128),
+                     h = rand.nextRangeScalar(0, 128);
+            SkPaint paint;
+            paint.setColor(rand.nextU() | 0xFF000000);
+            if (i % 4 == 0) {
+                SkPath path;
+                path.moveTo(x, y).quadTo(x + w, y, x + w, y + h).lineTo(x, y + h).close();
+                canvas->drawPath(path, paint);
+            } else {
+                canvas->drawRect(SkRect::MakeXYWH(x,y,w,h), paint);
+            }
+        }
+        fData = recorder.finishRecordingAsPicture()->serialize();
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        for (int i = 0; i < loops; i++) {
+            sk_sp<SkPicture> pic = fInPlace ? SkPicture::MakeFromDataInPlace(fData)
+                                            : SkPicture::MakeFromData(fData.get());
+            // Only the top-left tile, so that loading is a large part of the time.
+            SkAutoCanvasRestore ar(canvas, true/*save now*/);
+            canvas->clipRect(SkRect::MakeWH(256,256));
+            pic->playback(canvas);
+        }
+    }
+
+private:
+    bool             fInPlace;
+    SkString         fName;
+    sk_sp<SkData>    fData;
+};
+
+DEF_BENCH( return new PictureLoadAndDrawBench(false); )
+DEF_BENCH( return new PictureLoadAndDrawBench(true);  )
+
+// Measures loading a serialized picture whose images are decoded to raster as it is loaded,
+// either on the calling thread or on a thread pool (SkDeserialProcs::fExecutor).
+class PictureDecodeImagesBench : public Benchmark {
+public:
+    explicit PictureDecodeImagesBench(bool threaded)
+            : fThreaded(threaded)
+            , fName(threaded ? "picture_decode_images_threaded" : "picture_decode_images") {}
+
+    const char* onGetName() override { return fName.c_str(); }
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+
+    void onDelayedSetup() override {
+        SkPictureRecorder recorder;
+        SkCanvas* canvas = recorder.beginRecording(1024, 1024);
+        SkRandom rand;
+        for (int i = 0; i < 64; i++) {
+            // Noise, so that decoding the images takes a while.
+            SkBitmap bm;
+            bm.allocN32Pixels(128, 128);
+            for (int y = 0; y < 128; y++) {
+                for (int x = 0; x < 128; x++) {
+                    *bm.getAddr32(x, y) = rand.nextU() | 0xFF000000;
+                }
+            }
+            bm.setImmutable();
+            canvas->drawImage(bm.asImage(), 128*(i % 8), 128*(i / 8));
+        }
+        SkSerialProcs sprocs;
+        sprocs.fImageProc = [](SkImage* img, void*) -> sk_sp<SkData> {
+            return SkPngEncoder::Encode(nullptr, img, {});
+        };
+        fData = recorder.finishRecordingAsPicture()->serialize(&sprocs);
+
+        fProcs.fImageDataProc = [](sk_sp<SkData> encoded, std::optional<SkAlphaType> alphaType,
+                                   void*) -> sk_sp<SkImage> {
+            sk_sp<SkImage> image = SkImages::DeferredFromEncodedData(std::move(encoded),
+                                                                     alphaType);
+            return image ? image->makeRasterImage() : nullptr;
+        };
+        if (fThreaded) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool();
+            fProcs.fExecutor = fExecutor.get();
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; i++) {
+            sk_sp<SkPicture> pic = SkPicture::MakeFromData(fData.get(), &fProcs);
+            SkASSERT(pic);
+        }
+    }
+
+private:
+    bool                        fThreaded;
+    SkString                    fName;
+    sk_sp<SkData>               fData;
+    std::unique_ptr<SkExecutor> fExecutor;
+    SkDeserialProcs             fProcs;
+};
+
+DEF_BENCH( return new PictureDecodeImagesBench(false); )
+DEF_BENCH( return new PictureDecodeImagesBench(true);  )
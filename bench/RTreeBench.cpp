@@ -6,10 +6,12 @@
  */
 
 #include "bench/Benchmark.h"
+#include "include/core/SkBBHFactory.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkString.h"
 #include "include/private/base/SkTemplates.h"
 #include "src/base/SkRandom.h"
+#include "src/core/SkPackedRTree.h"
 #include "src/core/SkRTree.h"
 
 using namespace skia_private;
@@ -22,11 +24,17 @@ static const int GRID_WIDTH = 100;
 
 typedef SkRect (*MakeRectProc)(SkRandom&, int, int);
 
+static sk_sp<SkBBoxHierarchy> make_tree(bool packed) {
+    return packed ? sk_sp<SkBBoxHierarchy>(sk_make_sp<SkPackedRTree>())
+                  : sk_sp<SkBBoxHierarchy>(sk_make_sp<SkRTree>());
+}
+
 // Time how long it takes to build an R-Tree.
 class RTreeBuildBench : public Benchmark {
 public:
-    RTreeBuildBench(const char* name, MakeRectProc proc) : fProc(proc) {
-        fName.printf("rtree_%s_build", name);
+    RTreeBuildBench(const char* name, MakeRectProc proc, bool packed = false)
+            : fProc(proc), fPacked(packed) {
+        fName.printf("%srtree_%s_build", packed ? "packed_" : "", name);
     }
 
     bool isSuitableFor(Backend backend) override {
@@ -45,12 +53,12 @@ protected:
         }
 
         for (int i = 0; i < loops; ++i) {
-            SkRTree tree;
-            tree.insert(rects.data(), NUM_BUILD_RECTS);
+            make_tree(fPacked)->insert(rects.data(), NUM_BUILD_RECTS);
         }
     }
 private:
     MakeRectProc fProc;
+    bool fPacked;
     SkString fName;
     using INHERITED = Benchmark;
 };
@@ -58,8 +66,9 @@ private:
 // Time how long it takes to perform queries on an R-Tree.
 class RTreeQueryBench : public Benchmark {
 public:
-    RTreeQueryBench(const char* name, MakeRectProc proc) : fProc(proc) {
-        fName.printf("rtree_%s_query", name);
+    RTreeQueryBench(const char* name, MakeRectProc proc, bool packed = false)
+            : fTree(make_tree(packed)), fProc(proc) {
+        fName.printf("%srtree_%s_query", packed ? "packed_" : "", name);
     }
 
     bool isSuitableFor(Backend backend) override {
@@ -75,7 +84,7 @@ protected:
         for (int i = 0; i < NUM_QUERY_RECTS; ++i) {
             rects[i] = fProc(rand, i, NUM_QUERY_RECTS);
         }
-        fTree.insert(rects.data(), NUM_QUERY_RECTS);
+        fTree->insert(rects.data(), NUM_QUERY_RECTS);
     }
 
     void onDraw(int loops, SkCanvas* canvas) override {
@@ -87,11 +96,11 @@ protected:
             query.fTop    = rand.nextRangeF(0, GENERATE_EXTENTS);
             query.fRight  = query.fLeft + 1 + rand.nextRangeF(0, GENERATE_EXTENTS/2);
             query.fBottom = query.fTop  + 1 + rand.nextRangeF(0, GENERATE_EXTENTS/2);
-            fTree.search(query, &hits);
+            fTree->search(query, &hits);
         }
     }
 private:
-    SkRTree fTree;
+    sk_sp<SkBBoxHierarchy> fTree;
     MakeRectProc fProc;
     SkString fName;
     using INHERITED = Benchmark;
@@ -138,3 +147,11 @@ DEF_BENCH(return new RTreeQueryBench("XY", &make_XYordered_rects));
 DEF_BENCH(return new RTreeQueryBench("YX", &make_YXordered_rects));
 DEF_BENCH(return new RTreeQueryBench("random", &make_random_rects));
 DEF_BENCH(return new RTreeQueryBench("concentric", &make_concentric_rects));
+
+DEF_BENCH(return new RTreeBuildBench("XY", &make_XYordered_rects, true));
+DEF_BENCH(return new RTreeBuildBench("random", &make_random_rects, true));
+
+DEF_BENCH(return new RTreeQueryBench("XY", &make_XYordered_rects, true));
+DEF_BENCH(return new RTreeQueryBench("YX", &make_YXordered_rects, true));
+DEF_BENCH(return new RTreeQueryBench("random", &make_random_rects, true));
+DEF_BENCH(return new RTreeQueryBench("concentric", &make_concentric_rects, true));
@@ -8,8 +8,12 @@
 #include "bench/RecordingBench.h"
 
 #include "include/core/SkBBHFactory.h"
+#include "include/core/SkCanvas.h"
 #include "include/core/SkData.h"
 #include "include/core/SkPictureRecorder.h"
+#include "src/core/SkTaskGroup.h"
+
+#include <vector>
 
 PictureCentricBench::PictureCentricBench(const char* name, const SkPicture* pic) : fName(name) {
     // Flatten the source picture in case it's trivially nested (useless for timing).
@@ -34,20 +38,62 @@ SkISize PictureCentricBench::onGetSize() {
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
-RecordingBench::RecordingBench(const char* name, const SkPicture* pic, bool useBBH)
+RecordingBench::RecordingBench(const char* name, const SkPicture* pic, bool useBBH, bool compact)
     : INHERITED(name, pic)
     , fUseBBH(useBBH)
+    , fCompact(compact)
 {}
 
 void RecordingBench::onDraw(int loops, SkCanvas*) {
     SkRTreeFactory factory;
     SkPictureRecorder recorder;
+    recorder.setCompactRecording(fCompact);
     while (loops --> 0) {
         fSrc->playback(recorder.beginRecording(fSrc->cullRect(), fUseBBH ? &factory : nullptr));
         (void)recorder.finishRecordingAsPicture();
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+ConcurrentRecordingBench::ConcurrentRecordingBench(const char* name, const SkPicture* pic,
+                                                   bool useBBH, int threads)
+    : INHERITED(name, pic)
+    , fUseBBH(useBBH)
+    , fThreads(threads)
+    , fExecutor(SkExecutor::MakeFIFOThreadPool(threads))
+{
+    fName.appendf("_%dthreads", threads);
+
+    SkRTreeFactory factory;
+    SkPictureRecorder rec;
+    fSrc->playback(rec.beginRecording(fSrc->cullRect(), &factory));
+    fBanded = rec.finishRecordingAsPicture();
+}
+
+void ConcurrentRecordingBench::onDraw(int loops, SkCanvas*) {
+    SkRTreeFactory factory;
+    std::vector<SkPictureRecorder> recorders(fThreads);
+    std::vector<SkPictureRecorder*> parts;
+    for (SkPictureRecorder& recorder : recorders) {
+        parts.push_back(&recorder);
+    }
+    const SkRect cull = fSrc->cullRect();
+    while (loops --> 0) {
+        SkTaskGroup tasks(*fExecutor);
+        tasks.batch(fThreads, [&](int i) {
+            SkRect band = SkRect::MakeLTRB(cull.fLeft, cull.fTop + cull.height() * i / fThreads,
+                                           cull.fRight,
+                                           cull.fTop + cull.height() * (i + 1) / fThreads);
+            SkCanvas* canvas = recorders[i].beginRecording(band, fUseBBH ? &factory : nullptr);
+            canvas->clipRect(band);
+            fBanded->playback(canvas);
+        });
+        tasks.wait();
+        (void)SkPictureRecorder::FinishRecordingAsConcatenatedPicture(parts, fExecutor.get());
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 #include "include/core/SkSerialProcs.h"
 
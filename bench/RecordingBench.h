@@ -9,8 +9,11 @@
 #define RecordingBench_DEFINED
 
 #include "bench/Benchmark.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkPicture.h"
 
+#include <memory>
+
 class PictureCentricBench : public Benchmark {
 public:
     PictureCentricBench(const char* name, const SkPicture*);
@@ -29,13 +32,31 @@ protected:
 
 class RecordingBench : public PictureCentricBench {
 public:
-    RecordingBench(const char* name, const SkPicture*, bool useBBH);
+    RecordingBench(const char* name, const SkPicture*, bool useBBH, bool compact = false);
 
 protected:
     void onDraw(int loops, SkCanvas*) override;
 
 private:
     bool fUseBBH;
+    bool fCompact;
+
+    using INHERITED = PictureCentricBench;
+};
+
+// Records the picture in horizontal bands, each on its own thread, and concatenates them.
+class ConcurrentRecordingBench : public PictureCentricBench {
+public:
+    ConcurrentRecordingBench(const char* name, const SkPicture*, bool useBBH, int threads);
+
+protected:
+    void onDraw(int loops, SkCanvas*) override;
+
+private:
+    sk_sp<const SkPicture>      fBanded;  // fSrc with an R-tree, so each band plays only its ops.
+    bool                        fUseBBH;
+    int                         fThreads;
+    std::unique_ptr<SkExecutor> fExecutor;
 
     using INHERITED = PictureCentricBench;
 };
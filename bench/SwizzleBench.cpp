@@ -6,6 +6,7 @@
  */
 
 #include "bench/Benchmark.h"
+#include "include/core/SkString.h"
 #include "src/codec/SkSwizzler.h"
 #include "src/core/SkSwizzlePriv.h"
 
@@ -31,6 +32,27 @@ private:
     SkOpts::Swizzle_8888_u8  fFn_u8  = nullptr;
 };
 
+class SampledSwizzleBench : public Benchmark {
+public:
+    SampledSwizzleBench(const char* name, SkOpts::Swizzle_8888_sampled fn, int sampleX)
+        : fName(SkStringPrintf("%s_%d", name, sampleX)), fFn(fn), fSampleX(sampleX) {}
+
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+    const char* onGetName() override { return fName.c_str(); }
+    void onDraw(int loops, SkCanvas*) override {
+        // Decode a 1023 pixel wide row down to its sampled width, as SkSampledCodec would.
+        static const int K = 1023;
+        uint32_t dst[K], src[K];
+        while (loops --> 0) {
+            fFn(dst, (const uint8_t*)src, K / fSampleX, fSampleX);
+        }
+    }
+private:
+    SkString                     fName;
+    SkOpts::Swizzle_8888_sampled fFn;
+    int                          fSampleX;
+};
+
 
 DEF_BENCH(return new SwizzleBench("SkOpts::RGBA_to_rgbA", SkOpts::RGBA_to_rgbA));
 DEF_BENCH(return new SwizzleBench("SkOpts::RGBA_to_bgrA", SkOpts::RGBA_to_bgrA));
@@ -42,3 +64,18 @@ DEF_BENCH(return new SwizzleBench("SkOpts::grayA_to_RGBA", SkOpts::grayA_to_RGBA
 DEF_BENCH(return new SwizzleBench("SkOpts::grayA_to_rgbA", SkOpts::grayA_to_rgbA));
 DEF_BENCH(return new SwizzleBench("SkOpts::inverted_CMYK_to_RGB1", SkOpts::inverted_CMYK_to_RGB1));
 DEF_BENCH(return new SwizzleBench("SkOpts::inverted_CMYK_to_BGR1", SkOpts::inverted_CMYK_to_BGR1));
+
+// Each sampled swizzle at the sample sizes SkSwizzler's sampled procs handle.
+#define DEF_SAMPLED_SWIZZLE_BENCHES(fn)                                           \
+    DEF_BENCH(return new SampledSwizzleBench("SkOpts::" #fn, SkOpts::fn, 2);)     \
+    DEF_BENCH(return new SampledSwizzleBench("SkOpts::" #fn, SkOpts::fn, 4);)     \
+    DEF_BENCH(return new SampledSwizzleBench("SkOpts::" #fn, SkOpts::fn, 8);)
+
+DEF_SAMPLED_SWIZZLE_BENCHES(RGBA_to_rgbA_sampled)
+DEF_SAMPLED_SWIZZLE_BENCHES(RGBA_to_bgrA_sampled)
+DEF_SAMPLED_SWIZZLE_BENCHES(RGBA_to_BGRA_sampled)
+DEF_SAMPLED_SWIZZLE_BENCHES(RGB_to_RGB1_sampled)
+DEF_SAMPLED_SWIZZLE_BENCHES(RGB_to_BGR1_sampled)
+DEF_SAMPLED_SWIZZLE_BENCHES(gray_to_RGB1_sampled)
+
+#undef DEF_SAMPLED_SWIZZLE_BENCHES
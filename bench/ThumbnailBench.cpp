@@ -0,0 +1,78 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "bench/Benchmark.h"
+#include "include/codec/SkThumbnails.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkString.h"
+#include "tools/Resources.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ *  Times SkThumbnails::Decode(). Each loop is one image (the loops are decoded as a single batch),
+ *  so the time per loop is the inverse of the images per second.
+ */
+class ThumbnailBench : public Benchmark {
+public:
+    ThumbnailBench(int maxDimension, bool threaded)
+            : fMaxSize(SkISize::Make(maxDimension, maxDimension)), fThreaded(threaded) {
+        fName.printf("thumbnails_%d_%s", maxDimension, threaded ? "threaded" : "serial");
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+
+    void onDelayedSetup() override {
+        for (const char* path : {"images/mandrill_512_q075.jpg",
+                                 "images/brickwork-texture.jpg",
+                                 "images/yellow_rose.png",
+                                 "images/color_wheel.png"}) {
+            if (sk_sp<SkData> data = GetResourceAsData(path)) {
+                fSources.push_back(std::move(data));
+            }
+        }
+        if (fThreaded) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool();
+            fOptions.fExecutor = fExecutor.get();
+            fOptions.fMaxConcurrentDecodes = 8;
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        if (fSources.empty()) {
+            return;
+        }
+        std::vector<sk_sp<SkData>> batch(loops);
+        for (int i = 0; i < loops; i++) {
+            batch[i] = fSources[i % fSources.size()];
+        }
+        std::vector<SkBitmap> thumbnails = SkThumbnails::Decode(batch, fMaxSize, fOptions);
+        SkASSERT(thumbnails.size() == batch.size());
+    }
+
+private:
+    SkString                    fName;
+    const SkISize               fMaxSize;
+    const bool                  fThreaded;
+    std::vector<sk_sp<SkData>>  fSources;
+    std::unique_ptr<SkExecutor> fExecutor;
+    SkThumbnails::Options       fOptions;
+
+    using INHERITED = Benchmark;
+};
+
+DEF_BENCH(return new ThumbnailBench(128, false);)
+DEF_BENCH(return new ThumbnailBench(128, true);)
+DEF_BENCH(return new ThumbnailBench(256, false);)
+DEF_BENCH(return new ThumbnailBench(256, true);)
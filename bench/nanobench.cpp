@@ -32,13 +32,18 @@
 #include "include/core/SkPictureRecorder.h"
 #include "include/core/SkString.h"
 #include "include/core/SkSurface.h"
+#include "include/docs/SkMultiPictureDocument.h"
 #include "include/encode/SkPngEncoder.h"
 #include "include/private/base/SkMacros.h"
 #include "src/base/SkAutoMalloc.h"
 #include "src/base/SkLeanWindows.h"
 #include "src/base/SkTime.h"
+#include "src/core/SkBigPicture.h"
 #include "src/core/SkColorSpacePriv.h"
 #include "src/core/SkOSFile.h"
+#include "src/core/SkPicturePriv.h"
+#include "src/core/SkRecord.h"
+#include "src/core/SkRecordDraw.h"
 #include "src/core/SkTaskGroup.h"
 #include "src/core/SkTraceEvent.h"
 #include "src/utils/SkJSONWriter.h"
@@ -144,6 +149,12 @@ static DEFINE_string(zoom, "1.0,0",
                      "function that ping-pongs between 1.0 and zoomMax.");
 static DEFINE_bool(bbh, true, "Build a BBH for SKPs?");
 static DEFINE_bool(loopSKP, true, "Loop SKPs like we do for micro benches?");
+static DEFINE_bool(cullOccluded, false,
+                   "Leave draws covered by later opaque draws out of SKPs' BBHs?");
+static DEFINE_int(recordingThreads, 0,
+                  "If >1, also bench recording SKPs in this many bands, each on its own thread.");
+static DEFINE_bool(compactRecording, false,
+                   "Compact SKPs' records when recording finishes, and report the bytes saved?");
 static DEFINE_int(flushEvery, 10, "Flush --outResultsFile every Nth run.");
 static DEFINE_bool(gpuStats, false, "Print GPU stats after each gpu benchmark?");
 static DEFINE_bool(gpuStatsDump, false, "Dump GPU stats after each benchmark to json");
@@ -188,6 +199,8 @@ static DEFINE_bool2(verbose, v, false, "enable verbose output from the test driv
 
 static DEFINE_string(skps, "skps", "Directory to read skps from.");
 static DEFINE_string(mskps, "mskps", "Directory to read mskps from.");
+static DEFINE_bool(mskpDelta, false,
+                   "Also bench streaming MSKPs' frames as deltas, and report the bytes per frame?");
 static DEFINE_string(svgs, "", "Directory to read SVGs from, or a single SVG file.");
 static DEFINE_string(texttraces, "", "Directory to read TextBlobTrace files from.");
 
@@ -841,6 +854,23 @@ public:
         return SkPicture::MakeFromStream(stream.get());
     }
 
+    // The percentage of pic's ops that playback through its BBH skips as occluded.
+    static double OccludedOpsPercent(const sk_sp<SkPicture>& pic) {
+        const SkBigPicture* big = SkPicturePriv::AsSkBigPicture(pic);
+        if (!big || big->record()->count() == 0) {
+            return 0;
+        }
+        const SkRecord& record = *big->record();
+        AutoTArray<SkRect> bounds(record.count());
+        AutoTMalloc<SkBBoxHierarchy::Metadata> meta(record.count());
+        SkRecordFillBounds(pic->cullRect(), record, bounds.data(), meta, /*findOccluded=*/true);
+        int occluded = 0;
+        for (int i = 0; i < record.count(); i++) {
+            occluded += meta[i].isOccluded ? 1 : 0;
+        }
+        return 100.0 * occluded / record.count();
+    }
+
     static std::unique_ptr<MSKPPlayer> ReadMSKP(const char* path) {
         // Not strictly necessary, as it will be checked again later,
         // but helps to avoid a lot of pointless work if we're going to skip it.
@@ -857,6 +887,27 @@ public:
         return MSKPPlayer::Make(stream.get());
     }
 
+    static std::vector<sk_sp<SkPicture>> ReadMSKPFrames(const char* path) {
+        if (CommandLineFlags::ShouldSkip(FLAGS_match, SkOSPath::Basename(path).c_str())) {
+            return {};
+        }
+
+        auto reader = SkMultiPictureDocument::Reader::Make(SkStream::MakeFromFile(path));
+        if (!reader) {
+            SkDebugf("Could not read %s.\n", path);
+            return {};
+        }
+        std::vector<sk_sp<SkPicture>> frames;
+        for (int i = 0; i < reader->pageCount(); ++i) {
+            frames.push_back(reader->readPage(i));
+            if (!frames.back()) {
+                SkDebugf("Could not read frame %d of %s.\n", i, path);
+                return {};
+            }
+        }
+        return frames;
+    }
+
     static sk_sp<SkPicture> ReadSVGPicture(const char* path) {
         if (CommandLineFlags::ShouldSkip(FLAGS_match, SkOSPath::Basename(path).c_str())) {
             return nullptr;
@@ -955,7 +1006,31 @@ public:
             fBenchType  = "recording";
             fSKPBytes = static_cast<double>(pic->approximateBytesUsed());
             fSKPOps   = pic->approximateOpCount();
-            return new RecordingBench(name.c_str(), pic.get(), FLAGS_bbh);
+            if (FLAGS_compactRecording) {
+                SkPictureRecorder recorder;
+                recorder.setCompactRecording(true);
+                pic->playback(recorder.beginRecording(pic->cullRect()));
+                fSKPCompactedBytes = static_cast<double>(
+                        recorder.finishRecordingAsPicture()->approximateBytesUsed());
+            }
+            return new RecordingBench(name.c_str(), pic.get(), FLAGS_bbh,
+                                      FLAGS_compactRecording);
+        }
+
+        // Then, if asked, record them concurrently in bands.
+        while (FLAGS_recordingThreads > 1 && fCurrentConcurrentRecording < fSKPs.size()) {
+            const SkString& path = fSKPs[fCurrentConcurrentRecording++];
+            sk_sp<SkPicture> pic = ReadPicture(path.c_str());
+            if (!pic) {
+                continue;
+            }
+            SkString name = SkOSPath::Basename(path.c_str());
+            fSourceType = "skp";
+            fBenchType  = "recording";
+            fSKPBytes = static_cast<double>(pic->approximateBytesUsed());
+            fSKPOps   = pic->approximateOpCount();
+            return new ConcurrentRecordingBench(name.c_str(), pic.get(), FLAGS_bbh,
+                                                FLAGS_recordingThreads);
         }
 
         // Add all .skps as DeserializePictureBenchs.
@@ -986,10 +1061,14 @@ public:
                     // The SKP we read off disk doesn't have a BBH.  Re-record so it grows one.
                     SkRTreeFactory factory;
                     SkPictureRecorder recorder;
+                    recorder.setCullOccludedDraws(FLAGS_cullOccluded);
                     pic->playback(recorder.beginRecording(pic->cullRect().width(),
                                                           pic->cullRect().height(),
                                                           &factory));
                     pic = recorder.finishRecordingAsPicture();
+                    if (FLAGS_cullOccluded) {
+                        fSKPOccludedPercent = OccludedOpsPercent(pic);
+                    }
                 }
                 SkString name = SkOSPath::Basename(path.c_str());
                 fSourceType = "skp";
@@ -1045,6 +1124,23 @@ public:
             return new MSKPBench(std::move(name), std::move(player));
         }
 
+        // Then, if asked, stream them as deltas.
+        while (FLAGS_mskpDelta && fCurrentMSKPDelta < fMSKPs.size()) {
+            const SkString& path = fMSKPs[fCurrentMSKPDelta++];
+            std::vector<sk_sp<SkPicture>> frames = ReadMSKPFrames(path.c_str());
+            if (frames.empty()) {
+                continue;
+            }
+            SkString name = SkOSPath::Basename(path.c_str());
+            name.append("_delta");
+            fSourceType = "mskp";
+            fBenchType = "delta";
+            auto bench = new MSKPDeltaBench(std::move(name), std::move(frames));
+            fMSKPDeltaBytes = bench->deltaBytesPerFrame();
+            fMSKPFullBytes = bench->fullBytesPerFrame();
+            return bench;
+        }
+
         for (; fCurrentCodec < fImages.size(); fCurrentCodec++) {
             fSourceType = "image";
             fBenchType = "skcodec";
@@ -1258,6 +1354,17 @@ public:
         if (0 == strcmp(fBenchType, "recording")) {
             log.appendMetric("bytes", fSKPBytes);
             log.appendMetric("ops", fSKPOps);
+            if (FLAGS_compactRecording) {
+                log.appendMetric("compacted_bytes", fSKPCompactedBytes);
+            }
+        }
+        if (0 == strcmp(fBenchType, "delta")) {
+            log.appendMetric("bytes_per_frame", fMSKPDeltaBytes);
+            log.appendMetric("full_bytes_per_frame", fMSKPFullBytes);
+        }
+        if (0 == strcmp(fBenchType, "playback") && 0 == strcmp(fSourceType, "skp") &&
+            FLAGS_bbh && FLAGS_cullOccluded) {
+            log.appendMetric("occluded_ops_percent", fSKPOccludedPercent);
         }
     }
 
@@ -1290,12 +1397,17 @@ private:
     double             fZoomPeriodMs;
 
     double fSKPBytes, fSKPOps;
+    double fSKPOccludedPercent = 0;
+    double fSKPCompactedBytes = 0;
+    double fMSKPDeltaBytes = 0, fMSKPFullBytes = 0;
 
     const char* fSourceType;  // What we're benching: bench, GM, SKP, ...
     const char* fBenchType;   // How we bench it: micro, recording, playback, ...
     int fCurrentRecording = 0;
+    int fCurrentConcurrentRecording = 0;
     int fCurrentDeserialPicture = 0;
     int fCurrentMSKP = 0;
+    int fCurrentMSKPDelta = 0;
     int fCurrentScale = 0;
     int fCurrentSKP = 0;
     int fCurrentSVG = 0;
@@ -1550,6 +1662,8 @@ int main(int argc, char** argv) {
                 }
             }
 
+            bench->getMetrics(&keys, &values);
+
             bench->perCanvasPostDraw(canvas);
 
             if (Benchmark::Backend::kNonRendering != target->config.backend &&
@@ -1582,7 +1696,7 @@ int main(int argc, char** argv) {
             log.endArray(); // samples
             benchStream.fillCurrentMetrics(log);
             if (!keys.empty()) {
-                // dump to json, only SKPBench currently returns valid keys / values
+                // dump to json, from getGpuStats(), the DMSAA stats and getMetrics()
                 SkASSERT(keys.size() == values.size());
                 for (int j = 0; j < keys.size(); j++) {
                     log.appendMetric(keys[j].c_str(), values[j]);
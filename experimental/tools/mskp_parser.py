@@ -30,7 +30,7 @@ if magic != magic_constant:
 version, page_count = struct.unpack('II', src.read(8))[:2]
 print('MSKP version: ', version)
 print('page count: ', page_count)
-if version > 2 or version < 1:
+if version > 3 or version < 1:
   #TODO(halcanary): Remove support for version 1.
   sys.stderr.write('unsupported mskp version\n')
   exit(3)
@@ -41,13 +41,19 @@ for page in range(page_count):
     offset, size_x, size_y =struct.unpack('Qff', src.read(16))
     print('offset = %-7d\t' % offset, end='')
     offsets.append(offset)
-  elif version == 2:
+  else:
     size_x, size_y =struct.unpack('ff', src.read(8))
   print('size = (%r,%r)' % (size_x, size_y))
+if version == 3:
+  byte_counts = struct.unpack('%dI' % page_count, src.read(4 * page_count))
+  for page, byte_count in enumerate(byte_counts):
+    print('page %3d\tbytes = %d' % (page, byte_count))
 
 if len(sys.argv) >= 3:
   with open(sys.argv[2], 'wb') as o:
-    if version == 2 or len(offsets) < 2:
+    if version == 3:
+      o.write(src.read(byte_counts[0]))
+    elif version == 2 or len(offsets) < 2:
       while True:
         file_buffer = src.read(8192)
         if 0 == len(file_buffer):
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkThumbnails_DEFINED
+#define SkThumbnails_DEFINED
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkColorType.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSize.h"
+#include "include/core/SkSpan.h"
+#include "include/private/base/SkAPI.h"
+
+#include <vector>
+
+class SkData;
+class SkExecutor;
+
+namespace SkThumbnails {
+
+struct Options {
+    /**
+     *  The color type of the thumbnails.
+     */
+    SkColorType fColorType = kN32_SkColorType;
+
+    /**
+     *  If set, images are decoded on this executor's threads. Otherwise they are all decoded on
+     *  the calling thread.
+     */
+    SkExecutor* fExecutor = nullptr;
+
+    /**
+     *  The maximum number of images that are decoded at once. Each decode needs memory for the
+     *  image at its natively downscaled size (see below), so this bounds the memory used beyond
+     *  the thumbnails themselves.
+     */
+    int fMaxConcurrentDecodes = 4;
+};
+
+/**
+ *  Decode each encoded image to a thumbnail that fits within maxSize, keeping its aspect ratio.
+ *  Images that already fit are decoded at their original size.
+ *
+ *  Each image is first decoded at the smallest size its codec can produce natively (e.g. with
+ *  JPEG DCT scaling, or a sampled decode) that is no smaller than the thumbnail, and then
+ *  resampled to the thumbnail's size with a cubic filter.
+ *
+ *  Returns one bitmap per input, in the same order. The bitmap for an input that could not be
+ *  decoded is empty. Does not return until every image has been decoded.
+ */
+SK_API std::vector<SkBitmap> Decode(SkSpan<const sk_sp<SkData>> encoded,
+                                    SkISize maxSize,
+                                    const Options& options = {});
+
+}  // namespace SkThumbnails
+
+#endif  // SkThumbnails_DEFINED
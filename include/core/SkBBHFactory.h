@@ -21,12 +21,14 @@ class SkBBoxHierarchy : public SkRefCnt {
 public:
     struct Metadata {
         bool isDraw;  // The corresponding SkRect bounds a draw command, not a pure state change.
+        bool isOccluded;  // Later draws cover this draw with opaque pixels, so it can be skipped.
     };
 
     /**
      * Insert N bounding boxes into the hierarchy.
      */
     virtual void insert(const SkRect[], int N) = 0;
+    // By default, leaves out occluded bounding boxes and ignores the rest of the Metadata.
     virtual void insert(const SkRect[], const Metadata[], int N);
 
     /**
@@ -64,4 +66,14 @@ public:
     sk_sp<SkBBoxHierarchy> operator()() const override;
 };
 
+/**
+ *  Makes a packed R-tree: slower to build than SkRTreeFactory's, because it sorts the bounds
+ *  spatially, but faster to search, particularly when the drawing order is not spatially
+ *  coherent and only part of the picture is drawn.
+ */
+class SK_API SkPackedRTreeFactory : public SkBBHFactory {
+public:
+    sk_sp<SkBBoxHierarchy> operator()() const override;
+};
+
 #endif
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkDecodedImageCache_DEFINED
+#define SkDecodedImageCache_DEFINED
+
+#include "include/core/SkRefCnt.h"
+#include "include/private/base/SkAPI.h"
+
+class SkData;
+
+/**
+ *  Abstract class which stores decoded image pixels in a second-tier cache, one that may outlive
+ *  the in-memory resource cache (e.g. on disk, and between sessions).
+ *
+ *  When installed with SkGraphics::SetDecodedImageCache(), lazily decoded raster images (see
+ *  SkImages::DeferredFromEncodedData) that miss the resource cache look here before decoding,
+ *  and store the pixels they do decode. Keys are derived from a hash of the encoded data and the
+ *  decoded SkImageInfo, so they are stable across processes.
+ *
+ *  Implementations must be thread-safe: load() and store() may be called concurrently.
+ */
+class SK_API SkDecodedImageCache : public SkRefCnt {
+public:
+    /**
+     *  Returns the data for the key if it exists in the cache, otherwise returns null. Data
+     *  returned by a file-backed cache should be memory-mapped rather than read, so that
+     *  unused pixels never need to be paged in.
+     */
+    virtual sk_sp<SkData> load(const SkData& key) = 0;
+
+    /**
+     *  Stores data in the cache, indexed by key. Implementations may drop the data.
+     */
+    virtual void store(const SkData& key, const SkData& data) = 0;
+
+    /**
+     *  Returns a cache that stores one file per entry in the existing directory 'dir', and maps
+     *  entries back in with SkData::MakeFromFileName(). Files are written to a temporary name and
+     *  then renamed into place, so concurrent processes may share a directory. The cache never
+     *  deletes files; the client owns the directory's lifetime and size.
+     */
+    static sk_sp<SkDecodedImageCache> MakeFileCache(const char dir[]);
+
+protected:
+    SkDecodedImageCache() = default;
+    SkDecodedImageCache(const SkDecodedImageCache&) = delete;
+    SkDecodedImageCache& operator=(const SkDecodedImageCache&) = delete;
+};
+
+#endif
@@ -16,6 +16,7 @@
 #include <memory>
 
 class SkData;
+class SkDecodedImageCache;
 class SkImageGenerator;
 class SkOpenTypeSVGDecoder;
 class SkTraceMemoryDump;
@@ -140,6 +141,16 @@ public:
      */
     static void PurgeAllCaches();
 
+    /**
+     *  Installs a second-tier cache for decoded image pixels, consulted by lazily decoded raster
+     *  images when they miss the resource cache. See SkDecodedImageCache. Pass nullptr to remove
+     *  it. Thread-safe.
+     *
+     *  Returns the previous cache (which could be NULL).
+     */
+    static sk_sp<SkDecodedImageCache> SetDecodedImageCache(sk_sp<SkDecodedImageCache>);
+    static sk_sp<SkDecodedImageCache> GetDecodedImageCache();
+
     typedef std::unique_ptr<SkImageGenerator>
                                             (*ImageGeneratorFromEncodedDataFactory)(sk_sp<SkData>);
 
@@ -87,6 +87,22 @@ public:
     static sk_sp<SkPicture> MakeFromData(const void* data, size_t size,
                                          const SkDeserialProcs* procs = nullptr);
 
+    /** Recreates SkPicture that was serialized into data, like MakeFromData(), but plays back
+        the serialized drawing commands directly from data rather than rebuilding them, so
+        loading is faster and uses less memory. data may be a file mapped into memory, e.g. by
+        SkData::MakeFromFileName(). The returned SkPicture holds a reference to data.
+
+        The structure of the commands is validated when loading. Paths are parsed the first time
+        they are drawn; a path that fails to parse then is drawn as empty. Data written by older
+        versions of Skia can be loaded too, but more of it is copied and parsed up front.
+
+        @param data   container for serial data
+        @param procs  custom serial data decoders; may be nullptr
+        @return       SkPicture constructed from data
+    */
+    static sk_sp<SkPicture> MakeFromDataInPlace(sk_sp<SkData> data,
+                                                const SkDeserialProcs* procs = nullptr);
+
     /** \class SkPicture::AbortCallback
         AbortCallback is an abstract class. An implementation of AbortCallback may
         passed as a parameter to SkPicture::playback, to stop it before all drawing
@@ -253,12 +269,14 @@ private:
     friend class SkBigPicture;
     friend class SkEmptyPicture;
     friend class SkPicturePriv;
+    friend class SkPlaybackPicture;
 
     void serialize(SkWStream*, const SkSerialProcs*, class SkRefCntSet* typefaces,
         bool textBlobsOnly=false) const;
     static sk_sp<SkPicture> MakeFromStreamPriv(SkStream*, const SkDeserialProcs*,
                                                class SkTypefacePlayback*,
-                                               int recursionLimit);
+                                               int recursionLimit,
+                                               const sk_sp<SkData>& inPlace = nullptr);
     friend class SkPictureData;
 
     /** Return true if the SkStream/Buffer represents a serialized picture, and
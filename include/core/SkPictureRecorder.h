@@ -11,6 +11,7 @@
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkScalar.h"
+#include "include/core/SkSpan.h"
 #include "include/private/base/SkAPI.h"
 
 #include <memory>
@@ -25,6 +26,7 @@ class SkBBHFactory;
 class SkBBoxHierarchy;
 class SkCanvas;
 class SkDrawable;
+class SkExecutor;
 class SkPicture;
 class SkRecord;
 class SkRecorder;
@@ -55,6 +57,26 @@ public:
     */
     SkCanvas* getRecordingCanvas();
 
+    /** When recording with a bounding box hierarchy, also find the draws that later opaque draws
+        completely cover, and leave them out of the hierarchy so that playback skips them.
+        Off by default. Takes effect when the recording finishes.
+    */
+    void setCullOccludedDraws(bool cull) { fCullOccludedDraws = cull; }
+
+    /** When the recording finishes, drop the draws that a later opaque rect or paint fill, under
+        the same clip, completely covers, so that any playback skips them (with or without a
+        bounding box hierarchy). Only clips made while recording are considered: a dropped draw
+        at the edge of an anti-aliased clip applied at playback would have shown through slightly.
+        Off by default.
+    */
+    void setDropOccludedDraws(bool drop) { fDropOccludedDraws = drop; }
+
+    /** When the recording finishes, move the recorded commands into exactly sized storage and
+        let equal paths share their data. This costs a pass over the commands, but lowers the
+        memory kept by pictures that live long. Off by default.
+    */
+    void setCompactRecording(bool compact) { fCompactRecording = compact; }
+
     /**
      *  Signal that the caller is done recording. This invalidates the canvas returned by
      *  beginRecording/getRecordingCanvas. Ownership of the object is passed to the caller, who
@@ -90,9 +112,29 @@ public:
      */
     sk_sp<SkDrawable> finishRecordingAsDrawable();
 
+    /**
+     *  Signals that recording into each of parts is done, and splices what they recorded into one
+     *  picture, in order. Each part is played back inside its own save()/restore().
+     *
+     *  The parts may have been recorded concurrently, on different threads, but must not be used
+     *  again until this returns. Each part is finished as finishRecordingAsPicture() would,
+     *  concurrently on executor if one is given. Their drawing commands are then moved into the
+     *  returned picture, rather than nested in it as pictures, so that its playback culls
+     *  through each part's bounding box hierarchy (if it began recording with one).
+     *
+     *  @param parts     recorders that are recording
+     *  @param executor  optional; where to finish the parts
+     *  @return the picture containing the content recorded by all the parts.
+     */
+    static sk_sp<SkPicture> FinishRecordingAsConcatenatedPicture(
+            SkSpan<SkPictureRecorder* const> parts, SkExecutor* executor = nullptr);
+
 private:
     void reset();
 
+    // Stops recording, optimizes what was recorded, and fills fBBH, trimming fCullRect to it.
+    void finishRecord();
+
     /** Replay the current (partially recorded) operation stream into
         canvas. This call doesn't close the current recording.
     */
@@ -103,6 +145,9 @@ private:
     void partialReplay(SkCanvas* canvas) const;
 
     bool                        fActivelyRecording;
+    bool                        fCullOccludedDraws = false;
+    bool                        fDropOccludedDraws = false;
+    bool                        fCompactRecording = false;
     SkRect                      fCullRect;
     sk_sp<SkBBoxHierarchy>      fBBH;
     std::unique_ptr<SkRecorder> fRecorder;
@@ -15,6 +15,7 @@
 #include <optional>
 
 class SkData;
+class SkExecutor;
 class SkImage;
 class SkPicture;
 class SkTypeface;
@@ -92,6 +93,13 @@ struct SK_API SkSerialProcs {
 
     SkSerialTypefaceProc fTypefaceProc = nullptr;
     void*                fTypefaceCtx = nullptr;
+
+    // If positive, paths are written with each coordinate rounded to a multiple of
+    // 1/2^fPathPrecisionBits (at most 24), and stored as the variable-length difference from the
+    // one before. This is lossy, but usually makes path-heavy pictures much smaller. Paths that
+    // are rects, ovals or round rects (SkPath::isRect() etc.), and paths that this would not make
+    // smaller, are written exactly.
+    int                  fPathPrecisionBits = 0;
 };
 
 struct SK_API SkDeserialProcs {
@@ -112,6 +120,11 @@ struct SK_API SkDeserialProcs {
     // parameters and returns a bool). Given that there are only two valid implementations of that
     // proc, we just insert the bool directly.
     bool                         fAllowSkSL = true;
+
+    // If set, SkPicture::MakeFromData() and friends decode a picture's images on this executor,
+    // while the rest of the picture is read on the calling thread. fImageProc and fImageDataProc
+    // may then be called concurrently, from the executor's threads.
+    SkExecutor*                  fExecutor = nullptr;
 };
 
 #endif
@@ -14,6 +14,7 @@
 #include "include/core/SkTypes.h"
 
 #include <functional>
+#include <memory>
 
 class SkDocument;
 class SkStreamSeekable;
@@ -48,6 +49,39 @@ SK_API bool Read(SkStreamSeekable* src,
                  SkDocumentPage* dstArray,
                  int dstArrayCount,
                  const SkDeserialProcs* = nullptr);
+
+/**
+ *  Reads the pages of an SkMultiPictureDocument one at a time, as they are asked for, rather than
+ *  all at once like Read(). Documents written by Make() store where each page starts, so reading
+ *  a page costs only that page. Documents written by older versions of Skia hold one picture
+ *  drawing every page, so the first page read from them reads them all.
+ *
+ *  Procs that share data between pages (e.g. images serialized only where they first appear)
+ *  need the pages read in order.
+ *
+ *  A Reader is not thread safe.
+ */
+class SK_API Reader {
+public:
+    /**
+     *  Returns nullptr if the stream does not hold an SkMultiPictureDocument. Only the header is
+     *  read here. The most recently read maxCachedPages pages are kept, to be returned again
+     *  without reading them.
+     */
+    static std::unique_ptr<Reader> Make(std::unique_ptr<SkStreamSeekable>,
+                                        const SkDeserialProcs* = nullptr,
+                                        int maxCachedPages = 8);
+
+    virtual ~Reader() = default;
+
+    virtual int pageCount() const = 0;
+
+    /** Returns the size of page i, or an empty size if i is out of range. */
+    virtual SkSize pageSize(int i) const = 0;
+
+    /** Returns page i, or nullptr if i is out of range or the page can't be read. */
+    virtual sk_sp<SkPicture> readPage(int i) = 0;
+};
 }  // namespace SkMultiPictureDocument
 
 #endif  // SkMultiPictureDocument_DEFINED
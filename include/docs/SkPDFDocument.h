@@ -168,6 +168,36 @@ struct Metadata {
     */
     SkExecutor* fExecutor = nullptr;
 
+    /** If true, each page's dictionary and content are written to the stream as
+        soon as the page ends, rather than kept until the document closes, and
+        no more than a few jobs are left queued on fExecutor at the end of each
+        page. Memory then no longer holds every page, nor the data of the images
+        they drew.
+
+        Memory still grows with the document, though more slowly: it keeps an
+        object number for each page, and for each distinct image, shader and
+        graphic state (used to deduplicate them); every font's glyph usage,
+        since fonts are written when the document closes; and, if the document
+        is tagged, its structure tree.
+
+        In this mode images are deduplicated by their ID across the document,
+        but by their encoded data only within a page, and never by comparing
+        their pixels.
+
+        Experimental.
+    */
+    bool fIncremental = false;
+
+    /** If true, write a PDF 1.5 file: objects that are not streams (dictionaries,
+        arrays, ...) are packed together into compressed object streams, and the
+        cross-reference table is replaced by a compressed cross-reference stream.
+        Documents with many small objects, e.g. text-heavy ones, get considerably
+        smaller, but readers that only support PDF 1.4 can't open them.
+
+        Experimental.
+    */
+    bool fObjectStreams = false;
+
     /** PDF streams may be compressed to save space.
         Use this to specify the desired compression vs time tradeoff.
     */
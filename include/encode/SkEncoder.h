@@ -9,12 +9,17 @@
 #define SkEncoder_DEFINED
 
 #include "include/core/SkPixmap.h"
+#include "include/core/SkRefCnt.h"
 #include "include/private/base/SkAPI.h"
 #include "include/private/base/SkNoncopyable.h"
 #include "include/private/base/SkTemplates.h"
 
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+
+class SkMatrix;
+class SkPicture;
 
 class SK_API SkEncoder : SkNoncopyable {
 public:
@@ -43,6 +48,37 @@ public:
      */
     bool encodeRows(int numRows);
 
+    /**
+     *  Encode the next |rows.height()| rows of input, reading them from |rows| rather than from
+     *  the pixmap the encoder was made with. |rows| must have the same width, color type and
+     *  alpha type as that pixmap. Returns false if it does not, or if the encoder cannot take
+     *  rows this way.
+     *
+     *  This is how rows are supplied to an encoder made from an SkImageInfo, without pixels.
+     */
+    bool encodeRows(const SkPixmap& rows);
+
+    /**
+     *  Fills |rows| with the rows of the image starting at row |top|. |rows| has the image's
+     *  width, color type, alpha type and color space. Returns false to stop encoding.
+     */
+    using FillRowsProc = std::function<bool(int top, const SkPixmap& rows)>;
+
+    /**
+     *  Encode all of the remaining rows, |bandHeight| at a time: |fillRows| is asked for each
+     *  band in turn, and the band is then encoded with encodeRows(const SkPixmap&). Only one band
+     *  of pixels is ever allocated, so this can encode images that are too large to hold in
+     *  memory all at once.
+     */
+    bool encodeBands(int bandHeight, const FillRowsProc& fillRows);
+
+    /**
+     *  Returns a FillRowsProc that draws |picture| into each band, transformed by |matrix| if it
+     *  is not null, over transparent black. Recording the picture with a bounding box hierarchy
+     *  (e.g. SkRTreeFactory) lets each band skip the draws that fall outside of it.
+     */
+    static FillRowsProc PictureRows(sk_sp<SkPicture> picture, const SkMatrix* matrix = nullptr);
+
     virtual ~SkEncoder() {}
 
 protected:
@@ -55,9 +91,19 @@ protected:
         , fStorage(storageBytes)
     {}
 
-    const SkPixmap&        fSrc;
+    // Returns row |y| of the input: from the rows given to encodeRows(const SkPixmap&), while
+    // there are some.
+    const void* srcRow(int y) const {
+        return fRows ? fRows->addr(0, y - fRowsTop) : fSrc.addr(0, y);
+    }
+
+    const SkPixmap         fSrc;
     int                    fCurrRow;
     skia_private::AutoTMalloc<uint8_t> fStorage;
+
+    // The rows passed to encodeRows(const SkPixmap&), which start at row fRowsTop of the input.
+    const SkPixmap*        fRows = nullptr;
+    int                    fRowsTop = 0;
 };
 
 #endif
@@ -16,7 +16,9 @@
 class SkColorSpace;
 class SkData;
 class SkEncoder;
+class SkExecutor;
 class SkPixmap;
+struct SkImageInfo;
 class SkWStream;
 class SkImage;
 class GrDirectContext;
@@ -86,6 +88,17 @@ struct Options {
      */
     const skcms_ICCProfile* fICCProfile = nullptr;
     const char* fICCProfileDescription = nullptr;
+
+    /**
+     *  If set, Encode() compresses horizontal bands of the image in parallel on this executor,
+     *  and joins them into one baseline JPEG. The bands are separated by restart markers (there
+     *  is one after every row of MCUs), and every band uses the standard Huffman tables rather
+     *  than tables optimized for the image, so the output is larger (by as much as a quarter
+     *  for noisy images). It decodes to the same pixels.
+     *
+     *  Encoders returned by Make(), and YUVA encodes, ignore this.
+     */
+    SkExecutor* fExecutor = nullptr;
 };
 
 /**
@@ -123,6 +136,18 @@ SK_API std::unique_ptr<SkEncoder> Make(SkWStream* dst,
                                        const SkYUVAPixmaps& src,
                                        const SkColorSpace* srcColorSpace,
                                        const Options& options);
+
+/**
+ *  Create a jpeg encoder for an image described by |info|, whose pixels are not in memory. The
+ *  rows must be supplied with SkEncoder::encodeRows(const SkPixmap&) or SkEncoder::encodeBands().
+ *
+ *  |dst| is unowned but must remain valid for the lifetime of the object.
+ *
+ *  This returns nullptr on an invalid or unsupported |info|.
+ */
+SK_API std::unique_ptr<SkEncoder> Make(SkWStream* dst,
+                                       const SkImageInfo& info,
+                                       const Options& options);
 }  // namespace SkJpegEncoder
 
 #endif
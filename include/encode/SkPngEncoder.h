@@ -19,7 +19,9 @@
 
 class GrDirectContext;
 class SkData;
+class SkExecutor;
 class SkImage;
+struct SkImageInfo;
 class SkPixmap;
 class SkWStream;
 struct skcms_ICCProfile;
@@ -38,6 +40,19 @@ enum class FilterFlag : int {
 
 inline FilterFlag operator|(FilterFlag x, FilterFlag y) { return (FilterFlag)((int)x | (int)y); }
 
+enum class Profile {
+    kDefault,
+    /**
+     *  Trades compression for encoding speed. Meant for content like screenshots and UI, with
+     *  large flat areas, where it is typically several times faster than kDefault for output
+     *  that is somewhat larger.
+     *
+     *  One filter (of those in fFilterFlags) is chosen for the whole image, from a sample of the
+     *  rows available when encoding starts, and zlib looks only for runs (its Z_RLE strategy).
+     */
+    kFast,
+};
+
 struct Options {
     /**
      *  Selects which filtering strategies to use.
@@ -64,6 +79,11 @@ struct Options {
      */
     int fZLibLevel = 6;
 
+    /**
+     *  See Profile above.
+     */
+    Profile fProfile = Profile::kDefault;
+
     /**
      *  Represents comments in the tEXt ancillary chunk of the png.
      *  The 2i-th entry is the keyword for the i-th comment,
@@ -80,6 +100,15 @@ struct Options {
      */
     const skcms_ICCProfile* fICCProfile = nullptr;
     const char* fICCProfileDescription = nullptr;
+
+    /**
+     *  If set, Encode() filters and compresses bands of rows in parallel on this executor, and
+     *  joins the compressed bands into a single zlib stream. Each band is compressed without
+     *  the history of the bands before it, so the output may be slightly larger.
+     *
+     *  Encoders returned by Make() ignore this, and always encode on the calling thread.
+     */
+    SkExecutor* fExecutor = nullptr;
 };
 
 /**
@@ -112,6 +141,18 @@ SK_API sk_sp<SkData> Encode(GrDirectContext* ctx, const SkImage* img, const Opti
  */
 SK_API std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkPixmap& src, const Options& options);
 
+/**
+ *  Create a png encoder for an image described by |info|, whose pixels are not in memory. The
+ *  rows must be supplied with SkEncoder::encodeRows(const SkPixmap&) or SkEncoder::encodeBands().
+ *
+ *  |dst| is unowned but must remain valid for the lifetime of the object.
+ *
+ *  This returns nullptr on an invalid or unsupported |info|.
+ */
+SK_API std::unique_ptr<SkEncoder> Make(SkWStream* dst,
+                                       const SkImageInfo& info,
+                                       const Options& options);
+
 }  // namespace SkPngEncoder
 
 #endif
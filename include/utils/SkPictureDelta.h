@@ -0,0 +1,90 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPictureDelta_DEFINED
+#define SkPictureDelta_DEFINED
+
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSerialProcs.h"
+#include "include/core/SkTypes.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class SkData;
+class SkPicture;
+
+/**
+ * Streams a sequence of pictures (e.g. the frames of an animation) by sending each one as a delta
+ * against the one before it. The encoder hashes the content of every drawing command (its paint,
+ * geometry and resources), and sends runs of commands that also appeared in the previous picture
+ * as references to them. Only the remaining commands are serialized, together, as one picture.
+ *
+ *  SkPictureDeltaEncoder encoder;              |  SkPictureDeltaDecoder decoder;
+ *  for (each frame) {                          |  for (each delta received) {
+ *      send(encoder.encode(frame.get()));      |      sk_sp<SkPicture> frame = decoder.decode(
+ *  }                                           |              delta->data(), delta->size());
+ *                                              |  }
+ *
+ * Deltas must be decoded in the order they were encoded. The first delta, and every delta encoded
+ * after reset(), stands alone. Images, pictures and slugs are matched by their content, so that
+ * frames that hold new copies of the same resources (e.g. frames read back from a file) still
+ * match; typefaces are matched by their unique IDs. A command that is sent carries its images in
+ * full, as procs encodes them.
+ */
+class SK_API SkPictureDeltaEncoder {
+public:
+    explicit SkPictureDeltaEncoder(const SkSerialProcs& procs = {});
+    ~SkPictureDeltaEncoder();
+
+    /**
+     * Returns the delta from the previously encoded picture to this one, or the whole picture if
+     * there is none. Like SkPicture::serialize(), this drops any SkMesh the picture draws.
+     */
+    sk_sp<SkData> encode(const SkPicture* picture);
+
+    /**
+     * Forgets the previous picture, so that the next delta can be decoded without it (e.g. by a
+     * decoder that missed a delta, or joined late).
+     */
+    void reset();
+
+private:
+    SkSerialProcs fProcs;
+    // The content hash of each command of the previous picture.
+    std::vector<uint64_t> fHashes;
+    // The content hash of each image, picture and slug the previous picture drew, by kind and
+    // unique ID.
+    std::unordered_map<uint64_t, uint64_t> fContentHashes;
+};
+
+class SK_API SkPictureDeltaDecoder {
+public:
+    explicit SkPictureDeltaDecoder(const SkDeserialProcs& procs = {});
+    ~SkPictureDeltaDecoder();
+
+    /**
+     * Applies a delta made by SkPictureDeltaEncoder::encode() to the previously decoded picture.
+     * Returns nullptr if the data is invalid, or if it was encoded against a different picture
+     * (e.g. because a delta was lost). The next delta is then applied to the same previous
+     * picture.
+     */
+    sk_sp<SkPicture> decode(const void* data, size_t length);
+
+    /** Forgets the previous picture; only deltas that stand alone can be decoded next. */
+    void reset();
+
+private:
+    SkDeserialProcs  fProcs;
+    sk_sp<SkPicture> fLast;
+    // The encoder's hash of fLast, which deltas against it name.
+    uint64_t         fLastHash = 0;
+};
+
+#endif
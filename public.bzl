@@ -21,6 +21,7 @@ SKIA_PUBLIC_HDRS = [
     "include/codec/SkPngChunkReader.h",
     "include/codec/SkPngDecoder.h",
     "include/codec/SkRawDecoder.h",
+    "include/codec/SkThumbnails.h",
     "include/codec/SkWbmpDecoder.h",
     "include/codec/SkWebpDecoder.h",
     "include/config/SkUserConfig.h",
@@ -218,6 +219,7 @@ SKIA_PUBLIC_HDRS = [
     "include/utils/SkPaintFilterCanvas.h",
     "include/utils/SkParse.h",
     "include/utils/SkParsePath.h",
+    "include/utils/SkPictureDelta.h",
     "include/utils/SkShadowUtils.h",
     "include/utils/SkTextUtils.h",
     "include/utils/SkTraceEventPhase.h",
@@ -557,6 +559,8 @@ BASE_SRCS_ALL = [
     "src/core/SkOpts.h",
     "src/core/SkOptsTargets.h",
     "src/core/SkOverdrawCanvas.cpp",
+    "src/core/SkPackedRTree.cpp",
+    "src/core/SkPackedRTree.h",
     "src/core/SkPaint.cpp",
     "src/core/SkPaintDefaults.h",
     "src/core/SkPaintPriv.cpp",
@@ -588,6 +592,8 @@ BASE_SRCS_ALL = [
     "src/core/SkPixelRefPriv.h",
     "src/core/SkPixmap.cpp",
     "src/core/SkPixmapDraw.cpp",
+    "src/core/SkPlaybackPicture.cpp",
+    "src/core/SkPlaybackPicture.h",
     "src/core/SkPoint.cpp",
     "src/core/SkPoint3.cpp",
     "src/core/SkPointPriv.h",
@@ -1753,6 +1759,7 @@ BASE_SRCS_ALL = [
     "src/utils/SkParsePath.cpp",
     "src/utils/SkPatchUtils.cpp",
     "src/utils/SkPatchUtils.h",
+    "src/utils/SkPictureDelta.cpp",
     "src/utils/SkPolyUtils.cpp",
     "src/utils/SkPolyUtils.h",
     "src/utils/SkShaderUtils.cpp",
@@ -1847,6 +1854,7 @@ CODEC_SRCS_LIMITED = [
     "src/codec/SkSampler.h",
     "src/codec/SkSwizzler.cpp",
     "src/codec/SkSwizzler.h",
+    "src/codec/SkThumbnails.cpp",
     "src/codec/SkTiffUtility.cpp",
     "src/codec/SkTiffUtility.h",
     "src/codec/SkWbmpCodec.cpp",
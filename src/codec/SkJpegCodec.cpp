@@ -687,6 +687,149 @@ SkCodec::Result SkJpegCodec::onGetPixels(const SkImageInfo& dstInfo,
     return kSuccess;
 }
 
+SkCodec::Result SkJpegCodec::onStartIncrementalDecode(const SkImageInfo& dstInfo,
+                                                      void* dst, size_t rowBytes,
+                                                      const Options& options) {
+    jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
+    if (options.fSubset || !jpeg_has_multiple_scans(dinfo)) {
+        // A single scan is no better incrementally than it is with scanline decoding, which also
+        // handles subsets.
+        return kUnimplemented;
+    }
+
+    // Set the jump location for libjpeg errors
+    skjpeg_error_mgr::AutoPushJmpBuf jmp(fDecoderMgr->errorMgr());
+    if (setjmp(jmp)) {
+        return fDecoderMgr->returnFailure("setjmp", kInvalidInput);
+    }
+
+    // In buffered-image mode, libjpeg collects coefficients as they arrive, and can output the
+    // image as of any scan that it has finished reading.
+    dinfo->buffered_image = TRUE;
+    fDecoderMgr->setSuspending(true);
+    if (!jpeg_start_decompress(dinfo)) {
+        return fDecoderMgr->returnFailure("startDecompress", kInvalidInput);
+    }
+
+    if (needs_swizzler_to_convert_from_cmyk(dinfo->out_color_space,
+                                            this->getEncodedInfo().profile(), this->colorXform())) {
+        this->initializeSwizzler(dstInfo, options, true);
+    }
+
+    if (!this->allocateStorage(dstInfo)) {
+        return kInternalError;
+    }
+
+    fIncrementalDst = dst;
+    fIncrementalRowBytes = rowBytes;
+    fLastCompleteScan = 0;
+    fOutputScan = 0;
+    fFinishOutputPending = false;
+    return kSuccess;
+}
+
+SkCodec::Result SkJpegCodec::onIncrementalDecode(int* rowsDecoded) {
+    jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
+    const int height = this->dstInfo().height();
+    // SkSampledCodec sets the sampler's sampleY after starting the decode. Only every sampleY'th
+    // row is then written to the destination, which is sized for the sampled height.
+    const int sampleY = fSwizzler ? fSwizzler->sampleY() : 1;
+    const int dstHeight = get_scaled_dimension(height, sampleY);
+
+    // Every row is initialized once the first scan has been output.
+    auto incomplete = [&](Result result) {
+        if (rowsDecoded) {
+            *rowsDecoded = fOutputScan > 0 ? dstHeight : 0;
+        }
+        return result;
+    };
+
+    // libjpeg cannot continue after an error.
+    if (!fIncrementalDst) {
+        return incomplete(kErrorInInput);
+    }
+
+    // Set the jump location for libjpeg errors
+    skjpeg_error_mgr::AutoPushJmpBuf jmp(fDecoderMgr->errorMgr());
+    if (setjmp(jmp)) {
+        this->endIncrementalDecode();
+        return incomplete(fDecoderMgr->returnFailure("onIncrementalDecode", kErrorInInput));
+    }
+
+    // Consume all of the data that is available, noting the last scan that it completes.
+    while (!jpeg_input_complete(dinfo)) {
+        int status = jpeg_consume_input(dinfo);
+        if (JPEG_SCAN_COMPLETED == status) {
+            fLastCompleteScan = dinfo->input_scan_number;
+        } else if (JPEG_SUSPENDED == status && !fDecoderMgr->readAvailableInput()) {
+            break;
+        }
+    }
+    const bool inputComplete = jpeg_input_complete(dinfo);
+    if (inputComplete) {
+        fLastCompleteScan = dinfo->input_scan_number;
+    }
+
+    if (fLastCompleteScan > fOutputScan) {
+        // jpeg_finish_output() suspends if libjpeg has not yet seen the start of the next scan
+        // (or the end of the image). A new output pass cannot start until it has finished.
+        if (fFinishOutputPending && !jpeg_finish_output(dinfo)) {
+            return incomplete(kIncompleteInput);
+        }
+        fFinishOutputPending = false;
+
+        if (!jpeg_start_output(dinfo, fLastCompleteScan)) {
+            return incomplete(kIncompleteInput);
+        }
+        // The scan has been read completely, so this will not need to suspend for more input.
+        if (!this->outputIncrementalScan(sampleY, dstHeight)) {
+            this->endIncrementalDecode();
+            return incomplete(fDecoderMgr->returnFailure("readRows", kErrorInInput));
+        }
+        fOutputScan = fLastCompleteScan;
+        fFinishOutputPending = !jpeg_finish_output(dinfo);
+    }
+
+    if (inputComplete && fOutputScan == fLastCompleteScan) {
+        this->endIncrementalDecode();
+        return kSuccess;
+    }
+    return incomplete(kIncompleteInput);
+}
+
+bool SkJpegCodec::outputIncrementalScan(int sampleY, int dstHeight) {
+    const int height = this->dstInfo().height();
+    if (1 == sampleY) {
+        return this->readRows(this->dstInfo(), fIncrementalDst, fIncrementalRowBytes, height,
+                              this->options()) == height;
+    }
+
+    // Sampling always uses the swizzler, so rows that are not needed are read into its source
+    // row and dropped. libjpeg does not need the rest of the pass to be read.
+    SkASSERT(fSwizzleSrcRow);
+    JSAMPLE* skipRow = (JSAMPLE*) fSwizzleSrcRow;
+    int srcY = 0;
+    for (int dstY = 0; dstY < dstHeight; dstY++) {
+        for (const int needed = get_start_coord(sampleY) + dstY * sampleY; srcY < needed; srcY++) {
+            if (1 != jpeg_read_scanlines(fDecoderMgr->dinfo(), &skipRow, 1)) {
+                return false;
+            }
+        }
+        void* dst = SkTAddOffset<void>(fIncrementalDst, fIncrementalRowBytes * dstY);
+        if (1 != this->readRows(this->dstInfo(), dst, fIncrementalRowBytes, 1, this->options())) {
+            return false;
+        }
+        srcY++;
+    }
+    return true;
+}
+
+void SkJpegCodec::endIncrementalDecode() {
+    fIncrementalDst = nullptr;
+    fDecoderMgr->setSuspending(false);
+    fDecoderMgr->dinfo()->buffered_image = FALSE;
+}
+
 bool SkJpegCodec::allocateStorage(const SkImageInfo& dstInfo) {
     int dstWidth = dstInfo.width();
 
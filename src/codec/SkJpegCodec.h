@@ -59,6 +59,15 @@ protected:
     Result onGetPixels(const SkImageInfo& dstInfo, void* dst, size_t dstRowBytes, const Options&,
             int*) override;
 
+    /*
+     * Incremental decoding is supported for images with multiple scans (e.g. progressive jpegs).
+     * Each call consumes the data that is available, and writes the most refined version of the
+     * full image that it allows to the destination.
+     */
+    Result onStartIncrementalDecode(const SkImageInfo& dstInfo, void* dst, size_t rowBytes,
+                                    const Options&) override;
+    Result onIncrementalDecode(int* rowsDecoded) override;
+
     bool onQueryYUVAInfo(const SkYUVAPixmapInfo::SupportedDataTypes&,
                          SkYUVAPixmapInfo*) const override;
 
@@ -130,6 +139,10 @@ private:
                             bool needsCMYKToRGB);
     [[nodiscard]] bool allocateStorage(const SkImageInfo& dstInfo);
     int readRows(const SkImageInfo& dstInfo, void* dst, size_t rowBytes, int count, const Options&);
+    // Writes the current output pass to fIncrementalDst, keeping every sampleY'th row.
+    bool outputIncrementalScan(int sampleY, int dstHeight);
+    // Leaves buffered-image and suspending mode once an incremental decode succeeds or fails.
+    void endIncrementalDecode();
 
     /*
      * Scanline decoding.
@@ -158,6 +171,14 @@ private:
 
     std::unique_ptr<SkSwizzler>        fSwizzler;
 
+    // Incremental decoding state. libjpeg runs in buffered-image mode, and each complete scan
+    // that has not been output yet replaces the previous output.
+    void*  fIncrementalDst = nullptr;
+    size_t fIncrementalRowBytes = 0;
+    int    fLastCompleteScan = 0;
+    int    fOutputScan = 0;
+    bool   fFinishOutputPending = false;
+
     friend class SkRawCodec;
 
     using INHERITED = SkCodec;
@@ -20,6 +20,13 @@ static constexpr uint8_t kJpegMarkerEndOfImage = 0xD9;
 // The header of a JPEG file is the data in all segments before the first StartOfScan.
 static constexpr uint8_t kJpegMarkerStartOfScan = 0xDA;
 
+// The frame header of a baseline JPEG, which holds the image's dimensions.
+static constexpr uint8_t kJpegMarkerStartOfFrameBaseline = 0xC0;
+
+// Restart markers RST0 through RST7 separate restart intervals of entropy-coded data, and are
+// numbered modulo 8.
+static constexpr uint8_t kJpegMarkerRestart0 = 0xD0;
+
 // Metadata and auxiliary images are stored in the APP1 through APP15 markers.
 static constexpr uint8_t kJpegMarkerAPP0 = 0xE0;
 
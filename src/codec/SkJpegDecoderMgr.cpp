@@ -89,6 +89,12 @@ SkJpegSourceMgr* JpegDecoderMgr::getSourceMgr() {
     return fSrcMgr.fSourceMgr.get();
 }
 
+bool JpegDecoderMgr::readAvailableInput() {
+    SkASSERT(fSrcMgr.fSuspending);
+    return fSrcMgr.fSourceMgr->appendAvailableInput(fSrcMgr.next_input_byte,
+                                                    fSrcMgr.bytes_in_buffer);
+}
+
 JpegDecoderMgr::JpegDecoderMgr(SkStream* stream)
         : fSrcMgr(SkJpegSourceMgr::Make(stream)), fInit(false) {
     // Error manager must be set before any calls to libjeg in order to handle failures
@@ -135,6 +141,11 @@ void JpegDecoderMgr::SourceMgr::SkipInputData(j_decompress_ptr dinfo, long num_b
 // static
 boolean JpegDecoderMgr::SourceMgr::FillInputBuffer(j_decompress_ptr dinfo) {
     JpegDecoderMgr::SourceMgr* src = (JpegDecoderMgr::SourceMgr*)dinfo->src;
+    if (src->fSuspending) {
+        // Leave the unconsumed bytes in place. libjpeg will back up to the start of the unit it
+        // was reading, and try again once readAvailableInput() has appended more data.
+        return false;
+    }
     if (!src->fSourceMgr->fillInputBuffer(src->next_input_byte, src->bytes_in_buffer)) {
         SkCodecPrintf("Failure to fill input buffer.\n");
         src->next_input_byte = nullptr;
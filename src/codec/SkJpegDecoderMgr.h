@@ -71,6 +71,19 @@ public:
     // Get the source manager.
     SkJpegSourceMgr* getSourceMgr();
 
+    /*
+     * Put the source manager into (or out of) suspending mode, for incremental decodes. In this
+     * mode libjpeg suspends, rather than failing, when it runs out of data, and keeps its place
+     * so that it can resume once readAvailableInput() has supplied more.
+     */
+    void setSuspending(bool suspending) { fSrcMgr.fSuspending = suspending; }
+
+    /*
+     * In suspending mode, read whatever the stream has available into the source manager's
+     * buffer, after the bytes libjpeg has yet to consume. Returns false if there was nothing new.
+     */
+    bool readAvailableInput();
+
 private:
     // Wrapper that calls into the full SkJpegSourceMgr interface.
     struct SourceMgr : jpeg_source_mgr {
@@ -81,6 +94,7 @@ private:
 
         SourceMgr(std::unique_ptr<SkJpegSourceMgr> mgr);
         std::unique_ptr<SkJpegSourceMgr> fSourceMgr;
+        bool fSuspending = false;
     };
 
     jpeg_decompress_struct fDInfo;
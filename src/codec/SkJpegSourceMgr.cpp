@@ -18,6 +18,9 @@
 #include "src/codec/SkJpegSegmentScan.h"
 #endif  // SK_CODEC_DECODES_JPEG_GAINMAPS
 
+#include <cstring>
+#include <utility>
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // SkStream helpers.
 
@@ -122,7 +125,8 @@ public:
 
 class SkJpegBufferedSourceMgr : public SkJpegSourceMgr {
 public:
-    SkJpegBufferedSourceMgr(SkStream* stream, size_t bufferSize) : SkJpegSourceMgr(stream) {
+    SkJpegBufferedSourceMgr(SkStream* stream, size_t bufferSize)
+            : SkJpegSourceMgr(stream), fReadSize(bufferSize) {
         fBuffer = SkData::MakeUninitialized(bufferSize);
     }
     ~SkJpegBufferedSourceMgr() override {}
@@ -163,6 +167,26 @@ public:
         nextInputByte = fBuffer->bytes();
         return true;
     }
+    bool appendAvailableInput(const uint8_t*& nextInputByte, size_t& bytesInBuffer) override {
+        // Move the unconsumed bytes to the front of the buffer, growing it if they would not
+        // leave room for another read. libjpeg may need to see an entire marker segment or MCU
+        // at once, so the unconsumed bytes can outgrow the original buffer.
+        if (bytesInBuffer + fReadSize > fBuffer->size()) {
+            sk_sp<SkData> grown = SkData::MakeUninitialized(bytesInBuffer + fReadSize);
+            if (bytesInBuffer > 0) {
+                memcpy(grown->writable_data(), nextInputByte, bytesInBuffer);
+            }
+            fBuffer = std::move(grown);
+        } else if (bytesInBuffer > 0) {
+            memmove(fBuffer->writable_data(), nextInputByte, bytesInBuffer);
+        }
+
+        uint8_t* buffer = static_cast<uint8_t*>(fBuffer->writable_data());
+        size_t bytesRead = fStream->read(buffer + bytesInBuffer, fReadSize);
+        nextInputByte = buffer;
+        bytesInBuffer += bytesRead;
+        return bytesRead > 0;
+    }
 #ifdef SK_CODEC_DECODES_JPEG_GAINMAPS
     const std::vector<SkJpegSegment>& getAllSegments() override {
         if (fScanner) {
@@ -243,6 +267,9 @@ public:
 
 private:
     sk_sp<SkData> fBuffer;
+
+    // The number of bytes to read from fStream at a time.
+    const size_t fReadSize;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -437,3 +464,7 @@ std::unique_ptr<SkJpegSourceMgr> SkJpegSourceMgr::Make(SkStream* stream, size_t
 SkJpegSourceMgr::SkJpegSourceMgr(SkStream* stream) : fStream(stream) {}
 
 SkJpegSourceMgr::~SkJpegSourceMgr() = default;
+
+bool SkJpegSourceMgr::appendAvailableInput(const uint8_t*&, size_t&) {
+    return false;
+}
@@ -48,6 +48,13 @@ public:
                                 const uint8_t*& nextInputByte,
                                 size_t& bytesInBuffer) = 0;
 
+    // Used by suspending (incremental) decodes instead of fillInputBuffer. Keep the |bytesInBuffer|
+    // bytes at |nextInputByte| that libjpeg has yet to consume, and append whatever data the stream
+    // has available after them. Return false if no new data was available. The default
+    // implementation always returns false, which suits sources that have all of their data up
+    // front.
+    virtual bool appendAvailableInput(const uint8_t*& nextInputByte, size_t& bytesInBuffer);
+
 #ifdef SK_CODEC_DECODES_JPEG_GAINMAPS
     // Parse this stream all the way through its EndOfImage marker and return the list of segments.
     // Return false if there is an error or if no EndOfImage marker is found.
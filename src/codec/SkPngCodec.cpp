@@ -150,6 +150,22 @@ static inline bool is_chunk(const png_byte* chunk, const char* tag) {
 
 static inline bool process_data(png_structp png_ptr, png_infop info_ptr,
         SkStream* stream, void* buffer, size_t bufferSize, size_t length) {
+    // If the stream is backed by memory (e.g. an SkMemoryStream wrapping an mmapped file), hand
+    // libpng the chunk in place instead of copying it through |buffer|. libpng does not write to
+    // the data passed to png_process_data().
+    if (stream->getMemoryBase() && stream->hasPosition() && stream->hasLength()) {
+        const size_t position = stream->getPosition();
+        const size_t available = stream->getLength() - std::min(position, stream->getLength());
+        const size_t bytesToProcess = std::min(available, length);
+        const uint8_t* data = static_cast<const uint8_t*>(stream->getMemoryBase()) + position;
+        // Advance the stream first, since png_process_data may longjmp.
+        if (stream->skip(bytesToProcess) != bytesToProcess) {
+            return false;
+        }
+        png_process_data(png_ptr, info_ptr, const_cast<png_bytep>(data), bytesToProcess);
+        return bytesToProcess == length;
+    }
+
     while (length > 0) {
         const size_t bytesToProcess = std::min(bufferSize, length);
         const size_t bytesRead = stream->read(buffer, bytesToProcess);
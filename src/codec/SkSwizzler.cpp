@@ -308,6 +308,12 @@ static void fast_swizzle_gray_to_n32(
     SkOpts::gray_to_RGB1((uint32_t*) dst, src + offset, width);
 }
 
+static void sampled_swizzle_gray_to_n32(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+    SkOpts::gray_to_RGB1_sampled((uint32_t*) dst, src + offset, width, deltaSrc / bpp);
+}
+
 static void swizzle_gray_to_565(
         void* SK_RESTRICT dstRow, const uint8_t* SK_RESTRICT src, int dstWidth,
         int bytesPerPixel, int deltaSrc, int offset, const SkPMColor ctable[]) {
@@ -445,6 +451,18 @@ static void fast_swizzle_rgb_to_bgra(
     SkOpts::RGB_to_BGR1((uint32_t*) dst, src + offset, width);
 }
 
+static void sampled_swizzle_rgb_to_rgba(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc,
+        int offset, const SkPMColor ctable[]) {
+    SkOpts::RGB_to_RGB1_sampled((uint32_t*) dst, src + offset, width, deltaSrc / bpp);
+}
+
+static void sampled_swizzle_rgb_to_bgra(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc,
+        int offset, const SkPMColor ctable[]) {
+    SkOpts::RGB_to_BGR1_sampled((uint32_t*) dst, src + offset, width, deltaSrc / bpp);
+}
+
 static void swizzle_rgb_to_565(
        void* SK_RESTRICT dstRow, const uint8_t* SK_RESTRICT src, int dstWidth,
        int bytesPerPixel, int deltaSrc, int offset, const SkPMColor ctable[]) {
@@ -505,6 +523,18 @@ static void fast_swizzle_rgba_to_bgra_premul(
     SkOpts::RGBA_to_bgrA((uint32_t*) dst, (const uint32_t*)(src + offset), width);
 }
 
+static void sampled_swizzle_rgba_to_rgba_premul(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc,
+        int offset, const SkPMColor ctable[]) {
+    SkOpts::RGBA_to_rgbA_sampled((uint32_t*) dst, src + offset, width, deltaSrc / bpp);
+}
+
+static void sampled_swizzle_rgba_to_bgra_premul(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc,
+        int offset, const SkPMColor ctable[]) {
+    SkOpts::RGBA_to_bgrA_sampled((uint32_t*) dst, src + offset, width, deltaSrc / bpp);
+}
+
 static void swizzle_rgba_to_bgra_unpremul(
         void* SK_RESTRICT dstRow, const uint8_t* SK_RESTRICT src, int dstWidth,
         int bpp, int deltaSrc, int offset, const SkPMColor ctable[]) {
@@ -529,6 +559,12 @@ static void fast_swizzle_rgba_to_bgra_unpremul(
     SkOpts::RGBA_to_BGRA((uint32_t*) dst, (const uint32_t*)(src + offset), width);
 }
 
+static void sampled_swizzle_rgba_to_bgra_unpremul(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+    SkOpts::RGBA_to_BGRA_sampled((uint32_t*) dst, src + offset, width, deltaSrc / bpp);
+}
+
 // 16-bits per component kRGB and kRGBA
 
 static void swizzle_rgb16_to_rgba(
@@ -814,7 +850,7 @@ std::unique_ptr<SkSwizzler> SkSwizzler::MakeSimple(int srcBPP, const SkImageInfo
             return nullptr;
     }
 
-    return Make(dstInfo, &copy, proc, nullptr /*ctable*/, srcBPP,
+    return Make(dstInfo, &copy, proc, nullptr /*sampledProc*/, nullptr /*ctable*/, srcBPP,
                 dstInfo.bytesPerPixel(), options, nullptr /*frame*/);
 }
 
@@ -828,6 +864,7 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
     }
 
     RowProc fastProc = nullptr;
+    RowProc sampledProc = nullptr;
     RowProc proc = nullptr;
     SkCodec::ZeroInitialized zeroInit = options.fZeroInitialized;
     const bool premultiply = (SkEncodedInfo::kOpaque_Alpha != encodedInfo.alpha()) &&
@@ -861,6 +898,7 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                         case kBGRA_8888_SkColorType:
                             proc = &swizzle_gray_to_n32;
                             fastProc = &fast_swizzle_gray_to_n32;
+                            sampledProc = &sampled_swizzle_gray_to_n32;
                             break;
                         case kGray_8_SkColorType:
                             proc = &sample1;
@@ -967,6 +1005,7 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                     SkASSERT(8 == encodedInfo.bitsPerComponent());
                     proc = &swizzle_rgb_to_rgba;
                     fastProc = &fast_swizzle_rgb_to_rgba;
+                    sampledProc = &sampled_swizzle_rgb_to_rgba;
                     break;
                 case kBGRA_8888_SkColorType:
                     if (16 == encodedInfo.bitsPerComponent()) {
@@ -977,6 +1016,7 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                     SkASSERT(8 == encodedInfo.bitsPerComponent());
                     proc = &swizzle_rgb_to_bgra;
                     fastProc = &fast_swizzle_rgb_to_bgra;
+                    sampledProc = &sampled_swizzle_rgb_to_bgra;
                     break;
                 case kRGB_565_SkColorType:
                     if (16 == encodedInfo.bitsPerComponent()) {
@@ -1005,9 +1045,12 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                             proc = &SkipLeading8888ZerosThen<swizzle_rgba_to_rgba_premul>;
                             fastProc = &SkipLeading8888ZerosThen
                                     <fast_swizzle_rgba_to_rgba_premul>;
+                            sampledProc = &SkipLeading8888ZerosThen
+                                    <sampled_swizzle_rgba_to_rgba_premul>;
                         } else {
                             proc = &swizzle_rgba_to_rgba_premul;
                             fastProc = &fast_swizzle_rgba_to_rgba_premul;
+                            sampledProc = &sampled_swizzle_rgba_to_rgba_premul;
                         }
                     } else {
                         if (SkCodec::kYes_ZeroInitialized == zeroInit) {
@@ -1032,18 +1075,24 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                             proc = &SkipLeading8888ZerosThen<swizzle_rgba_to_bgra_premul>;
                             fastProc = &SkipLeading8888ZerosThen
                                     <fast_swizzle_rgba_to_bgra_premul>;
+                            sampledProc = &SkipLeading8888ZerosThen
+                                    <sampled_swizzle_rgba_to_bgra_premul>;
                         } else {
                             proc = &swizzle_rgba_to_bgra_premul;
                             fastProc = &fast_swizzle_rgba_to_bgra_premul;
+                            sampledProc = &sampled_swizzle_rgba_to_bgra_premul;
                         }
                     } else {
                         if (SkCodec::kYes_ZeroInitialized == zeroInit) {
                             proc = &SkipLeading8888ZerosThen<swizzle_rgba_to_bgra_unpremul>;
                             fastProc = &SkipLeading8888ZerosThen
                                     <fast_swizzle_rgba_to_bgra_unpremul>;
+                            sampledProc = &SkipLeading8888ZerosThen
+                                    <sampled_swizzle_rgba_to_bgra_unpremul>;
                         } else {
                             proc = &swizzle_rgba_to_bgra_unpremul;
                             fastProc = &fast_swizzle_rgba_to_bgra_unpremul;
+                            sampledProc = &sampled_swizzle_rgba_to_bgra_unpremul;
                         }
                     }
                     break;
@@ -1056,10 +1105,12 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                 case kBGRA_8888_SkColorType:
                     proc = &swizzle_rgb_to_rgba;
                     fastProc = &fast_swizzle_rgb_to_rgba;
+                    sampledProc = &sampled_swizzle_rgb_to_rgba;
                     break;
                 case kRGBA_8888_SkColorType:
                     proc = &swizzle_rgb_to_bgra;
                     fastProc = &fast_swizzle_rgb_to_bgra;
+                    sampledProc = &sampled_swizzle_rgb_to_bgra;
                     break;
                 case kRGB_565_SkColorType:
                     proc = &swizzle_bgr_to_565;
@@ -1091,9 +1142,12 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                             proc = &SkipLeading8888ZerosThen<swizzle_rgba_to_rgba_premul>;
                             fastProc = &SkipLeading8888ZerosThen
                                     <fast_swizzle_rgba_to_rgba_premul>;
+                            sampledProc = &SkipLeading8888ZerosThen
+                                    <sampled_swizzle_rgba_to_rgba_premul>;
                         } else {
                             proc = &swizzle_rgba_to_rgba_premul;
                             fastProc = &fast_swizzle_rgba_to_rgba_premul;
+                            sampledProc = &sampled_swizzle_rgba_to_rgba_premul;
                         }
                     } else {
                         if (SkCodec::kYes_ZeroInitialized == zeroInit) {
@@ -1111,18 +1165,24 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                             proc = &SkipLeading8888ZerosThen<swizzle_rgba_to_bgra_premul>;
                             fastProc = &SkipLeading8888ZerosThen
                                     <fast_swizzle_rgba_to_bgra_premul>;
+                            sampledProc = &SkipLeading8888ZerosThen
+                                    <sampled_swizzle_rgba_to_bgra_premul>;
                         } else {
                             proc = &swizzle_rgba_to_bgra_premul;
                             fastProc = &fast_swizzle_rgba_to_bgra_premul;
+                            sampledProc = &sampled_swizzle_rgba_to_bgra_premul;
                         }
                     } else {
                         if (SkCodec::kYes_ZeroInitialized == zeroInit) {
                             proc = &SkipLeading8888ZerosThen<swizzle_rgba_to_bgra_unpremul>;
                             fastProc = &SkipLeading8888ZerosThen
                                     <fast_swizzle_rgba_to_bgra_unpremul>;
+                            sampledProc = &SkipLeading8888ZerosThen
+                                    <sampled_swizzle_rgba_to_bgra_unpremul>;
                         } else {
                             proc = &swizzle_rgba_to_bgra_unpremul;
                             fastProc = &fast_swizzle_rgba_to_bgra_unpremul;
+                            sampledProc = &sampled_swizzle_rgba_to_bgra_unpremul;
                         }
                     }
                     break;
@@ -1155,11 +1215,11 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
     uint8_t bitsPerPixel = encodedInfo.bitsPerPixel();
     int srcBPP = SkIsAlign8(bitsPerPixel) ? bitsPerPixel / 8 : bitsPerPixel;
     int dstBPP = dstInfo.bytesPerPixel();
-    return Make(dstInfo, fastProc, proc, ctable, srcBPP, dstBPP, options, frame);
+    return Make(dstInfo, fastProc, proc, sampledProc, ctable, srcBPP, dstBPP, options, frame);
 }
 
 std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkImageInfo& dstInfo,
-        RowProc fastProc, RowProc proc, const SkPMColor* ctable, int srcBPP,
+        RowProc fastProc, RowProc proc, RowProc sampledProc, const SkPMColor* ctable, int srcBPP,
         int dstBPP, const SkCodec::Options& options, const SkIRect* frame) {
     int srcOffset = 0;
     int srcWidth = dstInfo.width();
@@ -1177,14 +1237,17 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkImageInfo& dstInfo,
         srcWidth = frame->width();
     }
 
-    return std::unique_ptr<SkSwizzler>(new SkSwizzler(fastProc, proc, ctable, srcOffset, srcWidth,
-                                                      dstOffset, dstWidth, srcBPP, dstBPP));
+    return std::unique_ptr<SkSwizzler>(new SkSwizzler(fastProc, proc, sampledProc, ctable,
+                                                      srcOffset, srcWidth, dstOffset, dstWidth,
+                                                      srcBPP, dstBPP));
 }
 
-SkSwizzler::SkSwizzler(RowProc fastProc, RowProc proc, const SkPMColor* ctable, int srcOffset,
-        int srcWidth, int dstOffset, int dstWidth, int srcBPP, int dstBPP)
+SkSwizzler::SkSwizzler(RowProc fastProc, RowProc proc, RowProc sampledProc,
+        const SkPMColor* ctable, int srcOffset, int srcWidth, int dstOffset, int dstWidth,
+        int srcBPP, int dstBPP)
     : fFastProc(fastProc)
     , fSlowProc(proc)
+    , fSampledProc(sampledProc)
     , fActualProc(fFastProc ? fFastProc : fSlowProc)
     , fColorTable(ctable)
     , fSrcOffset(srcOffset)
@@ -1232,11 +1295,12 @@ int SkSwizzler::onSetSampleX(int sampleX) {
         }
     }
 
-    // The optimized swizzler functions do not support sampling.  Sampled swizzles
-    // are already fast because they skip pixels.  We haven't seen a situation
-    // where speeding up sampling has a significant impact on total decode time.
+    // The fast swizzler functions do not support sampling.  The common thumbnail
+    // sample rates have their own vectorized gather-and-swizzle functions.
     if (1 == fSampleX && fFastProc) {
         fActualProc = fFastProc;
+    } else if ((2 == fSampleX || 4 == fSampleX || 8 == fSampleX) && fSampledProc) {
+        fActualProc = fSampledProc;
     } else {
         fActualProc = fSlowProc;
     }
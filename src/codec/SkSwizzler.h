@@ -128,6 +128,8 @@ private:
     const RowProc       fFastProc;
     // Always non-NULL.  Supports sampling.
     const RowProc       fSlowProc;
+    // May be NULL.  Optimized for sampling by 2, 4 or 8.
+    const RowProc       fSampledProc;
     // The actual RowProc we are using.  This depends on if fFastProc is non-NULL and
     // whether or not we are sampling.
     RowProc             fActualProc;
@@ -218,10 +220,10 @@ private:
                                           //     fBPP is bitsPerPixel
     const int           fDstBPP;          // Bytes per pixel for the destination color type
 
-    SkSwizzler(RowProc fastProc, RowProc proc, const SkPMColor* ctable, int srcOffset,
-            int srcWidth, int dstOffset, int dstWidth, int srcBPP, int dstBPP);
+    SkSwizzler(RowProc fastProc, RowProc proc, RowProc sampledProc, const SkPMColor* ctable,
+            int srcOffset, int srcWidth, int dstOffset, int dstWidth, int srcBPP, int dstBPP);
     static std::unique_ptr<SkSwizzler> Make(const SkImageInfo& dstInfo, RowProc fastProc,
-            RowProc proc, const SkPMColor* ctable, int srcBPP, int dstBPP,
+            RowProc proc, RowProc sampledProc, const SkPMColor* ctable, int srcBPP, int dstBPP,
             const SkCodec::Options& options, const SkIRect* frame);
 
     int onSetSampleX(int) override;
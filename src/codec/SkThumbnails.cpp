@@ -0,0 +1,133 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/codec/SkThumbnails.h"
+
+#include "include/codec/SkAndroidCodec.h"
+#include "include/codec/SkCodec.h"
+#include "include/core/SkColorSpace.h"
+#include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkSamplingOptions.h"
+#include "src/base/SkAutoMalloc.h"
+#include "src/core/SkTaskGroup.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+
+namespace {
+
+// The largest size with the aspect ratio of 'size' that fits within 'maxSize'. Images are never
+// enlarged.
+SkISize fit_within(SkISize size, SkISize maxSize) {
+    if (size.width() <= maxSize.width() && size.height() <= maxSize.height()) {
+        return size;
+    }
+    double scale = std::min((double)maxSize.width() / size.width(),
+                            (double)maxSize.height() / size.height());
+    return {std::max(1, (int)std::lround(size.width() * scale)),
+            std::max(1, (int)std::lround(size.height() * scale))};
+}
+
+// 'scratch' holds the natively downscaled decode, and is reused from one image to the next.
+SkBitmap decode_thumbnail(const sk_sp<SkData>& data, SkISize maxSize, SkColorType colorType,
+                          SkAutoMalloc* scratch) {
+    std::unique_ptr<SkAndroidCodec> codec = SkAndroidCodec::MakeFromData(data);
+    if (!codec) {
+        return {};
+    }
+
+    const SkISize thumbSize = fit_within(codec->getInfo().dimensions(), maxSize);
+    SkISize decodeSize = thumbSize;
+    SkAndroidCodec::AndroidOptions options;
+    options.fSampleSize = codec->computeSampleSize(&decodeSize);
+
+    const SkImageInfo thumbInfo = SkImageInfo::Make(thumbSize, colorType,
+                                                    codec->computeOutputAlphaType(false),
+                                                    codec->computeOutputColorSpace(colorType));
+    const SkImageInfo decodeInfo = thumbInfo.makeDimensions(decodeSize);
+
+    SkBitmap thumb;
+    if (!thumb.tryAllocPixels(thumbInfo)) {
+        return {};
+    }
+
+    // When the codec can produce the thumbnail's size itself, decode straight into it.
+    SkPixmap decoded = thumb.pixmap();
+    if (decodeSize != thumbSize) {
+        const size_t bytes = decodeInfo.computeMinByteSize();
+        if (SkImageInfo::ByteSizeOverflowed(bytes)) {
+            return {};
+        }
+        decoded.reset(decodeInfo, scratch->reset(bytes, SkAutoMalloc::kReuse_OnShrink),
+                      decodeInfo.minRowBytes());
+    }
+
+    switch (codec->getAndroidPixels(decodeInfo, decoded.writable_addr(), decoded.rowBytes(),
+                                    &options)) {
+        case SkCodec::kSuccess:
+        case SkCodec::kIncompleteInput:
+        case SkCodec::kErrorInInput:
+            break;
+        default:
+            return {};
+    }
+
+    if (decodeSize != thumbSize &&
+        !decoded.scalePixels(thumb.pixmap(), SkSamplingOptions(SkCubicResampler::Mitchell()))) {
+        return {};
+    }
+    thumb.setImmutable();
+    return thumb;
+}
+
+}  // namespace
+
+namespace SkThumbnails {
+
+std::vector<SkBitmap> Decode(SkSpan<const sk_sp<SkData>> encoded,
+                             SkISize maxSize,
+                             const Options& options) {
+    std::vector<SkBitmap> thumbnails(encoded.size());
+    if (maxSize.isEmpty() || encoded.empty()) {
+        return thumbnails;
+    }
+
+    // Each worker claims images one at a time until there are none left, so no more than one
+    // decode per worker is ever in flight.
+    std::atomic<size_t> next{0};
+    auto work = [&]() {
+        SkAutoMalloc scratch;
+        for (size_t i = next++; i < encoded.size(); i = next++) {
+            if (encoded[i]) {
+                thumbnails[i] = decode_thumbnail(encoded[i], maxSize, options.fColorType,
+                                                 &scratch);
+            }
+        }
+    };
+
+    const size_t workers = std::min(encoded.size(),
+                                    (size_t)std::max(1, options.fMaxConcurrentDecodes));
+    if (!options.fExecutor) {
+        work();
+        return thumbnails;
+    }
+
+    SkTaskGroup tasks(*options.fExecutor);
+    for (size_t i = 0; i < workers; i++) {
+        tasks.add(work);
+    }
+    tasks.wait();
+    return thumbnails;
+}
+
+}  // namespace SkThumbnails
@@ -36,6 +36,7 @@
 #include "src/core/SkRasterClip.h"
 #include "src/core/SkStreamPriv.h"
 
+#include <algorithm>
 #include <climits>
 #include <cstdint>
 #include <cstring>
@@ -81,7 +82,34 @@
 #define SK_WUFFS_INITIALIZE_FLAGS WUFFS_INITIALIZE__DEFAULT_OPTIONS
 #endif
 
+// If the SkStream is backed by memory (e.g. an SkMemoryStream wrapping an mmapped
+// file), point the io_buffer directly at that memory instead of copying it into
+// an intermediate buffer. The whole stream is then visible to Wuffs at once.
+static bool make_memory_view(wuffs_base__io_buffer* b, SkStream* s) {
+    if (!s->getMemoryBase() || !s->hasPosition() || !s->hasLength()) {
+        return false;
+    }
+    // Wuffs only reads from the io_buffer. The memory is never compacted or
+    // otherwise written to, as fill_buffer and seek_buffer check is_memory_view.
+    uint8_t* base = const_cast<uint8_t*>(static_cast<const uint8_t*>(s->getMemoryBase()));
+    *b = wuffs_base__make_io_buffer(wuffs_base__make_slice_u8(base, s->getLength()),
+                                    wuffs_base__empty_io_buffer_meta());
+    b->meta.wi = s->getLength();
+    b->meta.ri = std::min(s->getPosition(), s->getLength());
+    // See fill_buffer for why this is not set to true.
+    b->meta.closed = false;
+    return true;
+}
+
+static bool is_memory_view(const wuffs_base__io_buffer* b, SkStream* s) {
+    return b->data.ptr == s->getMemoryBase();
+}
+
 static bool fill_buffer(wuffs_base__io_buffer* b, SkStream* s) {
+    if (is_memory_view(b, s)) {
+        // All of the stream's bytes are already in the io_buffer.
+        return false;
+    }
     b->compact();
     size_t num_read = s->read(b->data.ptr + b->meta.wi, b->data.len - b->meta.wi);
     b->meta.wi += num_read;
@@ -117,6 +145,9 @@ static bool seek_buffer(wuffs_base__io_buffer* b, SkStream* s, uint64_t pos) {
         b->meta.ri = pos - b->meta.pos;
         return true;
     }
+    if (is_memory_view(b, s)) {
+        return false;
+    }
     // Seek in the backing SkStream.
     if ((pos > SIZE_MAX) || (!s->seek(pos))) {
         return false;
@@ -412,6 +443,12 @@ SkWuffsCodec::SkWuffsCodec(SkEncodedInfo&&
       fCanSeek(canSeek) {
     fFrameHolder.init(this, imgcfg.pixcfg.width(), imgcfg.pixcfg.height());
 
+    // A view of the stream's memory stays valid for as long as fStream does.
+    if (is_memory_view(&iobuf, fStream.get())) {
+        fIOBuffer = iobuf;
+        return;
+    }
+
     // Initialize fIOBuffer's fields, copying any outstanding data from iobuf to
     // fIOBuffer, as iobuf's backing array may not be valid for the lifetime of
     // this SkWuffsCodec object, but fIOBuffer's backing array (fBuffer) is.
@@ -910,7 +947,9 @@ SkCodec::Result SkWuffsCodec::resetDecoder() {
     if (!fStream->rewind()) {
         return SkCodec::kInternalError;
     }
-    fIOBuffer.meta = wuffs_base__empty_io_buffer_meta();
+    if (!make_memory_view(&fIOBuffer, fStream.get())) {
+        fIOBuffer.meta = wuffs_base__empty_io_buffer_meta();
+    }
 
     SkCodec::Result result =
         reset_and_decode_image_config(fDecoder.get(), nullptr, &fIOBuffer, fStream.get());
@@ -993,9 +1032,12 @@ std::unique_ptr<SkCodec> MakeFromStream(std::unique_ptr<SkStream> stream,
     }
 
     uint8_t               buffer[SK_WUFFS_CODEC_BUFFER_SIZE];
-    wuffs_base__io_buffer iobuf =
-        wuffs_base__make_io_buffer(wuffs_base__make_slice_u8(buffer, SK_WUFFS_CODEC_BUFFER_SIZE),
-                                   wuffs_base__empty_io_buffer_meta());
+    wuffs_base__io_buffer iobuf;
+    if (!make_memory_view(&iobuf, stream.get())) {
+        iobuf = wuffs_base__make_io_buffer(
+                wuffs_base__make_slice_u8(buffer, SK_WUFFS_CODEC_BUFFER_SIZE),
+                wuffs_base__empty_io_buffer_meta());
+    }
     wuffs_base__image_config imgcfg = wuffs_base__null_image_config();
 
     // Wuffs is primarily a C library, not a C++ one. Furthermore, outside of
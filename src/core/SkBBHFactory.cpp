@@ -8,13 +8,31 @@
 #include "include/core/SkBBHFactory.h"
 
 #include "include/core/SkRect.h"
+#include "src/core/SkPackedRTree.h"
 #include "src/core/SkRTree.h"
 
+#include <algorithm>
+#include <vector>
+
 sk_sp<SkBBoxHierarchy> SkRTreeFactory::operator()() const {
     return sk_make_sp<SkRTree>();
 }
 
-void SkBBoxHierarchy::insert(const SkRect rects[], const Metadata[], int N) {
-    // Ignore Metadata.
-    this->insert(rects, N);
+sk_sp<SkBBoxHierarchy> SkPackedRTreeFactory::operator()() const {
+    return sk_make_sp<SkPackedRTree>();
+}
+
+void SkBBoxHierarchy::insert(const SkRect rects[], const Metadata metadata[], int N) {
+    if (std::none_of(metadata, metadata + N, [](const Metadata& m) { return m.isOccluded; })) {
+        this->insert(rects, N);
+        return;
+    }
+    // Searches never return empty bounding boxes, so playback skips occluded draws.
+    std::vector<SkRect> visible(rects, rects + N);
+    for (int i = 0; i < N; i++) {
+        if (metadata[i].isOccluded) {
+            visible[i].setEmpty();
+        }
+    }
+    this->insert(visible.data(), N);
 }
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkDecodedImageCache.h"
+
+#include "include/core/SkData.h"
+#include "include/core/SkString.h"
+#include "src/core/SkMD5.h"
+#include "src/core/SkOSFile.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+
+namespace {
+
+// Distinguishes this process's temporary files from those of other processes sharing the directory.
+uint64_t process_nonce() {
+    static const uint64_t nonce = [] {
+        std::random_device rd;
+        return (uint64_t)rd() << 32 | rd();
+    }();
+    return nonce;
+}
+
+class FileDecodedImageCache final : public SkDecodedImageCache {
+public:
+    explicit FileDecodedImageCache(const char dir[]) : fDir(dir) {}
+
+    sk_sp<SkData> load(const SkData& key) override {
+        // MakeFromFileName() maps the file rather than reading it.
+        return SkData::MakeFromFileName(this->pathFor(key).c_str());
+    }
+
+    void store(const SkData& key, const SkData& data) override {
+        SkString path = this->pathFor(key);
+        if (sk_exists(path.c_str())) {
+            return;
+        }
+
+        // Write to a temporary file and rename it into place, so that load() never maps a
+        // partially written entry. Every writer, in any process, gets its own temporary file.
+        // Keys are content hashes, so whichever rename wins puts the same bytes in place.
+        SkString tmpPath = SkStringPrintf("%s.%016llx.%u.tmp", path.c_str(),
+                                          (unsigned long long)process_nonce(),
+                                          fNextTmp.fetch_add(1, std::memory_order_relaxed));
+        FILE* f = sk_fopen(tmpPath.c_str(), kWrite_SkFILE_Flag);
+        if (!f) {
+            return;
+        }
+        bool ok = sk_fwrite(data.data(), data.size(), f) == data.size();
+        sk_fclose(f);
+        if (!ok || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+            std::remove(tmpPath.c_str());
+        }
+    }
+
+private:
+    SkString pathFor(const SkData& key) const {
+        SkMD5 md5;
+        md5.write(key.data(), key.size());
+        return SkStringPrintf("%s/%s.skpx", fDir.c_str(), md5.finish().toHexString().c_str());
+    }
+
+    const SkString fDir;
+    std::atomic<uint32_t> fNextTmp{0};
+};
+
+}  // namespace
+
+sk_sp<SkDecodedImageCache> SkDecodedImageCache::MakeFileCache(const char dir[]) {
+    if (!dir || !sk_isdir(dir)) {
+        return nullptr;
+    }
+    return sk_make_sp<FileDecodedImageCache>(dir);
+}
@@ -7,6 +7,8 @@
 
 #include "include/core/SkGraphics.h"
 
+#include "include/core/SkDecodedImageCache.h"
+#include "include/private/base/SkMutex.h"
 #include "src/core/SkBitmapProcState.h"
 #include "src/core/SkBlitMask.h"
 #include "src/core/SkBlitRow.h"
@@ -102,3 +104,21 @@ SkGraphics::SetOpenTypeSVGDecoderFactory(OpenTypeSVGDecoderFactory svgDecoderFac
 SkGraphics::OpenTypeSVGDecoderFactory SkGraphics::GetOpenTypeSVGDecoderFactory() {
     return gSVGDecoderFactory;
 }
+
+static SkMutex& decoded_image_cache_mutex() {
+    static SkMutex& mutex = *(new SkMutex);
+    return mutex;
+}
+static SkDecodedImageCache* gDecodedImageCache = nullptr;  // Owned; guarded by the mutex.
+
+sk_sp<SkDecodedImageCache> SkGraphics::SetDecodedImageCache(sk_sp<SkDecodedImageCache> cache) {
+    SkAutoMutexExclusive lock(decoded_image_cache_mutex());
+    sk_sp<SkDecodedImageCache> old(gDecodedImageCache);
+    gDecodedImageCache = cache.release();
+    return old;
+}
+
+sk_sp<SkDecodedImageCache> SkGraphics::GetDecodedImageCache() {
+    SkAutoMutexExclusive lock(decoded_image_cache_mutex());
+    return sk_ref_sp(gDecodedImageCache);
+}
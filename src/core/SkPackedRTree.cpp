@@ -0,0 +1,173 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkPackedRTree.h"
+
+#include "include/private/base/SkAssert.h"
+#include "src/base/SkVx.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+// The distance along a Hilbert curve filling a 2^16 x 2^16 grid of the point (x,y).
+static uint32_t hilbert_distance(uint32_t x, uint32_t y) {
+    constexpr uint32_t kSize = 1 << 16;
+    uint32_t d = 0;
+    for (uint32_t s = kSize / 2; s > 0; s /= 2) {
+        const uint32_t rx = (x & s) ? 1 : 0,
+                       ry = (y & s) ? 1 : 0;
+        d += s * s * ((3 * rx) ^ ry);
+        // Rotate the quadrant, so the curve within it starts and ends in the right corners.
+        if (ry == 0) {
+            if (rx == 1) {
+                x = kSize - 1 - x;
+                y = kSize - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+void SkPackedRTree::insert(const SkRect boundsArray[], int N) {
+    SkASSERT(0 == fCount);
+
+    SkRect total = SkRect::MakeEmpty();
+    std::vector<int> ops;
+    ops.reserve(N);
+    for (int i = 0; i < N; i++) {
+        if (!boundsArray[i].isEmpty()) {
+            ops.push_back(i);
+            total.join(boundsArray[i]);
+        }
+    }
+    fCount = (int)ops.size();
+    if (!fCount) {
+        return;
+    }
+
+    // Sort the rects by the Hilbert distance of their centers, scaled to fill the grid.
+    std::vector<std::pair<uint32_t, int>> sorted;
+    sorted.reserve(fCount);
+    const float scaleX = total.width()  > 0 ? 65535 / total.width()  : 0,
+                scaleY = total.height() > 0 ? 65535 / total.height() : 0;
+    for (int op : ops) {
+        const SkRect& r = boundsArray[op];
+        const float x = std::clamp((r.centerX() - total.fLeft) * scaleX, 0.0f, 65535.0f),
+                    y = std::clamp((r.centerY() - total.fTop ) * scaleY, 0.0f, 65535.0f);
+        sorted.push_back({hilbert_distance((uint32_t)x, (uint32_t)y), op});
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    // Count the nodes of each level.
+    int nodes = 0;
+    for (int levelNodes = (fCount + kChildren - 1) / kChildren; ;
+             levelNodes = (levelNodes + kChildren - 1) / kChildren) {
+        fLevels.push_back(nodes);
+        nodes += levelNodes;
+        if (levelNodes == 1) {
+            break;
+        }
+    }
+    SkASSERT((int)fLevels.size() <= kMaxDepth);
+    fLevels.push_back(nodes);  // The end of the last level, temporarily.
+
+    // Empty slots can't intersect anything.
+    constexpr float kInf = std::numeric_limits<float>::infinity();
+    Node empty;
+    std::fill_n(empty.fLeft,   kChildren,  kInf);
+    std::fill_n(empty.fTop,    kChildren,  kInf);
+    std::fill_n(empty.fRight,  kChildren, -kInf);
+    std::fill_n(empty.fBottom, kChildren, -kInf);
+    fNodes.assign(nodes, empty);
+
+    fOpIndices.assign((size_t)(fLevels[1] - fLevels[0]) * kChildren, -1);
+    for (int i = 0; i < fCount; i++) {
+        const int op = sorted[i].second;
+        const SkRect& r = boundsArray[op];
+        Node& leaf = fNodes[i / kChildren];
+        const int slot = i % kChildren;
+        leaf.fLeft  [slot] = r.fLeft;
+        leaf.fTop   [slot] = r.fTop;
+        leaf.fRight [slot] = r.fRight;
+        leaf.fBottom[slot] = r.fBottom;
+        fOpIndices[i] = op;
+    }
+
+    // Each node's slot in its parent holds the union of the node's slots.
+    for (size_t level = 1; level + 1 < fLevels.size(); level++) {
+        for (int child = fLevels[level - 1]; child < fLevels[level]; child++) {
+            const int index = child - fLevels[level - 1];
+            Node& parent = fNodes[fLevels[level] + index / kChildren];
+            const int slot = index % kChildren;
+            const Node& node = fNodes[child];
+            parent.fLeft  [slot] = *std::min_element(node.fLeft,   node.fLeft   + kChildren);
+            parent.fTop   [slot] = *std::min_element(node.fTop,    node.fTop    + kChildren);
+            parent.fRight [slot] = *std::max_element(node.fRight,  node.fRight  + kChildren);
+            parent.fBottom[slot] = *std::max_element(node.fBottom, node.fBottom + kChildren);
+        }
+    }
+    fLevels.pop_back();
+}
+
+void SkPackedRTree::search(const SkRect& query, std::vector<int>* results) const {
+    // Matches SkRect::Intersects(), which is false for empty rects.
+    if (!fCount || !(query.fLeft < query.fRight && query.fTop < query.fBottom)) {
+        return;
+    }
+    const size_t firstResult = results->size();
+
+    const skvx::float8 queryL(query.fLeft),
+                       queryT(query.fTop),
+                       queryR(query.fRight),
+                       queryB(query.fBottom);
+
+    // Each node popped pushes at most kChildren more, so this never holds more than
+    // (kChildren - 1) nodes per level, plus one.
+    struct Entry {
+        int fLevel;
+        int fIndex;  // Within the level.
+    };
+    Entry stack[(kChildren - 1) * kMaxDepth + 1];
+    int depth = 0;
+    stack[depth++] = {(int)fLevels.size() - 1, 0};
+
+    while (depth > 0) {
+        const Entry entry = stack[--depth];
+        const Node& node = fNodes[fLevels[entry.fLevel] + entry.fIndex];
+        const auto hit = (skvx::float8::Load(node.fLeft)  < queryR) &
+                         (skvx::float8::Load(node.fTop)   < queryB) &
+                         (queryL < skvx::float8::Load(node.fRight)) &
+                         (queryT < skvx::float8::Load(node.fBottom));
+        if (!skvx::any(hit)) {
+            continue;
+        }
+        const int firstChild = entry.fIndex * kChildren;
+        for (int i = 0; i < kChildren; i++) {
+            if (!hit[i]) {
+                continue;
+            }
+            if (entry.fLevel == 0) {
+                results->push_back(fOpIndices[firstChild + i]);
+            } else {
+                stack[depth++] = {entry.fLevel - 1, firstChild + i};
+            }
+        }
+    }
+
+    // Callers draw the results in order.
+    std::sort(results->begin() + firstResult, results->end());
+}
+
+size_t SkPackedRTree::bytesUsed() const {
+    return sizeof(SkPackedRTree) +
+           fLevels.capacity()    * sizeof(int) +
+           fNodes.capacity()     * sizeof(Node) +
+           fOpIndices.capacity() * sizeof(int);
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPackedRTree_DEFINED
+#define SkPackedRTree_DEFINED
+
+#include "include/core/SkBBHFactory.h"
+#include "include/core/SkRect.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * A static, packed R-Tree. Like SkRTree, it only supports bulk-loading.
+ *
+ * The bounding rectangles are sorted along a Hilbert curve through their centers, and then packed
+ * bottom-up into nodes of exactly kChildren (the last node of each level is padded with empty
+ * slots). Node i of one level is the parent of nodes i*kChildren ... i*kChildren + kChildren-1 of
+ * the level below, so nodes need no child pointers. Each node stores its children's bounds as
+ * four arrays (lefts, tops, rights, bottoms), so that a query is tested against all of a node's
+ * children at once with SIMD.
+ *
+ * Building it costs a sort that SkRTree skips, but the tighter nodes make queries faster,
+ * especially when the rectangles were not recorded in a spatially coherent order.
+ *
+ * For more details see:
+ *
+ *  Kamel, I.; Faloutsos, C. (1993). "On Packing R-trees"
+ */
+class SkPackedRTree : public SkBBoxHierarchy {
+public:
+    SkPackedRTree() = default;
+
+    void insert(const SkRect[], int N) override;
+    // Results are in increasing order, like SkRTree's.
+    void search(const SkRect& query, std::vector<int>* results) const override;
+    size_t bytesUsed() const override;
+
+    // Methods and constants below here are only public for tests.
+
+    // Return the depth of the tree structure.
+    int getDepth() const { return (int)fLevels.size(); }
+    // Insertion count (not overall node count, which may be greater).
+    int getCount() const { return fCount; }
+
+    static constexpr int kChildren = 8;
+    // kChildren^kMaxDepth exceeds the largest possible insertion count.
+    static constexpr int kMaxDepth = 11;
+
+private:
+    struct Node {
+        float fLeft  [kChildren],
+              fTop   [kChildren],
+              fRight [kChildren],
+              fBottom[kChildren];
+    };
+
+    // The index of each level's first node in fNodes. The leaves (level 0) come first, and the
+    // root is the last node.
+    std::vector<int> fLevels;
+    std::vector<Node> fNodes;
+    // The op index of each slot in the leaves, or -1 for padding.
+    std::vector<int> fOpIndices;
+
+    int fCount = 0;
+};
+
+#endif
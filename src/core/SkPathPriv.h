@@ -25,6 +25,7 @@
 #include <iterator>
 #include <utility>
 
+class SkData;
 class SkMatrix;
 class SkRRect;
 
@@ -422,6 +423,14 @@ public:
         builder->privateReverseAddPath(reverseMe);
     }
 
+    /**
+     * Like SkPath::serialize(), but if precisionBits is positive, encodes general paths (not
+     * those for which isRect(), isOval() or isRRect() is true) with each coordinate rounded to a
+     * multiple of 1/2^precisionBits (at most 24), as varint deltas, when that makes them smaller.
+     * The size is a multiple of 4. SkPath::readFromMemory() reads either encoding.
+     */
+    static sk_sp<SkData> Serialize(const SkPath&, int precisionBits);
+
     static SkPath MakePath(const SkPathVerbAnalysis& analysis,
                            const SkPoint points[],
                            const uint8_t verbs[],
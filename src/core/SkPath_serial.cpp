@@ -15,6 +15,7 @@
 #include "include/private/SkPathRef.h"
 #include "include/private/base/SkAssert.h"
 #include "include/private/base/SkDebug.h"
+#include "include/private/base/SkFloatBits.h"
 #include "include/private/base/SkPoint_impl.h"
 #include "include/private/base/SkTPin.h"
 #include "include/private/base/SkTo.h"
@@ -25,8 +26,12 @@
 #include "src/core/SkPathPriv.h"
 #include "src/core/SkRRectPriv.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <limits>
+#include <vector>
 
 enum SerializationOffsets {
     kType_SerializationShift = 28,       // requires 4 bits
@@ -49,7 +54,8 @@ enum SerializationVersions {
 
 enum SerializationType {
     kGeneral = 0,
-    kRRect = 1
+    kRRect = 1,
+    kQuantized = 2,
 };
 
 static unsigned extract_version(uint32_t packed) {
@@ -64,6 +70,233 @@ static SerializationType extract_serializationtype(uint32_t packed) {
     return static_cast<SerializationType>((packed >> kType_SerializationShift) & 0xF);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// The quantized encoding of a general path, after the packed header, is a sequence of varints:
+//
+//   precision bits, verb count, point count, conic weight count
+//   verb runs:      (run length - 1) << 3 | verb
+//   points:         zigzagged differences from the previous point's x and y, each rounded to a
+//                   multiple of 1/2^precision
+//   conic weights:  little-endian floats (not varints)
+//
+// padded to a multiple of 4 bytes.
+
+static constexpr int kMaxPrecisionBits = 24;
+
+static void write_varint(std::vector<uint8_t>* dst, uint64_t value) {
+    while (value >= 0x80) {
+        dst->push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    dst->push_back((uint8_t)value);
+}
+
+static uint64_t zigzag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t unzigzag(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+namespace {
+class VarintReader {
+public:
+    VarintReader(const uint8_t* data, size_t length) : fCurr(data), fStop(data + length) {}
+
+    uint64_t read() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64 && fCurr < fStop; shift += 7) {
+            const uint8_t byte = *fCurr++;
+            value |= (uint64_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        fValid = false;
+        return 0;
+    }
+
+    const uint8_t* skip(size_t bytes) {
+        if (!fValid || (size_t)(fStop - fCurr) < bytes) {
+            fValid = false;
+            return nullptr;
+        }
+        const uint8_t* data = fCurr;
+        fCurr += bytes;
+        return data;
+    }
+
+    size_t available() const { return fStop - fCurr; }
+    const uint8_t* pos() const { return fCurr; }
+    bool isValid() const { return fValid; }
+
+private:
+    const uint8_t* fCurr;
+    const uint8_t* fStop;
+    bool fValid = true;
+};
+}  // namespace
+
+// Returns false if the path can't be quantized (e.g. it has coordinates that are too large).
+static bool encode_quantized(const SkPath& path, int precisionBits, std::vector<uint8_t>* dst) {
+    const int pts = path.countPoints(),
+              cnx = SkPathPriv::ConicWeightCnt(path),
+              vbs = path.countVerbs();
+    // Closes never repeat, so readers can bound the verb count by the point count.
+    if (vbs > 2 * pts) {
+        return false;
+    }
+    write_varint(dst, precisionBits);
+    write_varint(dst, vbs);
+    write_varint(dst, pts);
+    write_varint(dst, cnx);
+
+    const uint8_t* verbs = SkPathPriv::VerbData(path);
+    for (int i = 0; i < vbs;) {
+        int run = 1;
+        while (i + run < vbs && verbs[i + run] == verbs[i]) {
+            run++;
+        }
+        write_varint(dst, (uint64_t)(run - 1) << 3 | verbs[i]);
+        i += run;
+    }
+
+    const double scale = 1 << precisionBits;
+    const SkPoint* points = SkPathPriv::PointData(path);
+    int64_t prev[2] = {0, 0};
+    for (int i = 0; i < pts; i++) {
+        const float coords[2] = {points[i].fX, points[i].fY};
+        for (int c = 0; c < 2; c++) {
+            const double q = std::round(coords[c] * scale);
+            // Also false for NaN.
+            if (!(std::abs(q) <= std::numeric_limits<int32_t>::max())) {
+                return false;
+            }
+            write_varint(dst, zigzag((int64_t)q - prev[c]));
+            prev[c] = (int64_t)q;
+        }
+    }
+
+    const SkScalar* weights = SkPathPriv::ConicWeightData(path);
+    for (int i = 0; i < cnx; i++) {
+        const uint32_t bits = (uint32_t)SkFloat2Bits(weights[i]);
+        for (int shift = 0; shift < 32; shift += 8) {
+            dst->push_back((uint8_t)(bits >> shift));
+        }
+    }
+    return true;
+}
+
+static size_t read_quantized(const void* storage, size_t length, SkPath* path) {
+    SkRBuffer buffer(storage, length);
+    uint32_t packed;
+    if (!buffer.readU32(&packed)) {
+        return 0;
+    }
+    VarintReader reader((const uint8_t*)storage + buffer.pos(), length - buffer.pos());
+    const uint64_t precisionBits = reader.read(),
+                   vbs = reader.read(),
+                   pts = reader.read(),
+                   cnx = reader.read();
+    // Every point takes at least two bytes, and every weight four.
+    if (!reader.isValid() || precisionBits < 1 || precisionBits > kMaxPrecisionBits ||
+        pts > reader.available() / 2 || cnx > reader.available() / 4 || vbs > 2 * pts ||
+        vbs > (uint64_t)std::numeric_limits<int>::max()) {
+        return 0;
+    }
+
+    std::vector<uint8_t> verbs(vbs);
+    for (uint64_t i = 0; i < vbs;) {
+        const uint64_t packedRun = reader.read(),
+                       run = (packedRun >> 3) + 1;
+        if (!reader.isValid() || run > vbs - i) {
+            return 0;
+        }
+        std::fill_n(verbs.begin() + i, run, (uint8_t)(packedRun & 0x7));
+        i += run;
+    }
+
+    const double scale = 1 << precisionBits;
+    std::vector<SkPoint> points(pts);
+    int64_t prev[2] = {0, 0};
+    for (SkPoint& p : points) {
+        float coords[2];
+        for (int c = 0; c < 2; c++) {
+            // Wraps (rather than overflowing) on bad data, which the range check rejects.
+            prev[c] = (int64_t)((uint64_t)prev[c] + (uint64_t)unzigzag(reader.read()));
+            if (prev[c] < -std::numeric_limits<int32_t>::max() ||
+                prev[c] >  std::numeric_limits<int32_t>::max()) {
+                return 0;
+            }
+            coords[c] = (float)(prev[c] / scale);
+        }
+        p = {coords[0], coords[1]};
+    }
+
+    std::vector<SkScalar> weights(cnx);
+    for (SkScalar& w : weights) {
+        const uint8_t* bytes = reader.skip(4);
+        if (!bytes) {
+            return 0;
+        }
+        w = SkBits2Float((int32_t)(bytes[0] | bytes[1] << 8 | bytes[2] << 16 |
+                                   (uint32_t)bytes[3] << 24));
+    }
+    if (!reader.isValid()) {
+        return 0;
+    }
+    const size_t size = SkAlign4(reader.pos() - (const uint8_t*)storage);
+    if (size > length) {
+        return 0;
+    }
+
+    if (vbs == 0) {
+        if (pts == 0 && cnx == 0) {
+            path->reset();
+            path->setFillType(extract_filltype(packed));
+            return size;
+        }
+        return 0;
+    }
+    SkPathVerbAnalysis analysis = sk_path_analyze_verbs(verbs.data(), (int)vbs);
+    if (!analysis.valid || analysis.points != (int)pts || analysis.weights != (int)cnx) {
+        return 0;
+    }
+    *path = SkPathPriv::MakePath(analysis, points.data(), verbs.data(), (int)vbs, weights.data(),
+                                 extract_filltype(packed), false);
+    return size;
+}
+
+sk_sp<SkData> SkPathPriv::Serialize(const SkPath& path, int precisionBits) {
+    // Rects are usually meant to land on exact pixel boundaries. (Ovals and round rects are
+    // written as such by writeToMemory().)
+    if (precisionBits <= 0 || path.isRect(nullptr) || path.writeToMemoryAsRRect(nullptr)) {
+        return path.serialize();
+    }
+
+    std::vector<uint8_t> encoded;
+    if (!encode_quantized(path, std::min(precisionBits, kMaxPrecisionBits), &encoded)) {
+        return path.serialize();
+    }
+    const size_t size = SkAlign4(sizeof(int32_t) + encoded.size());
+    // Tiny paths may not get any smaller.
+    if (size >= path.writeToMemory(nullptr)) {
+        return path.serialize();
+    }
+
+    int32_t packed = ((int)path.getFillType() << kFillType_SerializationShift) |
+                     (SerializationType::kQuantized << kType_SerializationShift) |
+                     kCurrent_Version;
+    sk_sp<SkData> data = SkData::MakeUninitialized(size);
+    SkWBuffer buffer(data->writable_data(), size);
+    buffer.write32(packed);
+    buffer.write(encoded.data(), encoded.size());
+    buffer.padToAlign4();
+    SkASSERT(buffer.pos() == size);
+    return data;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
 size_t SkPath::writeToMemoryAsRRect(void* storage) const {
@@ -222,6 +455,8 @@ size_t SkPath::readFromMemory_EQ4Or5(const void* storage, size_t length) {
     switch (extract_serializationtype(packed)) {
         case SerializationType::kRRect:
             return this->readAsRRect(storage, length);
+        case SerializationType::kQuantized:
+            return read_quantized(storage, length, this);
         case SerializationType::kGeneral:
             break;  // fall out
         default:
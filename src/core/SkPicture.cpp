@@ -19,6 +19,7 @@
 #include "src/core/SkPicturePlayback.h"
 #include "src/core/SkPicturePriv.h"
 #include "src/core/SkPictureRecord.h"
+#include "src/core/SkPlaybackPicture.h"
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkResourceCache.h"
 #include "src/core/SkStreamPriv.h"
@@ -165,8 +166,18 @@ sk_sp<SkPicture> SkPicture::MakeFromData(const SkData* data, const SkDeserialPro
     return MakeFromStreamPriv(&stream, procs, nullptr, kNestedSKPLimit);
 }
 
+sk_sp<SkPicture> SkPicture::MakeFromDataInPlace(sk_sp<SkData> data,
+                                                const SkDeserialProcs* procs) {
+    if (!data) {
+        return nullptr;
+    }
+    SkMemoryStream stream(data);
+    return MakeFromStreamPriv(&stream, procs, nullptr, kNestedSKPLimit, data);
+}
+
 sk_sp<SkPicture> SkPicture::MakeFromStreamPriv(SkStream* stream, const SkDeserialProcs* procsPtr,
-                                               SkTypefacePlayback* typefaces, int recursionLimit) {
+                                               SkTypefacePlayback* typefaces, int recursionLimit,
+                                               const sk_sp<SkData>& inPlace) {
     if (recursionLimit <= 0) {
         return nullptr;
     }
@@ -186,7 +197,10 @@ sk_sp<SkPicture> SkPicture::MakeFromStreamPriv(SkStream* stream, const SkDeseria
         case kPictureData_TrailingStreamByteAfterPictInfo: {
             std::unique_ptr<SkPictureData> data(
                     SkPictureData::CreateFromStream(stream, info, procs, typefaces,
-                                                    recursionLimit));
+                                                    recursionLimit, inPlace));
+            if (inPlace) {
+                return SkPlaybackPicture::Make(std::move(data));
+            }
             return Forwardport(info, data.get(), nullptr);
         }
         case kCustom_TrailingStreamByteAfterPictInfo: {
@@ -7,17 +7,19 @@
 
 #include "src/core/SkPictureData.h"
 
+#include "include/core/SkData.h"
 #include "include/core/SkFlattenable.h"
 #include "include/core/SkFontMgr.h"
 #include "include/core/SkSerialProcs.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkString.h"
 #include "include/core/SkTypeface.h"
+#include "include/private/base/SkAlign.h"
 #include "include/private/base/SkDebug.h"
 #include "include/private/base/SkTFitsIn.h"
 #include "include/private/base/SkTemplates.h"
 #include "include/private/base/SkTo.h"
-#include "src/base/SkAutoMalloc.h"
+#include "src/core/SkPathPriv.h"
 #include "src/core/SkPicturePriv.h"
 #include "src/core/SkPictureRecord.h"
 #include "src/core/SkPtrRecorder.h"
@@ -101,6 +103,16 @@ static void write_tag_size(SkWStream* stream, uint32_t tag, size_t size) {
     stream->write32(SkToU32(size));
 }
 
+// Pads the stream so that the data of the next tag starts 4-byte aligned, so that it can be read
+// in place from memory holding the whole stream.
+static void write_padding(SkWStream* stream) {
+    if (size_t padding = (4 - stream->bytesWritten() % 4) % 4) {
+        static constexpr uint8_t kZeros[3] = {0, 0, 0};
+        write_tag_size(stream, SK_PICT_PADDING_TAG, padding);
+        stream->write(kZeros, padding);
+    }
+}
+
 void SkPictureData::WriteFactories(SkWStream* stream, const SkFactorySet& rec) {
     int count = rec.count();
 
@@ -158,6 +170,15 @@ void SkPictureData::WriteTypefaces(SkWStream* stream, const SkRefCntSet& rec,
 
 void SkPictureData::flattenToBuffer(SkWriteBuffer& buffer, bool textBlobsOnly) const {
     if (!textBlobsOnly) {
+        // Images come first, so that readers decoding them concurrently (see
+        // SkDeserialProcs::fExecutor) can start before reading everything else.
+        if (!fImages.empty()) {
+            write_tag_size(buffer, SK_PICT_IMAGE_BUFFER_TAG, fImages.size());
+            for (const auto& img : fImages) {
+                buffer.writeImage(img.get());
+            }
+        }
+
         int numPaints = fPaints.size();
         if (numPaints > 0) {
             write_tag_size(buffer, SK_PICT_PAINT_BUFFER_TAG, numPaints);
@@ -170,8 +191,13 @@ void SkPictureData::flattenToBuffer(SkWriteBuffer& buffer, bool textBlobsOnly) c
         if (numPaths > 0) {
             write_tag_size(buffer, SK_PICT_PATH_BUFFER_TAG, numPaths);
             buffer.writeInt(numPaths);
+            const int precisionBits = buffer.serialProcs().fPathPrecisionBits;
             for (const SkPath& path : fPaths) {
-                buffer.writePath(path);
+                // Encoded once, for both the size and the bytes. The size lets readers find each
+                // path without parsing the ones before it.
+                sk_sp<SkData> data = SkPathPriv::Serialize(path, precisionBits);
+                buffer.writeUInt(SkToU32(data->size()));
+                buffer.writePad32(data->data(), data->size());
             }
         }
     }
@@ -197,13 +223,6 @@ void SkPictureData::flattenToBuffer(SkWriteBuffer& buffer, bool textBlobsOnly) c
                 vert->priv().encode(buffer);
             }
         }
-
-        if (!fImages.empty()) {
-            write_tag_size(buffer, SK_PICT_IMAGE_BUFFER_TAG, fImages.size());
-            for (const auto& img : fImages) {
-                buffer.writeImage(img.get());
-            }
-        }
     }
 }
 
@@ -227,6 +246,7 @@ static SkSerialProcs skip_typeface_proc(const SkSerialProcs& procs) {
 void SkPictureData::serialize(SkWStream* stream, const SkSerialProcs& procs,
                               SkRefCntSet* topLevelTypeFaceSet, bool textBlobsOnly) const {
     // This can happen at pretty much any time, so might as well do it first.
+    write_padding(stream);
     write_tag_size(stream, SK_PICT_READER_TAG, fOpData->size());
     stream->write(fOpData->bytes(), fOpData->size());
 
@@ -264,6 +284,7 @@ void SkPictureData::serialize(SkWStream* stream, const SkSerialProcs& procs,
     WriteTypefaces(stream, *typefaceSet, procs);
 
     // Write the buffer.
+    write_padding(stream);
     write_tag_size(stream, SK_PICT_BUFFER_SIZE_TAG, buffer.bytesWritten());
     buffer.writeToStream(stream);
 
@@ -303,16 +324,38 @@ void SkPictureData::flatten(SkWriteBuffer& buffer) const {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Returns the next 'size' bytes of the stream. They are a subset of 'backing', rather than a
+// copy, if the stream is reading 'backing' and the bytes are 4-byte aligned there.
+static sk_sp<SkData> read_in_place(SkStream* stream, size_t size, const sk_sp<SkData>& backing) {
+    if (backing && stream->getMemoryBase() == backing->data() && stream->hasPosition()) {
+        const size_t offset = stream->getPosition();
+        if (SkIsAlign4(reinterpret_cast<uintptr_t>(backing->bytes() + offset)) &&
+            offset <= backing->size() && size <= backing->size() - offset) {
+            if (!stream->skip(size)) {
+                return nullptr;
+            }
+            return SkData::MakeSubset(backing.get(), offset, size);
+        }
+    }
+    return SkData::MakeFromStream(stream, size);
+}
+
 bool SkPictureData::parseStreamTag(SkStream* stream,
                                    uint32_t tag,
                                    uint32_t size,
                                    const SkDeserialProcs& procs,
                                    SkTypefacePlayback* topLevelTFPlayback,
-                                   int recursionLimit) {
+                                   int recursionLimit,
+                                   const sk_sp<SkData>& backing) {
     switch (tag) {
+        case SK_PICT_PADDING_TAG:
+            if (size > 3 || stream->skip(size) != size) {
+                return false;
+            }
+            break;
         case SK_PICT_READER_TAG:
             SkASSERT(nullptr == fOpData);
-            fOpData = SkData::MakeFromStream(stream, size);
+            fOpData = read_in_place(stream, size, backing);
             if (!fOpData) {
                 return false;
             }
@@ -369,8 +412,8 @@ bool SkPictureData::parseStreamTag(SkStream* stream,
             fPictures.reserve_exact(SkToInt(size));
 
             for (uint32_t i = 0; i < size; i++) {
-                auto pic = SkPicture::MakeFromStreamPriv(stream, &procs,
-                                                         topLevelTFPlayback, recursionLimit - 1);
+                auto pic = SkPicture::MakeFromStreamPriv(stream, &procs, topLevelTFPlayback,
+                                                         recursionLimit - 1, backing);
                 if (!pic) {
                     return false;
                 }
@@ -381,12 +424,17 @@ bool SkPictureData::parseStreamTag(SkStream* stream,
             if (StreamRemainingLengthIsBelow(stream, size)) {
                 return false;
             }
-            SkAutoMalloc storage(size);
-            if (stream->read(storage.get(), size) != size) {
+            sk_sp<SkData> data = read_in_place(stream, size, backing);
+            if (!data) {
                 return false;
             }
+            if (backing) {
+                // Paths of a picture read in place are parsed from this buffer as they are used,
+                // so it is kept until then.
+                fArrayData = data;
+            }
 
-            SkReadBuffer buffer(storage.get(), size);
+            SkReadBuffer buffer(data->data(), size);
             buffer.setVersion(fInfo.getVersion());
 
             if (!fFactoryPlayback) {
@@ -408,6 +456,9 @@ bool SkPictureData::parseStreamTag(SkStream* stream,
                 size = buffer.readUInt();
                 this->parseBufferTag(buffer, tag, size);
             }
+            if (!fLazyPaths) {
+                fArrayData.reset();
+            }
             if (!buffer.isValid()) {
                 return false;
             }
@@ -449,6 +500,29 @@ bool new_array_from_buffer(SkReadBuffer& buffer, uint32_t inCount,
     return true;
 }
 
+// Like new_array_from_buffer(buffer, count, fImages, create_image_from_buffer), but only reads
+// the images from the buffer, leaving fDecodes to decode them.
+void SkPictureData::parseImagesAsync(SkReadBuffer& buffer, uint32_t count) {
+    if (!buffer.validate(fImages.empty() && SkTFitsIn<int>(count))) {
+        return;
+    }
+    // Each image has at least its flags and the size of its data.
+    if (!buffer.validateCanReadN<uint64_t>(count)) {
+        return;
+    }
+    fImages.push_back_n(SkToInt(count));
+    const SkDeserialProcs& procs = buffer.getDeserialProcs();
+    for (uint32_t i = 0; i < count; ++i) {
+        SkReadBuffer::EncodedImage encoded;
+        if (!buffer.readEncodedImage(&encoded)) {
+            return;
+        }
+        fDecodes->add([this, i, encoded, procs] {
+            fImages[i] = SkReadBuffer::DecodeImage(encoded, procs);
+        });
+    }
+}
+
 void SkPictureData::parseBufferTag(SkReadBuffer& buffer, uint32_t tag, uint32_t size) {
     switch (tag) {
         case SK_PICT_PAINT_BUFFER_TAG: {
@@ -467,14 +541,45 @@ void SkPictureData::parseBufferTag(SkReadBuffer& buffer, uint32_t tag, uint32_t
         case SK_PICT_PATH_BUFFER_TAG:
             if (size > 0) {
                 const int count = buffer.readInt();
-                if (!buffer.validate(count >= 0)) {
+                if (!buffer.validate(count >= 0 && fPaths.empty())) {
                     return;
                 }
+                if (buffer.isVersionLT(SkPicturePriv::kInPlacePlayback)) {
+                    for (int i = 0; i < count; i++) {
+                        buffer.readPath(&fPaths.push_back());
+                        if (!buffer.isValid()) {
+                            return;
+                        }
+                    }
+                    break;
+                }
+                // Each path is preceded by its size, and takes at least 4 bytes more.
+                if (!buffer.validateCanReadN<uint64_t>(count)) {
+                    return;
+                }
+                // Paths in a buffer we keep (one read in place) are parsed on first use, and
+                // are only validated then; any other paths are validated here.
+                const bool lazy = fArrayData != nullptr;
+                if (lazy) {
+                    fLazyPaths.reset(new LazyPath[count]);
+                }
+                fPaths.push_back_n(count);
                 for (int i = 0; i < count; i++) {
-                    buffer.readPath(&fPaths.push_back());
-                    if (!buffer.isValid()) {
+                    const uint32_t pathSize = buffer.readUInt();
+                    const void* pathData = buffer.skip(pathSize);
+                    if (!buffer.validate(pathData && pathSize > 0 && SkIsAlign4(pathSize))) {
                         return;
                     }
+                    if (lazy) {
+                        fLazyPaths[i].fOffset = (const uint8_t*)pathData - fArrayData->bytes();
+                        fLazyPaths[i].fSize = pathSize;
+                    } else {
+                        SkReadBuffer pathBuffer(pathData, pathSize);
+                        pathBuffer.readPath(&fPaths[i]);
+                        if (!buffer.validate(pathBuffer.isValid() && pathBuffer.eof())) {
+                            return;
+                        }
+                    }
                 }
             } break;
         case SK_PICT_TEXTBLOB_BUFFER_TAG:
@@ -487,7 +592,11 @@ void SkPictureData::parseBufferTag(SkReadBuffer& buffer, uint32_t tag, uint32_t
             new_array_from_buffer(buffer, size, fVertices, SkVerticesPriv::Decode);
             break;
         case SK_PICT_IMAGE_BUFFER_TAG:
-            new_array_from_buffer(buffer, size, fImages, create_image_from_buffer);
+            if (fDecodes) {
+                this->parseImagesAsync(buffer, size);
+            } else {
+                new_array_from_buffer(buffer, size, fImages, create_image_from_buffer);
+            }
             break;
         case SK_PICT_READER_TAG: {
             // Preflight check that we can initialize all data from the buffer
@@ -519,13 +628,23 @@ SkPictureData* SkPictureData::CreateFromStream(SkStream* stream,
                                                const SkPictInfo& info,
                                                const SkDeserialProcs& procs,
                                                SkTypefacePlayback* topLevelTFPlayback,
-                                               int recursionLimit) {
+                                               int recursionLimit,
+                                               sk_sp<SkData> backing) {
     std::unique_ptr<SkPictureData> data(new SkPictureData(info));
     if (!topLevelTFPlayback) {
         topLevelTFPlayback = &data->fTFPlayback;
     }
 
-    if (!data->parseStream(stream, procs, topLevelTFPlayback, recursionLimit)) {
+    if (procs.fExecutor) {
+        data->fDecodes = std::make_unique<SkTaskGroup>(*procs.fExecutor);
+    }
+    const bool parsed = data->parseStream(stream, procs, topLevelTFPlayback, recursionLimit,
+                                          backing);
+    if (data->fDecodes) {
+        data->fDecodes->wait();
+        data->fDecodes.reset();
+    }
+    if (!parsed) {
         return nullptr;
     }
     return data.release();
@@ -545,7 +664,8 @@ SkPictureData* SkPictureData::CreateFromBuffer(SkReadBuffer& buffer,
 bool SkPictureData::parseStream(SkStream* stream,
                                 const SkDeserialProcs& procs,
                                 SkTypefacePlayback* topLevelTFPlayback,
-                                int recursionLimit) {
+                                int recursionLimit,
+                                const sk_sp<SkData>& backing) {
     for (;;) {
         uint32_t tag;
         if (!stream->readU32(&tag)) { return false; }
@@ -555,7 +675,8 @@ bool SkPictureData::parseStream(SkStream* stream,
 
         uint32_t size;
         if (!stream->readU32(&size)) { return false; }
-        if (!this->parseStreamTag(stream, tag, size, procs, topLevelTFPlayback, recursionLimit)) {
+        if (!this->parseStreamTag(stream, tag, size, procs, topLevelTFPlayback, recursionLimit,
+                                  backing)) {
             return false; // we're invalid
         }
     }
@@ -580,6 +701,19 @@ bool SkPictureData::parseBuffer(SkReadBuffer& buffer) {
     return true;
 }
 
+void SkPictureData::parseLazyPath(int index) const {
+    LazyPath& lazy = fLazyPaths[index];
+    lazy.fOnce([&] {
+        SkReadBuffer buffer(fArrayData->bytes() + lazy.fOffset, lazy.fSize);
+        buffer.readPath(&fPaths[index]);
+        if (!buffer.isValid() || !buffer.eof()) {
+            // Too late to fail the load; draw nothing rather than a partial path.
+            fPaths[index].reset();
+        }
+        fPaths[index].updateBoundsCache();
+    });
+}
+
 const SkPaint* SkPictureData::optionalPaint(SkReadBuffer* reader) const {
     int index = reader->readInt();
     if (index == 0) {
@@ -20,10 +20,12 @@
 #include "include/core/SkTextBlob.h"
 #include "include/core/SkTypes.h"
 #include "include/core/SkVertices.h"
+#include "include/private/base/SkOnce.h"
 #include "include/private/base/SkTArray.h"
 #include "include/private/chromium/Slug.h"
 #include "src/core/SkPictureFlat.h"
 #include "src/core/SkReadBuffer.h"
+#include "src/core/SkTaskGroup.h"
 
 #include <cstdint>
 #include <memory>
@@ -63,6 +65,8 @@ public:
 #define SK_PICT_TYPEFACE_TAG   SkSetFourByteTag('t', 'p', 'f', 'c')
 #define SK_PICT_PICTURE_TAG    SkSetFourByteTag('p', 'c', 't', 'r')
 #define SK_PICT_DRAWABLE_TAG   SkSetFourByteTag('d', 'r', 'a', 'w')
+// Up to 3 bytes of padding, so that the data of the following tag is 4-byte aligned.
+#define SK_PICT_PADDING_TAG    SkSetFourByteTag('p', 'a', 'd', ' ')
 
 // This tag specifies the size of the ReadBuffer, needed for the following tags
 #define SK_PICT_BUFFER_SIZE_TAG     SkSetFourByteTag('a', 'r', 'a', 'y')
@@ -88,11 +92,15 @@ class SkPictureData {
 public:
     SkPictureData(const SkPictureRecord& record, const SkPictInfo&);
     // Does not affect ownership of SkStream.
+    // If 'backing' holds the bytes the stream reads (the stream is an SkMemoryStream over it),
+    // the op data and the resource buffer refer to those bytes rather than copying them, when
+    // they are suitably aligned.
     static SkPictureData* CreateFromStream(SkStream*,
                                            const SkPictInfo&,
                                            const SkDeserialProcs&,
                                            SkTypefacePlayback*,
-                                           int recursionLimit);
+                                           int recursionLimit,
+                                           sk_sp<SkData> backing = nullptr);
     static SkPictureData* CreateFromBuffer(SkReadBuffer&, const SkPictInfo&);
 
     void serialize(SkWStream*, const SkSerialProcs&, SkRefCntSet*, bool textBlobsOnly=false) const;
@@ -102,12 +110,14 @@ public:
 
     const sk_sp<SkData>& opData() const { return fOpData; }
 
+    const skia_private::TArray<sk_sp<const SkPicture>>& pictures() const { return fPictures; }
+
 protected:
     explicit SkPictureData(const SkPictInfo& info);
 
     // Does not affect ownership of SkStream.
     bool parseStream(SkStream*, const SkDeserialProcs&, SkTypefacePlayback*,
-                     int recursionLimit);
+                     int recursionLimit, const sk_sp<SkData>& backing);
     bool parseBuffer(SkReadBuffer& buffer);
 
 public:
@@ -119,8 +129,13 @@ public:
 
     const SkPath& getPath(SkReadBuffer* reader) const {
         int index = reader->readInt();
-        return reader->validate(index > 0 && index <= fPaths.size()) ?
-                fPaths[index - 1] : fEmptyPath;
+        if (!reader->validate(index > 0 && index <= fPaths.size())) {
+            return fEmptyPath;
+        }
+        if (fLazyPaths) {
+            this->parseLazyPath(index - 1);
+        }
+        return fPaths[index - 1];
     }
 
     const SkPicture* getPicture(SkReadBuffer* reader) const {
@@ -155,12 +170,24 @@ private:
     // Does not affect ownership of SkStream.
     bool parseStreamTag(SkStream*, uint32_t tag, uint32_t size,
                         const SkDeserialProcs&, SkTypefacePlayback*,
-                        int recursionLimit);
+                        int recursionLimit, const sk_sp<SkData>& backing);
     void parseBufferTag(SkReadBuffer&, uint32_t tag, uint32_t size);
     void flattenToBuffer(SkWriteBuffer&, bool textBlobsOnly) const;
 
+    void parseImagesAsync(SkReadBuffer&, uint32_t count);
+    void parseLazyPath(int index) const;
+
     skia_private::TArray<SkPaint> fPaints;
-    skia_private::TArray<SkPath>  fPaths;
+    // Paths of a picture read in place are parsed from fArrayData on first use (see getPath()).
+    mutable skia_private::TArray<SkPath> fPaths;
+
+    struct LazyPath {
+        size_t fOffset;  // In fArrayData.
+        size_t fSize;
+        SkOnce fOnce;
+    };
+    sk_sp<SkData>               fArrayData;  // The resource buffer, while paths remain in it.
+    std::unique_ptr<LazyPath[]> fLazyPaths;
 
     sk_sp<SkData>                 fOpData;    // opcodes and parameters
 
@@ -174,6 +201,10 @@ private:
     skia_private::TArray<sk_sp<const SkImage>>     fImages;
     skia_private::TArray<sk_sp<const sktext::gpu::Slug>> fSlugs;
 
+    // While reading from a stream with SkDeserialProcs::fExecutor set, the image decodes that
+    // are filling in fImages.
+    std::unique_ptr<SkTaskGroup> fDecodes;
+
     SkTypefacePlayback                 fTFPlayback;
     std::unique_ptr<SkFactoryPlayback> fFactoryPlayback;
 
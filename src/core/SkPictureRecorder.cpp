@@ -12,16 +12,21 @@
 #include "include/core/SkPicture.h"
 #include "include/core/SkTypes.h"
 #include "include/private/base/SkTemplates.h"
+#include "include/private/base/SkTo.h"
 #include "src/core/SkBigPicture.h"
 #include "src/core/SkRecord.h"
 #include "src/core/SkRecordDraw.h"
 #include "src/core/SkRecordOpts.h"
 #include "src/core/SkRecordedDrawable.h"
 #include "src/core/SkRecorder.h"
+#include "src/core/SkRecords.h"
+#include "src/core/SkTaskGroup.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <memory>
 #include <utility>
+#include <vector>
 
 using namespace skia_private;
 
@@ -64,26 +69,28 @@ public:
     SkRect cullRect()             const override { return SkRect::MakeEmpty(); }
 };
 
-sk_sp<SkPicture> SkPictureRecorder::finishRecordingAsPicture() {
+void SkPictureRecorder::finishRecord() {
     fActivelyRecording = false;
     fRecorder->restoreToCount(1);  // If we were missing any restores, add them now.
 
     if (fRecord->count() == 0) {
-        return sk_make_sp<SkEmptyPicture>();
+        return;
     }
 
     // TODO: delay as much of this work until just before first playback?
+    if (fDropOccludedDraws) {
+        // First, as it no-ops the single draws that SkRecordOptimize() may merge.
+        SkRecordNoopOccludedDraws(fRecord.get());
+    }
     SkRecordOptimize(fRecord.get());
-
-    SkDrawableList* drawableList = fRecorder->getDrawableList();
-    std::unique_ptr<SkBigPicture::SnapshotArray> pictList{
-        drawableList ? drawableList->newDrawableSnapshot() : nullptr
-    };
+    if (fCompactRecording) {
+        fRecord->compact();
+    }
 
     if (fBBH) {
         AutoTArray<SkRect> bounds(fRecord->count());
         AutoTMalloc<SkBBoxHierarchy::Metadata> meta(fRecord->count());
-        SkRecordFillBounds(fCullRect, *fRecord, bounds.data(), meta);
+        SkRecordFillBounds(fCullRect, *fRecord, bounds.data(), meta, fCullOccludedDraws);
 
         fBBH->insert(bounds.data(), meta, fRecord->count());
 
@@ -96,6 +103,18 @@ sk_sp<SkPicture> SkPictureRecorder::finishRecordingAsPicture() {
               || (bbhBound.isEmpty() && fCullRect.isEmpty()));
         fCullRect = bbhBound;
     }
+}
+
+sk_sp<SkPicture> SkPictureRecorder::finishRecordingAsPicture() {
+    this->finishRecord();
+    if (fRecord->count() == 0) {
+        return sk_make_sp<SkEmptyPicture>();
+    }
+
+    SkDrawableList* drawableList = fRecorder->getDrawableList();
+    std::unique_ptr<SkBigPicture::SnapshotArray> pictList{
+        drawableList ? drawableList->newDrawableSnapshot() : nullptr
+    };
 
     size_t subPictureBytes = fRecorder->approxBytesUsedBySubPictures();
     for (int i = 0; pictList && i < pictList->count(); i++) {
@@ -133,12 +152,19 @@ sk_sp<SkDrawable> SkPictureRecorder::finishRecordingAsDrawable() {
     fActivelyRecording = false;
     fRecorder->restoreToCount(1);  // If we were missing any restores, add them now.
 
+    if (fDropOccludedDraws) {
+        // First, as it no-ops the single draws that SkRecordOptimize() may merge.
+        SkRecordNoopOccludedDraws(fRecord.get());
+    }
     SkRecordOptimize(fRecord.get());
+    if (fCompactRecording) {
+        fRecord->compact();
+    }
 
     if (fBBH) {
         AutoTArray<SkRect> bounds(fRecord->count());
         AutoTMalloc<SkBBoxHierarchy::Metadata> meta(fRecord->count());
-        SkRecordFillBounds(fCullRect, *fRecord, bounds.data(), meta);
+        SkRecordFillBounds(fCullRect, *fRecord, bounds.data(), meta, fCullOccludedDraws);
         fBBH->insert(bounds.data(), meta, fRecord->count());
     }
 
@@ -148,3 +174,142 @@ sk_sp<SkDrawable> SkPictureRecorder::finishRecordingAsDrawable() {
 
     return drawable;
 }
+
+namespace {
+
+// The BBH of a concatenated picture searches each part's BBH, rebasing the indices it finds.
+// Each part's ops are wrapped in a Save and a Restore, which are found around any of its ops.
+class SkConcatenatedBBH final : public SkBBoxHierarchy {
+public:
+    struct Part {
+        int                    fSave;   // The index of the Save before the part's ops.
+        int                    fCount;  // The number of the part's ops.
+        sk_sp<SkBBoxHierarchy> fBBH;    // If null, all the part's ops are always found.
+    };
+
+    explicit SkConcatenatedBBH(std::vector<Part> parts) : fParts(std::move(parts)) {}
+
+    void insert(const SkRect[], int N) override {
+        SkDEBUGFAIL("SkConcatenatedBBH is made from its parts' BBHs.");
+    }
+
+    void search(const SkRect& query, std::vector<int>* results) const override {
+        std::vector<int> found;
+        for (const Part& part : fParts) {
+            const int first = part.fSave + 1;
+            if (!part.fBBH) {
+                results->push_back(part.fSave);
+                for (int i = 0; i < part.fCount; i++) {
+                    results->push_back(first + i);
+                }
+                results->push_back(first + part.fCount);
+                continue;
+            }
+            found.clear();
+            part.fBBH->search(query, &found);
+            if (found.empty()) {
+                continue;
+            }
+            results->push_back(part.fSave);
+            for (int op : found) {
+                results->push_back(first + op);
+            }
+            results->push_back(first + part.fCount);
+        }
+    }
+
+    size_t bytesUsed() const override {
+        size_t bytes = sizeof(*this) + fParts.capacity() * sizeof(Part);
+        for (const Part& part : fParts) {
+            bytes += part.fBBH ? part.fBBH->bytesUsed() : 0;
+        }
+        return bytes;
+    }
+
+private:
+    std::vector<Part> fParts;
+};
+
+// Moves a part's DrawDrawable ops to its drawables' place among all the parts' drawables.
+struct DrawableIndexRebaser {
+    int fOffset;
+
+    template <typename T>
+    void operator()(T*) {}
+    void operator()(SkRecords::DrawDrawable* op) { op->index += fOffset; }
+};
+
+}  // namespace
+
+sk_sp<SkPicture> SkPictureRecorder::FinishRecordingAsConcatenatedPicture(
+        SkSpan<SkPictureRecorder* const> parts, SkExecutor* executor) {
+    const int partCount = SkToInt(parts.size());
+    auto finish = [&parts](int i) { parts[i]->finishRecord(); };
+    if (executor) {
+        SkTaskGroup tasks(*executor);
+        tasks.batch(partCount, finish);
+        tasks.wait();
+    } else {
+        for (int i = 0; i < partCount; i++) {
+            finish(i);
+        }
+    }
+
+    sk_sp<SkRecord> record = sk_make_sp<SkRecord>();
+    std::vector<SkConcatenatedBBH::Part> bbhParts;
+    bool anyBBH = false;
+    std::vector<const SkPicture*> drawablePicts;
+    size_t subPictureBytes = 0;
+    SkRect cullRect = SkRect::MakeEmpty();
+    for (SkPictureRecorder* part : parts) {
+        SkASSERT(part->fRecord);
+        if (part->fRecord->count() == 0) {
+            continue;
+        }
+
+        if (SkDrawableList* drawableList = part->fRecorder->getDrawableList()) {
+            if (!drawablePicts.empty()) {
+                DrawableIndexRebaser rebaser{SkToInt(drawablePicts.size())};
+                for (int i = 0; i < part->fRecord->count(); i++) {
+                    part->fRecord->mutate(i, rebaser);
+                }
+            }
+            for (SkDrawable* drawable : *drawableList) {
+                drawablePicts.push_back(drawable->makePictureSnapshot().release());
+                subPictureBytes += drawablePicts.back()->approximateBytesUsed();
+            }
+        }
+        subPictureBytes += part->fRecorder->approxBytesUsedBySubPictures();
+
+        const int save = record->count();
+        const int count = part->fRecord->count();
+        new (record->append<SkRecords::Save>()) SkRecords::Save{};
+        record->concat(part->fRecord.get());
+        new (record->append<SkRecords::Restore>()) SkRecords::Restore{SkMatrix::I()};
+
+        anyBBH = anyBBH || part->fBBH;
+        bbhParts.push_back({save, count, std::move(part->fBBH)});
+        cullRect.join(part->fCullRect);
+    }
+
+    if (record->count() == 0) {
+        return sk_make_sp<SkEmptyPicture>();
+    }
+
+    std::unique_ptr<SkBigPicture::SnapshotArray> pictList;
+    if (!drawablePicts.empty()) {
+        AutoTMalloc<const SkPicture*> pics(drawablePicts.size());
+        std::copy(drawablePicts.begin(), drawablePicts.end(), pics.get());
+        pictList = std::make_unique<SkBigPicture::SnapshotArray>(
+                pics.release(), SkToInt(drawablePicts.size()));
+    }
+    sk_sp<SkBBoxHierarchy> bbh;
+    if (anyBBH) {
+        bbh = sk_make_sp<SkConcatenatedBBH>(std::move(bbhParts));
+    }
+    return sk_make_sp<SkBigPicture>(cullRect,
+                                    std::move(record),
+                                    std::move(pictList),
+                                    std::move(bbh),
+                                    subPictureBytes);
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkPlaybackPicture.h"
+
+#include "include/core/SkData.h"
+#include "include/private/base/SkAlign.h"
+#include "src/core/SkPictureData.h"
+#include "src/core/SkPictureFlat.h"
+#include "src/core/SkPicturePlayback.h"
+#include "src/core/SkReadBuffer.h"
+
+#include <utility>
+
+// Walks the op headers without interpreting the ops. Each op starts with a word holding its
+// type (8 bits) and its size in bytes, including that word (24 bits). Larger ops store 0xffffff
+// there, followed by a word holding their size plus one (see SkPictureRecord::addDraw()).
+static bool count_ops(const SkData& ops, int* opCount) {
+    SkReadBuffer reader(ops.data(), ops.size());
+    int count = 0;
+    while (!reader.eof() && reader.isValid()) {
+        const size_t start = reader.offset();
+        const uint32_t bits = reader.readUInt();
+        const uint32_t op = bits >> 24;
+        size_t size = bits & 0xffffff;
+        if (size == 0xffffff) {
+            size = reader.readUInt() + 3;
+        }
+        if (!reader.validate(op > UNUSED && op <= LAST_DRAWTYPE_ENUM && SkIsAlign4(size) &&
+                             start + size >= reader.offset() && start + size <= ops.size())) {
+            return false;
+        }
+        reader.skip(start + size - reader.offset());
+        count++;
+    }
+    *opCount = count;
+    return reader.isValid();
+}
+
+sk_sp<SkPicture> SkPlaybackPicture::Make(std::unique_ptr<const SkPictureData> data) {
+    int opCount;
+    if (!data || !data->opData() || !count_ops(*data->opData(), &opCount)) {
+        return nullptr;
+    }
+    return sk_sp<SkPicture>(new SkPlaybackPicture(std::move(data), opCount));
+}
+
+SkPlaybackPicture::SkPlaybackPicture(std::unique_ptr<const SkPictureData> data, int opCount)
+        : fData(std::move(data)), fOpCount(opCount) {}
+
+SkPlaybackPicture::~SkPlaybackPicture() = default;
+
+void SkPlaybackPicture::playback(SkCanvas* canvas, AbortCallback* callback) const {
+    SkPicturePlayback playback(fData.get());
+    playback.draw(canvas, callback, nullptr);
+}
+
+SkRect SkPlaybackPicture::cullRect() const { return fData->info().fCullRect; }
+
+int SkPlaybackPicture::approximateOpCount(bool nested) const {
+    int count = fOpCount;
+    if (nested) {
+        for (const sk_sp<const SkPicture>& picture : fData->pictures()) {
+            count += picture->approximateOpCount(true);
+        }
+    }
+    return count;
+}
+
+size_t SkPlaybackPicture::approximateBytesUsed() const {
+    size_t bytes = sizeof(*this) + sizeof(SkPictureData) + fData->opData()->size();
+    for (const sk_sp<const SkPicture>& picture : fData->pictures()) {
+        bytes += picture->approximateBytesUsed();
+    }
+    return bytes;
+}
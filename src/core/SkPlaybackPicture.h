@@ -0,0 +1,45 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPlaybackPicture_DEFINED
+#define SkPlaybackPicture_DEFINED
+
+#include "include/core/SkPicture.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+
+#include <cstddef>
+#include <memory>
+
+class SkCanvas;
+class SkPictureData;
+
+// An SkPicture that plays back serialized drawing commands directly with SkPicturePlayback,
+// rather than re-recording them into an SkRecord the way SkPicture::MakeFromData() does. Made by
+// SkPicture::MakeFromDataInPlace(), whose SkData the op data and resources may refer to.
+class SkPlaybackPicture final : public SkPicture {
+public:
+    // Checks that the op stream is well formed: every op has a known type and a size that
+    // keeps it within the stream. Returns nullptr if it isn't, or if data is null.
+    static sk_sp<SkPicture> Make(std::unique_ptr<const SkPictureData> data);
+
+    ~SkPlaybackPicture() override;
+
+// SkPicture overrides
+    void playback(SkCanvas*, AbortCallback*) const override;
+    SkRect cullRect() const override;
+    int approximateOpCount(bool nested) const override;
+    size_t approximateBytesUsed() const override;
+
+private:
+    SkPlaybackPicture(std::unique_ptr<const SkPictureData>, int opCount);
+
+    std::unique_ptr<const SkPictureData> fData;
+    const int                            fOpCount;
+};
+
+#endif  // SkPlaybackPicture_DEFINED
@@ -10,6 +10,7 @@
 
 #include "include/core/SkColor.h"
 #include "include/core/SkColorFilter.h"
+#include "include/core/SkData.h"
 #include "include/core/SkFlattenable.h"
 #include "include/core/SkImageFilter.h"
 #include "include/core/SkPaint.h"
@@ -37,7 +38,6 @@
 #include <cstdint>
 
 class SkBlender;
-class SkData;
 class SkImage;
 class SkM44;
 class SkMaskFilter;
@@ -169,6 +169,18 @@ public:
     // be created (e.g. it was not originally encoded) then this returns an image that doesn't
     // draw.
     sk_sp<SkImage> readImage();
+
+    // readImage() in two steps: reading an image's serialized form, and decoding it. The
+    // decode may happen later, and on another thread; it does not need this buffer.
+    struct EncodedImage {
+        uint32_t      fFlags = 0;
+        sk_sp<SkData> fData;
+        SkIRect       fSubset = SkIRect::MakeEmpty();
+        sk_sp<SkData> fMipmaps;
+    };
+    // Returns false, and invalidates the buffer, if the data is corrupt.
+    bool readEncodedImage(EncodedImage*);
+    static sk_sp<SkImage> DecodeImage(const EncodedImage&, const SkDeserialProcs&);
     sk_sp<SkTypeface> readTypeface();
 
     void setTypefaceArray(sk_sp<SkTypeface> array[], int count) {
@@ -7,7 +7,18 @@
 
 #include "src/core/SkRecord.h"
 
+#include "include/core/SkPath.h"
+#include "include/core/SkRSXform.h"
+#include "src/core/SkCanvasPriv.h"
+#include "src/core/SkChecksum.h"
+#include "src/core/SkPathPriv.h"
+#include "src/core/SkTHash.h"
+#include "src/utils/SkPatchUtils.h"
+
 #include <algorithm>
+#include <memory>
+#include <new>
+#include <utility>
 
 SkRecord::~SkRecord() {
     Destroyer destroyer;
@@ -23,7 +34,7 @@ void SkRecord::grow() {
 }
 
 size_t SkRecord::bytesUsed() const {
-    size_t bytes = fApproxBytesAllocated + sizeof(SkRecord);
+    size_t bytes = fApproxBytesAllocated + sizeof(SkRecord) + fReserved * sizeof(Record);
     return bytes;
 }
 
@@ -35,3 +46,182 @@ void SkRecord::defrag() {
                                    [](Record op) { return op.type() == SkRecords::NoOp_Type; });
     fCount = noops - fRecords.get();
 }
+
+namespace {
+
+// Points equal paths at the first one's SkPathRef.
+class PathInterner {
+public:
+    void intern(SkPath* path) {
+        if (path->isEmpty()) {
+            return;
+        }
+        const uint32_t hash = Hash(*path);
+        if (SkPath** canonical = fPaths.find(hash)) {
+            // A hash collision between different paths just leaves this one alone.
+            if (**canonical == *path) {
+                *path = **canonical;
+            }
+        } else {
+            fPaths.set(hash, path);
+        }
+    }
+
+private:
+    static uint32_t Hash(const SkPath& path) {
+        uint32_t hash = SkChecksum::Hash32(SkPathPriv::VerbData(path), path.countVerbs(),
+                                           (uint32_t)path.getFillType());
+        hash = SkChecksum::Hash32(SkPathPriv::PointData(path),
+                                  path.countPoints() * sizeof(SkPoint), hash);
+        return SkChecksum::Hash32(SkPathPriv::ConicWeightData(path),
+                                  SkPathPriv::ConicWeightCnt(path) * sizeof(SkScalar), hash);
+    }
+
+    skia_private::THashMap<uint32_t, SkPath*> fPaths;
+};
+
+// Moves ops, and the data their Optional and PODArray fields point to, into a new arena.
+class Relocator {
+public:
+    explicit Relocator(SkArenaAlloc* alloc) : fAlloc(alloc) {}
+
+    size_t bytesAllocated() const { return fBytesAllocated; }
+
+    // Returns the op's new address.  The empty ops are all shared static singletons, so stay put.
+    template <typename T>
+    void* operator()(T* op) {
+        if constexpr (std::is_empty<T>::value) {
+            return op;
+        } else {
+            T* moved = new (this->alloc<T>(1)) T(std::move(*op));
+            op->~T();
+            this->relocateFields(moved);
+            return moved;
+        }
+    }
+
+private:
+    // Mirrors SkRecord::alloc(), including its byte count.
+    template <typename T>
+    T* alloc(size_t count) {
+        struct RawBytes {
+            alignas(T) char data[sizeof(T)];
+        };
+        fBytesAllocated += count * sizeof(T) + alignof(T);
+        return (T*)fAlloc->makeArrayDefault<RawBytes>(count);
+    }
+
+    template <typename T>
+    void relocate(SkRecords::Optional<T>* field) {
+        if (T* value = *field) {
+            T* moved = new (this->alloc<T>(1)) T(std::move(*value));
+            // Destroys the moved-from value.
+            field->~Optional();
+            new (field) SkRecords::Optional<T>(moved);
+        }
+    }
+
+    template <typename T>
+    void relocate(SkRecords::PODArray<T>* field, size_t count) {
+        if (const T* values = *field) {
+            T* moved = this->alloc<T>(count);
+            std::uninitialized_copy_n(values, count, moved);
+            *field = moved;
+        }
+    }
+
+    template <typename T>
+    void relocateFields(T*) {}
+
+    void relocateFields(SkRecords::SaveLayer* op) {
+        this->relocate(&op->bounds);
+        this->relocate(&op->paint);
+    }
+    void relocateFields(SkRecords::SaveBehind* op) { this->relocate(&op->subset); }
+    void relocateFields(SkRecords::DrawDrawable* op) { this->relocate(&op->matrix); }
+    void relocateFields(SkRecords::DrawImage* op) { this->relocate(&op->paint); }
+    void relocateFields(SkRecords::DrawImageRect* op) { this->relocate(&op->paint); }
+    void relocateFields(SkRecords::DrawPicture* op) { this->relocate(&op->paint); }
+    void relocateFields(SkRecords::DrawImageLattice* op) {
+        this->relocate(&op->paint);
+        this->relocate(&op->xDivs, op->xCount);
+        this->relocate(&op->yDivs, op->yCount);
+        this->relocate(&op->flags, op->flagCount);
+        this->relocate(&op->colors, op->flagCount);
+    }
+    void relocateFields(SkRecords::DrawPoints* op) { this->relocate(&op->pts, op->count); }
+    void relocateFields(SkRecords::DrawPatch* op) {
+        this->relocate(&op->cubics, SkPatchUtils::kNumCtrlPts);
+        this->relocate(&op->colors, SkPatchUtils::kNumCorners);
+        this->relocate(&op->texCoords, SkPatchUtils::kNumCorners);
+    }
+    void relocateFields(SkRecords::DrawAtlas* op) {
+        this->relocate(&op->paint);
+        this->relocate(&op->xforms, op->count);
+        this->relocate(&op->texs, op->count);
+        this->relocate(&op->colors, op->count);
+        this->relocate(&op->cull);
+    }
+    void relocateFields(SkRecords::DrawEdgeAAQuad* op) { this->relocate(&op->clip, 4); }
+    void relocateFields(SkRecords::DrawEdgeAAImageSet* op) {
+        int dstClipCount, matrixCount;
+        SkCanvasPriv::GetDstClipAndMatrixCounts(op->set.get(), op->count,
+                                                &dstClipCount, &matrixCount);
+        this->relocate(&op->paint);
+        this->relocate(&op->dstClips, dstClipCount);
+        this->relocate(&op->preViewMatrices, matrixCount);
+    }
+
+    // Paths are stored inline in their ops, but their points live in a shared SkPathRef.
+    void relocateFields(SkRecords::ClipPath* op) { fPaths.intern(&op->path); }
+    void relocateFields(SkRecords::DrawPath* op) { fPaths.intern(&op->path); }
+    void relocateFields(SkRecords::DrawShadowRec* op) { fPaths.intern(&op->path); }
+
+    SkArenaAlloc* fAlloc;
+    size_t        fBytesAllocated = 0;
+    PathInterner  fPaths;
+};
+
+}  // namespace
+
+void SkRecord::compact() {
+    if (fReserved > fCount) {
+        fReserved = fCount;
+        fRecords.realloc(fReserved);
+    }
+
+    // Everything live fits in fApproxBytesAllocated, which also counts ops since replaced.
+    // The arena's block sizes are limited, so very large records spill into a few more blocks.
+    constexpr size_t kMaxBlock = 1 << 24;
+    auto alloc = std::make_unique<SkArenaAlloc>(
+            std::min(fApproxBytesAllocated + sizeof(void*) * 4, kMaxBlock));
+    Relocator relocator(alloc.get());
+    for (int i = 0; i < fCount; i++) {
+        fRecords[i].fPtr = this->mutate(i, relocator);
+    }
+    fAlloc = std::move(alloc);
+    fAdoptedAllocs.clear();
+    fApproxBytesAllocated = relocator.bytesAllocated();
+}
+
+void SkRecord::concat(SkRecord* other) {
+    SkASSERT(other != this);
+    if (fCount + other->fCount > fReserved) {
+        fReserved = std::max(fCount + other->fCount, fReserved * 2);
+        fRecords.realloc(fReserved);
+    }
+    std::copy(other->fRecords.get(), other->fRecords.get() + other->fCount,
+              fRecords.get() + fCount);
+    fCount += other->fCount;
+    other->fCount = 0;
+
+    fAdoptedAllocs.push_back(std::move(other->fAlloc));
+    for (std::unique_ptr<SkArenaAlloc>& alloc : other->fAdoptedAllocs) {
+        fAdoptedAllocs.push_back(std::move(alloc));
+    }
+    other->fAdoptedAllocs.clear();
+    other->fAlloc = std::make_unique<SkArenaAlloc>(256);
+
+    fApproxBytesAllocated += other->fApproxBytesAllocated;
+    other->fApproxBytesAllocated = 0;
+}
@@ -15,7 +15,9 @@
 #include "src/core/SkRecords.h"
 
 #include <cstddef>
+#include <memory>
 #include <type_traits>
+#include <vector>
 
 // SkRecord represents a sequence of SkCanvas calls, saved for future use.
 // These future uses may include: replay, optimization, serialization, or combinations of those.
@@ -63,7 +65,7 @@ public:
             alignas(T) char data[sizeof(T)];
         };
         fApproxBytesAllocated += count * sizeof(T) + alignof(T);
-        return (T*)fAlloc.makeArrayDefault<RawBytes>(count);
+        return (T*)fAlloc->makeArrayDefault<RawBytes>(count);
     }
 
     // Add a new command of type T to the end of this SkRecord.
@@ -97,6 +99,16 @@ public:
     // May change count() and the indices of ops, but preserves their order.
     void defrag();
 
+    // Move the ops, and the arrays and optional values they point to, into one exactly sized
+    // block, freeing the slack of the growing arena and of the op array.  Equal paths are made
+    // to share their SkPathRef.  Preserves count() and the order of the ops, but pointers into
+    // the ops (and into the data they point to) are invalidated.
+    void compact();
+
+    // Move other's ops to the end of this record, leaving other empty.  The ops themselves stay
+    // where they are: this record takes over the memory they were allocated from.
+    void concat(SkRecord* other);
+
 private:
     // An SkRecord is structured as an array of pointers into a big chunk of memory where
     // records representing each canvas draw call are stored:
@@ -177,8 +189,11 @@ private:
     skia_private::AutoTMalloc<Record> fRecords;
 
     // fAlloc needs to be a data structure which can append variable length data in contiguous
-    // chunks, returning a stable handle to that data for later retrieval.
-    SkArenaAlloc fAlloc{256};
+    // chunks, returning a stable handle to that data for later retrieval.  It's held by pointer
+    // so that compact() can replace it.
+    std::unique_ptr<SkArenaAlloc> fAlloc = std::make_unique<SkArenaAlloc>(256);
+    // The arenas of records concat()ed onto this one.
+    std::vector<std::unique_ptr<SkArenaAlloc>> fAdoptedAllocs;
     size_t       fApproxBytesAllocated{0};
 };
 
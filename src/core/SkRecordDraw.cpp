@@ -31,6 +31,7 @@
 #include "src/core/SkCanvasPriv.h"
 #include "src/core/SkDrawShadowInfo.h"
 #include "src/core/SkImageFilter_Base.h"
+#include "src/core/SkRRectPriv.h"
 #include "src/core/SkRecord.h"
 #include "src/core/SkRecords.h"
 #include "src/effects/colorfilters/SkColorFilterBase.h"
@@ -572,12 +573,223 @@ private:
     SkTDArray<int>   fControlIndices;
 };
 
+// This is an SkRecord visitor that runs after FillBounds, marking draws that later draws cover
+// with opaque pixels as occluded.  BBHs leave occluded draws out, so playback skips them.
+//
+// An opaque, non-AA DrawRect (or the inner rect of a DrawRRect) replaces exactly the pixels whose
+// centers it contains, so it hides any earlier non-AA draw whose bounds it contains.  An opaque
+// DrawPaint hides every earlier draw.  Either only hides draws made under the same clip or a
+// smaller one, never draws inside anti-aliased or shader clips (which only partially cover the
+// pixels along their edges), never draws in another layer, and never draws that a layer's
+// backdrop, kInitWithPrevious_SaveLayerFlag or SaveBehind reads.  The bounds come from FillBounds,
+// in identity space, so containment holds whatever matrix the picture is played back with.
+class FindOccludedDraws : SkNoncopyable {
+public:
+    FindOccludedDraws(const SkRect bounds[], SkBBoxHierarchy::Metadata meta[])
+        : fBounds(bounds)
+        , fMeta(meta) {
+        fCTM = SkMatrix::I();
+        fClips.push_back({-1, false});
+    }
+
+    void setCurrentOp(int currentOp) { fCurrentOp = currentOp; }
+
+    template <typename T> void operator()(const T& op) {
+        this->updateCTM(op);
+        this->track(op);
+    }
+
+private:
+    // A clip and the clip it was intersected with; each clip op starts a new one.
+    struct Clip {
+        int parent;    // Index in fClips, or -1 if this clip doesn't shrink any other.
+        bool partial;  // Whether anything up to the root is anti-aliased or a shader.
+    };
+    struct SaveState {
+        int clip;
+        int layerFloor;  // fDraws.size() when a layer started, or -1 for a plain Save.
+    };
+    struct Draw {
+        int op;
+        int clip;
+        bool antiAlias;
+    };
+    // Limits the draws each occluder checks, from the most recent back.
+    static constexpr int kMaxDrawsToCheck = 256;
+
+    template <typename T> void updateCTM(const T&) {}
+    void updateCTM(const Restore& op)   { fCTM = op.matrix; }
+    void updateCTM(const SetMatrix& op) { fCTM = op.matrix; }
+    void updateCTM(const SetM44& op)    { fCTM = op.matrix.asM33(); }
+    void updateCTM(const Concat44& op)  { fCTM.preConcat(op.matrix.asM33()); }
+    void updateCTM(const Concat& op)    { fCTM.preConcat(op.matrix); }
+    void updateCTM(const Scale& op)     { fCTM.preScale(op.sx, op.sy); }
+    void updateCTM(const Translate& op) { fCTM.preTranslate(op.dx, op.dy); }
+
+    void track(const Save&)       { fSaves.push_back({fClip, -1}); }
+    void track(const SaveLayer& op) {
+        this->pushLayer(op.backdrop ||
+                        (op.saveLayerFlags & SkCanvas::kInitWithPrevious_SaveLayerFlag));
+    }
+    void track(const SaveBehind&) { this->pushLayer(true); }
+    void track(const Restore&) {
+        if (fSaves.empty()) {
+            return;
+        }
+        const SaveState state = fSaves.back();
+        fSaves.pop_back();
+        fClip = state.clip;
+        if (state.layerFloor >= 0) {
+            // Nothing outside the layer can hide what's in it, and vice versa.
+            fDraws.resize((size_t)fFloor);
+            fFloor = state.layerFloor;
+        }
+    }
+
+    void track(const ClipRect& op)  { this->clip(op.opAA.aa()); }
+    void track(const ClipRRect& op) { this->clip(op.opAA.aa()); }
+    void track(const ClipPath& op)  { this->clip(op.opAA.aa()); }
+    void track(const ClipRegion&)   { this->clip(false); }
+    void track(const ClipShader&)   { this->clip(true); }
+    void track(const ResetClip&) {
+        // The clip grows back, so it doesn't contain any clip that came before.
+        fClips.push_back({-1, false});
+        fClip = (int)fClips.size() - 1;
+    }
+
+    // Occluders.
+    void track(const DrawPaint& op) {
+        if (IsOpaqueFill(op.paint)) {
+            this->occlude(std::nullopt);
+        }
+    }
+    void track(const DrawRect& op) {
+        if (!op.paint.isAntiAlias() && IsOpaqueFill(op.paint)) {
+            this->occlude(op.rect.makeSorted());
+        }
+        this->draw(&op.paint);
+    }
+    void track(const DrawRRect& op) {
+        if (!op.rrect.isEmpty() && !op.paint.isAntiAlias() && IsOpaqueFill(op.paint)) {
+            this->occlude(SkRRectPriv::InnerBounds(op.rrect));
+        }
+        this->draw(&op.paint);
+    }
+
+    // Draws whose bounds are tight enough to be worth trying to hide.
+    void track(const DrawOval& op)         { this->draw(&op.paint); }
+    void track(const DrawArc& op)          { this->draw(&op.paint); }
+    void track(const DrawDRRect& op)       { this->draw(&op.paint); }
+    void track(const DrawRegion& op)       { this->draw(&op.paint); }
+    void track(const DrawPoints& op)       { this->draw(&op.paint); }
+    void track(const DrawImage& op)        { this->draw(op.paint); }
+    void track(const DrawImageRect& op)    { this->draw(op.paint); }
+    void track(const DrawImageLattice& op) { this->draw(op.paint); }
+    void track(const DrawTextBlob&)        { this->draw(nullptr, true); }
+    void track(const DrawSlug&)            { this->draw(nullptr, true); }
+    void track(const DrawPath& op) {
+        if (!op.path.isInverseFillType()) {
+            this->draw(&op.paint);
+        }
+    }
+
+    // Anything else neither hides nor is hidden.
+    template <typename T> void track(const T&) {}
+
+    static bool IsOpaqueFill(const SkPaint& paint) {
+        if (paint.getAlpha() != 0xFF ||
+            paint.getStyle() != SkPaint::kFill_Style ||
+            (paint.getShader() && !paint.getShader()->isOpaque()) ||
+            paint.getColorFilter() ||
+            paint.getMaskFilter()  ||
+            paint.getPathEffect()  ||
+            paint.getImageFilter()) {
+            return false;
+        }
+        const auto bm = paint.asBlendMode();
+        return bm == SkBlendMode::kSrcOver || bm == SkBlendMode::kSrc;
+    }
+
+    void pushLayer(bool readsBackdrop) {
+        if (readsBackdrop) {
+            // What the layer starts from (or puts back behind itself) depends on the draws made
+            // so far, even where a later draw covers them.
+            fDraws.resize((size_t)fFloor);
+        }
+        fSaves.push_back({fClip, fFloor});
+        fFloor = (int)fDraws.size();
+    }
+
+    void clip(bool partial) {
+        fClips.push_back({fClip, partial || fClips[fClip].partial});
+        fClip = (int)fClips.size() - 1;
+    }
+
+    void draw(const SkPaint* paint, bool antiAlias = false) {
+        if (!fBounds[fCurrentOp].isEmpty()) {
+            fDraws.push_back({fCurrentOp, fClip, antiAlias || (paint && paint->isAntiAlias())});
+        }
+    }
+
+    // Whether the current clip is the same as, or contains, the one a draw was made under.
+    bool containsClip(int clip) const {
+        for (; clip >= 0; clip = fClips[clip].parent) {
+            if (clip == fClip) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Marks draws that the current draw hides: those with bounds inside rect (in local space),
+    // or all of them if rect is null.
+    void occlude(std::optional<SkRect> rect) {
+        if (fClips[fClip].partial || (rect && !fCTM.rectStaysRect())) {
+            return;
+        }
+        const SkRect covered = rect ? fCTM.mapRect(*rect) : SkRect::MakeEmpty();
+        const int first = std::max(fFloor, (int)fDraws.size() - kMaxDrawsToCheck);
+        auto hidden = [&](const Draw& draw) {
+            if (rect && (draw.antiAlias || !covered.contains(fBounds[draw.op]))) {
+                return false;
+            }
+            if (!this->containsClip(draw.clip)) {
+                return false;
+            }
+            fMeta[draw.op].isOccluded = true;
+            return true;
+        };
+        fDraws.erase(std::remove_if(fDraws.begin() + first, fDraws.end(), hidden), fDraws.end());
+    }
+
+    const SkRect* fBounds;
+    SkBBoxHierarchy::Metadata* fMeta;
+
+    int fCurrentOp;
+    SkMatrix fCTM;
+
+    std::vector<Clip> fClips;
+    int fClip = 0;
+    std::vector<SaveState> fSaves;
+    // Draws not yet hidden, in order.  Those from fFloor on are in the current layer.
+    std::vector<Draw> fDraws;
+    int fFloor = 0;
+};
+
 }  // namespace SkRecords
 
 void SkRecordFillBounds(const SkRect& cullRect, const SkRecord& record,
-                        SkRect bounds[], SkBBoxHierarchy::Metadata meta[]) {
+                        SkRect bounds[], SkBBoxHierarchy::Metadata meta[], bool findOccluded) {
     {
         SkRecords::FillBounds visitor(cullRect, record, bounds, meta);
+        for (int i = 0; i < record.count(); i++) {
+            meta[i].isOccluded = false;
+            visitor.setCurrentOp(i);
+            record.visit(i, visitor);
+        }
+    }
+    if (findOccluded) {
+        SkRecords::FindOccludedDraws visitor(bounds, meta);
         for (int i = 0; i < record.count(); i++) {
             visitor.setCurrentOp(i);
             record.visit(i, visitor);
@@ -18,9 +18,10 @@ class SkDrawable;
 class SkRecord;
 struct SkRect;
 
-// Calculate conservative identity space bounds for each op in the record.
+// Calculate conservative identity space bounds for each op in the record.  If findOccluded is
+// true, also mark the draws that later opaque draws completely cover as occluded.
 void SkRecordFillBounds(const SkRect& cullRect, const SkRecord&,
-                        SkRect bounds[], SkBBoxHierarchy::Metadata[]);
+                        SkRect bounds[], SkBBoxHierarchy::Metadata[], bool findOccluded = false);
 
 // Draw an SkRecord into an SkCanvas.  A convenience wrapper around SkRecords::Draw.
 void SkRecordDraw(const SkRecord&, SkCanvas*, SkPicture const* const drawablePicts[],
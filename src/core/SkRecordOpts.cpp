@@ -10,16 +10,26 @@
 #include "include/core/SkBlendMode.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
+#include "include/core/SkM44.h"
+#include "include/core/SkMatrix.h"
 #include "include/core/SkPaint.h"
+#include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkSamplingOptions.h"
+#include "include/core/SkShader.h"
+#include "include/core/SkTextBlob.h"
 #include "include/private/base/SkMath.h"
 #include "include/private/base/SkTemplates.h"
 #include "src/core/SkRecord.h"
 #include "src/core/SkRecordPattern.h"
 #include "src/core/SkRecords.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <new>
 #include <optional>
+#include <utility>
+#include <vector>
 
 using namespace SkRecords;
 
@@ -141,6 +151,55 @@ void SkRecordNoopSaveRestores(SkRecord* record) {
     while (apply(&onlyDraws, record) || apply(&noDraws, record));
 }
 
+// Matches any command that changes the matrix.
+using IsMatrixChange = Or<Is<SetMatrix>, Is<SetM44>, Is<Translate>, Is<Scale>, Is<Concat>,
+                          Is<Concat44>>;
+
+// Matches matrix changes that leave the matrix as it was.  SkCanvas doesn't pass identity
+// translates, scales or 3x3 concats on to SkRecorder, but it does pass on identity 4x4 concats.
+struct IsIdentityMatrixChange {
+    bool operator()(Translate* op) { return op->dx == 0 && op->dy == 0; }
+    bool operator()(Scale*     op) { return op->sx == 1 && op->sy == 1; }
+    bool operator()(Concat*    op) { return op->matrix.isIdentity(); }
+    bool operator()(Concat44*  op) { return op->matrix == SkM44(); }
+
+    template <typename T>
+    bool operator()(T*) { return false; }
+};
+
+// Turns matrix changes that do nothing into NoOps.
+struct IdentityMatrixNooper {
+    typedef Pattern<IsIdentityMatrixChange> Match;
+
+    bool onMatch(SkRecord* record, Match*, int begin, int end) {
+        record->replace<NoOp>(begin);
+        return true;
+    }
+};
+
+// Turns a matrix change into a NoOp when the matrix is set again (or restored) before any command
+// could see it.
+struct OverwrittenMatrixNooper {
+    typedef Pattern<IsMatrixChange,
+                    Greedy<Is<NoOp>>,
+                    Or<Is<SetMatrix>, Is<SetM44>, Is<Restore>>>
+        Match;
+
+    bool onMatch(SkRecord* record, Match*, int begin, int end) {
+        record->replace<NoOp>(begin);
+        return true;
+    }
+};
+
+void SkRecordNoopRedundantMatrices(SkRecord* record) {
+    IdentityMatrixNooper identity;
+    OverwrittenMatrixNooper overwritten;
+
+    apply(&identity, record);
+    // A match ends on the command that overwrites the matrix, which may itself be overwritten.
+    while (apply(&overwritten, record));
+}
+
 #ifndef SK_BUILD_FOR_ANDROID_FRAMEWORK
 static bool effectively_srcover(const SkPaint* paint) {
     if (!paint || paint->isSrcOver()) {
@@ -204,6 +263,169 @@ void SkRecordNoopSaveLayerDrawRestores(SkRecord* record) {
 }
 #endif
 
+// Whether a draw with this paint replaces every pixel its geometry covers with an opaque color.
+static bool paints_opaque_fill(const SkPaint& paint) {
+    if (paint.getAlpha() != 0xFF ||
+        paint.getStyle() != SkPaint::kFill_Style ||
+        (paint.getShader() && !paint.getShader()->isOpaque()) ||
+        paint.getColorFilter() ||
+        paint.getMaskFilter()  ||
+        paint.getPathEffect()  ||
+        paint.getImageFilter()) {
+        return false;
+    }
+    std::optional<SkBlendMode> mode = paint.asBlendMode();
+    return mode == SkBlendMode::kSrcOver || mode == SkBlendMode::kSrc;
+}
+
+// Walks the record tracking the matrix and the clip, and turns draws into NoOps when a later
+// opaque DrawRect or DrawPaint covers them.  Only draws separated by nothing but other draws and
+// matrix changes are compared, so that they share a clip.
+//
+// A non-AA rect covers exactly the pixels whose centers it contains, so it only hides non-AA
+// draws within it; anti-aliased draws can partially cover pixels just outside it.  Neither hides
+// anything inside an anti-aliased (or shader) clip, where each draw only partially covers the
+// pixels along the clip's edges.  Bounds are compared in the record's coordinates, which
+// preserves containment under whatever matrix the record is played back with.
+class OccludedDrawNooper {
+public:
+    explicit OccludedDrawNooper(SkRecord* record) : fRecord(record) {}
+
+    void run() {
+        for (fIndex = 0; fIndex < fRecord->count(); fIndex++) {
+            fRecord->mutate(fIndex, *this);
+        }
+    }
+
+    void operator()(NoOp*) {}
+
+    void operator()(Save*)       { this->save(); }
+    void operator()(SaveLayer*)  { this->save(); }
+    void operator()(SaveBehind*) { this->save(); }
+    void operator()(Restore* op) {
+        if (!fSavedStates.empty()) {
+            fState = fSavedStates.back();
+            fSavedStates.pop_back();
+        }
+        fState.fMatrix = op->matrix;
+        fDraws.clear();
+    }
+
+    void operator()(SetMatrix* op) { fState.fMatrix = op->matrix; }
+    void operator()(SetM44*    op) { fState.fMatrix = op->matrix.asM33(); }
+    void operator()(Translate* op) { fState.fMatrix.preTranslate(op->dx, op->dy); }
+    void operator()(Scale*     op) { fState.fMatrix.preScale(op->sx, op->sy); }
+    void operator()(Concat*    op) { fState.fMatrix.preConcat(op->matrix); }
+    void operator()(Concat44*  op) { fState.fMatrix.preConcat(op->matrix.asM33()); }
+
+    void operator()(ClipPath*   op) { this->clip(op->opAA.aa()); }
+    void operator()(ClipRRect*  op) { this->clip(op->opAA.aa()); }
+    void operator()(ClipRect*   op) { this->clip(op->opAA.aa()); }
+    void operator()(ClipShader*)    { this->clip(true); }
+
+    void operator()(DrawPaint* op) {
+        if (!fState.fPartialClip && paints_opaque_fill(op->paint)) {
+            for (const Draw& draw : fDraws) {
+                fRecord->replace<NoOp>(draw.fIndex);
+            }
+            fDraws.clear();
+        }
+    }
+
+    void operator()(DrawRect* op) {
+        const SkRect rect = op->rect.makeSorted();
+        if (!fState.fPartialClip && !op->paint.isAntiAlias() &&
+            fState.fMatrix.rectStaysRect() && paints_opaque_fill(op->paint)) {
+            const SkRect covered = fState.fMatrix.mapRect(rect);
+            fDraws.erase(std::remove_if(fDraws.begin(), fDraws.end(), [&](const Draw& draw) {
+                if (draw.fAntiAlias || !covered.contains(draw.fBounds)) {
+                    return false;
+                }
+                fRecord->replace<NoOp>(draw.fIndex);
+                return true;
+            }), fDraws.end());
+        }
+        this->draw(&op->paint, rect);
+    }
+    void operator()(DrawRRect* op) { this->draw(&op->paint, op->rrect.getBounds()); }
+    void operator()(DrawOval*  op) { this->draw(&op->paint, op->oval.makeSorted()); }
+    void operator()(DrawPath*  op) {
+        if (!op->path.isInverseFillType()) {
+            this->draw(&op->paint, op->path.getBounds());
+        }
+    }
+    void operator()(DrawImage* op) {
+        this->draw(op->paint, SkRect::MakeXYWH(op->left, op->top,
+                                               op->image->width(), op->image->height()));
+    }
+    void operator()(DrawImageRect* op) { this->draw(op->paint, op->dst.makeSorted()); }
+    void operator()(DrawTextBlob* op) {
+        // Glyphs are anti-aliased no matter what the paint says.
+        this->draw(&op->paint, op->blob->bounds().makeOffset(op->x, op->y), true);
+    }
+
+    // Any other draw leaves everything as it was; any other command might change the clip.
+    template <typename T>
+    void operator()(T*) {
+        if (!(T::kTags & kDraw_Tag)) {
+            fDraws.clear();
+        }
+    }
+
+private:
+    struct State {
+        SkMatrix fMatrix;
+        bool fPartialClip = false;
+    };
+    struct Draw {
+        int fIndex;
+        SkRect fBounds;  // In the record's coordinates.
+        bool fAntiAlias;
+    };
+    // Limits the work per opaque rect in long runs of draws.
+    static constexpr size_t kMaxDraws = 32;
+
+    void save() {
+        fSavedStates.push_back(fState);
+        fDraws.clear();
+    }
+
+    void clip(bool partial) {
+        fState.fPartialClip |= partial;
+        fDraws.clear();
+    }
+
+    void draw(const SkPaint* paint, const SkRect& bounds, bool antiAlias = false) {
+        if (fState.fMatrix.hasPerspective()) {
+            return;
+        }
+        SkRect drawBounds = bounds;
+        if (paint) {
+            if (paint->getImageFilter() || !paint->canComputeFastBounds()) {
+                return;
+            }
+            drawBounds = paint->computeFastBounds(bounds, &drawBounds);
+            antiAlias |= paint->isAntiAlias();
+        }
+        if (fDraws.size() == kMaxDraws) {
+            fDraws.erase(fDraws.begin());
+        }
+        fDraws.push_back({fIndex, fState.fMatrix.mapRect(drawBounds), antiAlias});
+    }
+
+    SkRecord* fRecord;
+    int fIndex = 0;
+    State fState;
+    std::vector<State> fSavedStates;
+    // Draws since the clip last changed that a later opaque draw might cover.
+    std::vector<Draw> fDraws;
+};
+
+void SkRecordNoopOccludedDraws(SkRecord* record) {
+    OccludedDrawNooper pass(record);
+    pass.run();
+}
+
 /* For SVG generated:
   SaveLayer (non-opaque, typically for CSS opacity)
     Save
@@ -264,6 +486,100 @@ void SkRecordMergeSvgOpacityAndFilterLayers(SkRecord* record) {
     apply(&pass, record);
 }
 
+// Whether DrawImageRects with this paint draw the same when batched into a DrawEdgeAAImageSet.
+// SkDevice::drawEdgeAAImageSet() draws the entries one at a time, but GPU devices batch them, so
+// stick to src-over and avoid effects that would apply to the whole set at once.
+static bool mergeable_image_paint(const SkPaint* paint) {
+    return !paint || (paint->isSrcOver() && !paint->getMaskFilter() && !paint->getImageFilter());
+}
+
+static bool same_paints(const SkPaint* a, const SkPaint* b) {
+    return a == b || (a && b && *a == *b);
+}
+
+// Merges runs of DrawImageRects (ignoring NoOps) into DrawEdgeAAImageSets.  Playback can no
+// longer skip the individual draws, so only draws that tile a compact area (like the tiles of a
+// large image) are merged.
+struct DrawImageRectMerger {
+    typedef Pattern<Is<DrawImageRect>, Greedy<Or<Is<NoOp>, Is<DrawImageRect>>>> Match;
+
+    static constexpr int kMaxEntries = 64;
+
+    bool onMatch(SkRecord* record, Match*, int begin, int end) {
+        bool changed = false;
+        DrawImageRect* first = nullptr;
+        SkRect bounds = SkRect::MakeEmpty();
+        double area = 0;
+        std::vector<int> group;
+        for (int i = begin; i < end; i++) {
+            DrawImageRect* op = AsDrawImageRect(record, i);
+            if (!op) {
+                continue;
+            }
+            const SkRect dst = op->dst.makeSorted();
+            SkRect joined = bounds;
+            joined.join(dst);
+            const double joinedArea = area + (double)dst.width() * dst.height();
+            if (!first ||
+                !same_paints(first->paint, op->paint) ||
+                first->sampling != op->sampling ||
+                first->constraint != op->constraint ||
+                (int)group.size() == kMaxEntries ||
+                (double)joined.width() * joined.height() > 2 * joinedArea) {
+                changed |= Merge(record, group);
+                group.clear();
+                first = mergeable_image_paint(op->paint) ? op : nullptr;
+                bounds = dst;
+                area = (double)dst.width() * dst.height();
+            } else {
+                bounds = joined;
+                area = joinedArea;
+            }
+            if (first) {
+                group.push_back(i);
+            }
+        }
+        return Merge(record, group) || changed;
+    }
+
+    static DrawImageRect* AsDrawImageRect(SkRecord* record, int i) {
+        Is<DrawImageRect> is;
+        record->mutate(i, is);
+        return is.get();
+    }
+
+    static bool Merge(SkRecord* record, const std::vector<int>& group) {
+        const int count = (int)group.size();
+        if (count < 2) {
+            return false;
+        }
+        DrawImageRect* first = AsDrawImageRect(record, group[0]);
+        SkPaint* paint = first->paint ? new (record->alloc<SkPaint>()) SkPaint(*first->paint)
+                                      : nullptr;
+        const unsigned aaFlags = paint && paint->isAntiAlias() ? SkCanvas::kAll_QuadAAFlags
+                                                               : SkCanvas::kNone_QuadAAFlags;
+        const SkSamplingOptions sampling = first->sampling;
+        const SkCanvas::SrcRectConstraint constraint = first->constraint;
+
+        skia_private::AutoTArray<SkCanvas::ImageSetEntry> set(count);
+        for (int i = 0; i < count; i++) {
+            DrawImageRect* op = AsDrawImageRect(record, group[i]);
+            set[i] = SkCanvas::ImageSetEntry(std::move(op->image), op->src, op->dst, 1.f, aaFlags);
+            if (i > 0) {
+                record->replace<NoOp>(group[i]);
+            }
+        }
+        new (record->replace<DrawEdgeAAImageSet>(group[0])) DrawEdgeAAImageSet{
+                paint, std::move(set), count, nullptr, nullptr, sampling, constraint};
+        return true;
+    }
+};
+
+void SkRecordMergeDrawImageRects(SkRecord* record) {
+    DrawImageRectMerger pass;
+    apply(&pass, record);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
 void SkRecordOptimize(SkRecord* record) {
@@ -276,6 +592,8 @@ void SkRecordOptimize(SkRecord* record) {
     //     https://bugs.chromium.org/p/skia/issues/detail?id=5548
 //    SkRecordNoopSaveRestores(record);
 
+    SkRecordNoopRedundantMatrices(record);
+
     // Turn off this optimization completely for Android framework
     // because it makes the following Android CTS test fail:
     // android.uirendering.cts.testclasses.LayerTests#testSaveLayerClippedWithAlpha
@@ -283,6 +601,8 @@ void SkRecordOptimize(SkRecord* record) {
     SkRecordNoopSaveLayerDrawRestores(record);
 #endif
     SkRecordMergeSvgOpacityAndFilterLayers(record);
+    // Last, as the merged draws no longer match the single draws the passes above look for.
+    SkRecordMergeDrawImageRects(record);
 
     record->defrag();
 }
@@ -22,6 +22,20 @@ void SkRecordNoopSaveRestores(SkRecord*);
 void SkRecordNoopSaveLayerDrawRestores(SkRecord*);
 #endif
 
+// No-ops matrix changes that are overwritten (by a SetMatrix, SetM44 or Restore) before anything
+// uses them, and matrix changes that are the identity.
+void SkRecordNoopRedundantMatrices(SkRecord*);
+
+// No-ops draws that a later opaque DrawRect or DrawPaint, under the same clip, covers completely.
+// This only considers clips made within the record: a draw at the edge of an anti-aliased clip
+// applied by the caller at playback shows through slightly less than it would have. Not part of
+// SkRecordOptimize(); SkPictureRecorder::setDropOccludedDraws() opts in to it.
+void SkRecordNoopOccludedDraws(SkRecord*);
+
+// Merges runs of DrawImageRects that share a paint, sampling and constraint, and that cover a
+// compact area, into single DrawEdgeAAImageSets.
+void SkRecordMergeDrawImageRects(SkRecord*);
+
 // For SVG generated SaveLayer-Save-ClipRect-SaveLayer-3xRestore patterns, merge
 // the alpha of the first SaveLayer to the second SaveLayer.
 void SkRecordMergeSvgOpacityAndFilterLayers(SkRecord*);
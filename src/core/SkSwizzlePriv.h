@@ -31,6 +31,15 @@ namespace SkOpts {
                            grayA_to_RGBA,   // i.e. expand to color channels
                            grayA_to_rgbA;   // i.e. expand to color channels and premultiply
 
+    // Like the above, but only reads every sampleX'th source pixel. sampleX must be 2, 4 or 8.
+    using Swizzle_8888_sampled = void (*)(uint32_t*, const uint8_t*, int count, int sampleX);
+    extern Swizzle_8888_sampled RGBA_to_BGRA_sampled,
+                                RGBA_to_rgbA_sampled,
+                                RGBA_to_bgrA_sampled,
+                                RGB_to_RGB1_sampled,
+                                RGB_to_BGR1_sampled,
+                                gray_to_RGB1_sampled;
+
     void Init_Swizzler();
 }  // namespace SkOpts
 
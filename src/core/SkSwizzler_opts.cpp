@@ -30,6 +30,12 @@ namespace SkOpts {
     DEFINE_DEFAULT(grayA_to_rgbA);
     DEFINE_DEFAULT(inverted_CMYK_to_RGB1);
     DEFINE_DEFAULT(inverted_CMYK_to_BGR1);
+    DEFINE_DEFAULT(RGBA_to_BGRA_sampled);
+    DEFINE_DEFAULT(RGBA_to_rgbA_sampled);
+    DEFINE_DEFAULT(RGBA_to_bgrA_sampled);
+    DEFINE_DEFAULT(RGB_to_RGB1_sampled);
+    DEFINE_DEFAULT(RGB_to_BGR1_sampled);
+    DEFINE_DEFAULT(gray_to_RGB1_sampled);
 
     void Init_Swizzler_ssse3();
     void Init_Swizzler_hsw();
@@ -36,6 +36,12 @@ namespace SkOpts {
         grayA_to_rgbA         = hsw::grayA_to_rgbA;
         inverted_CMYK_to_RGB1 = hsw::inverted_CMYK_to_RGB1;
         inverted_CMYK_to_BGR1 = hsw::inverted_CMYK_to_BGR1;
+        RGBA_to_BGRA_sampled  = hsw::RGBA_to_BGRA_sampled;
+        RGBA_to_rgbA_sampled  = hsw::RGBA_to_rgbA_sampled;
+        RGBA_to_bgrA_sampled  = hsw::RGBA_to_bgrA_sampled;
+        RGB_to_RGB1_sampled   = hsw::RGB_to_RGB1_sampled;
+        RGB_to_BGR1_sampled   = hsw::RGB_to_BGR1_sampled;
+        gray_to_RGB1_sampled  = hsw::gray_to_RGB1_sampled;
     }
 }  // namespace SkOpts
 
@@ -38,6 +38,12 @@ namespace SkOpts {
         grayA_to_rgbA         = ssse3::grayA_to_rgbA;
         inverted_CMYK_to_RGB1 = ssse3::inverted_CMYK_to_RGB1;
         inverted_CMYK_to_BGR1 = ssse3::inverted_CMYK_to_BGR1;
+        RGBA_to_BGRA_sampled  = ssse3::RGBA_to_BGRA_sampled;
+        RGBA_to_rgbA_sampled  = ssse3::RGBA_to_rgbA_sampled;
+        RGBA_to_bgrA_sampled  = ssse3::RGBA_to_bgrA_sampled;
+        RGB_to_RGB1_sampled   = ssse3::RGB_to_RGB1_sampled;
+        RGB_to_BGR1_sampled   = ssse3::RGB_to_BGR1_sampled;
+        gray_to_RGB1_sampled  = ssse3::gray_to_RGB1_sampled;
     }
 }  // namespace SkOpts
 
@@ -21,6 +21,7 @@
 #include "src/core/SkMatrixPriv.h"
 #include "src/core/SkMipmap.h"
 #include "src/core/SkPaintPriv.h"
+#include "src/core/SkPathPriv.h"
 #include "src/core/SkPtrRecorder.h"
 #include "src/image/SkImage_Base.h"
 
@@ -143,7 +144,14 @@ void SkBinaryWriteBuffer::writeSampling(const SkSamplingOptions& sampling) {
 }
 
 void SkBinaryWriteBuffer::writePath(const SkPath& path) {
-    fWriter.writePath(path);
+    const int precisionBits = fProcs.fPathPrecisionBits;
+    if (precisionBits <= 0) {
+        fWriter.writePath(path);
+        return;
+    }
+    sk_sp<SkData> data = SkPathPriv::Serialize(path, precisionBits);
+    SkASSERT(SkAlign4(data->size()) == data->size());
+    fWriter.write(data->data(), data->size());
 }
 
 size_t SkBinaryWriteBuffer::writeStream(SkStream* stream, size_t length) {
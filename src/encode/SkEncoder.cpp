@@ -7,14 +7,30 @@
 
 #include "include/encode/SkEncoder.h"
 
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkRect.h"
 #include "include/private/base/SkAssert.h"
 
+#include <algorithm>
+#include <memory>
+#include <utility>
+
 bool SkEncoder::encodeRows(int numRows) {
     SkASSERT(numRows > 0 && fCurrRow < fSrc.height());
     if (numRows <= 0 || fCurrRow >= fSrc.height()) {
         return false;
     }
 
+    // An encoder made without pixels only takes rows through encodeRows(const SkPixmap&).
+    if (!fRows && !fSrc.addr()) {
+        return false;
+    }
+
     if (fCurrRow + numRows > fSrc.height()) {
         numRows = fSrc.height() - fCurrRow;
     }
@@ -27,3 +43,55 @@ bool SkEncoder::encodeRows(int numRows) {
 
     return true;
 }
+
+bool SkEncoder::encodeRows(const SkPixmap& rows) {
+    if (!rows.addr() || rows.height() <= 0 || rows.width() != fSrc.width() ||
+        rows.colorType() != fSrc.colorType() || rows.alphaType() != fSrc.alphaType()) {
+        return false;
+    }
+
+    fRows = &rows;
+    fRowsTop = fCurrRow;
+    bool success = this->encodeRows(rows.height());
+    fRows = nullptr;
+    return success;
+}
+
+bool SkEncoder::encodeBands(int bandHeight, const FillRowsProc& fillRows) {
+    SkASSERT(bandHeight > 0);
+    if (bandHeight <= 0 || !fillRows || fCurrRow >= fSrc.height()) {
+        return false;
+    }
+
+    SkBitmap band;
+    bandHeight = std::min(bandHeight, fSrc.height() - fCurrRow);
+    if (!band.tryAllocPixels(fSrc.info().makeWH(fSrc.width(), bandHeight))) {
+        return false;
+    }
+
+    while (fCurrRow < fSrc.height()) {
+        SkPixmap rows;
+        const int numRows = std::min(bandHeight, fSrc.height() - fCurrRow);
+        SkAssertResult(band.pixmap().extractSubset(&rows, SkIRect::MakeWH(fSrc.width(), numRows)));
+        if (!fillRows(fCurrRow, rows) || !this->encodeRows(rows)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+SkEncoder::FillRowsProc SkEncoder::PictureRows(sk_sp<SkPicture> picture, const SkMatrix* matrix) {
+    return [picture = std::move(picture), matrix = matrix ? *matrix : SkMatrix::I()](
+                   int top, const SkPixmap& rows) {
+        std::unique_ptr<SkCanvas> canvas =
+                SkCanvas::MakeRasterDirect(rows.info(), rows.writable_addr(), rows.rowBytes());
+        if (!picture || !canvas) {
+            return false;
+        }
+        canvas->clear(SK_ColorTRANSPARENT);
+        canvas->translate(0, -top);
+        canvas->concat(matrix);
+        canvas->drawPicture(picture);
+        return true;
+    };
+}
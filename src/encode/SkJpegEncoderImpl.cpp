@@ -11,8 +11,10 @@
 #include "include/core/SkBitmap.h"
 #include "include/core/SkColorType.h"
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkPixmap.h"
+#include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkYUVAInfo.h"
@@ -25,16 +27,20 @@
 #include "src/base/SkMSAN.h"
 #include "src/codec/SkJpegConstants.h"
 #include "src/codec/SkJpegPriv.h"
+#include "src/core/SkImageInfoPriv.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/encode/SkImageEncoderFns.h"
 #include "src/encode/SkImageEncoderPriv.h"
 #include "src/encode/SkJPEGWriteUtility.h"
 #include "src/image/SkImage_Base.h"
 
+#include <algorithm>
 #include <csetjmp>
 #include <cstdint>
 #include <cstring>
 #include <memory>
 #include <utility>
+#include <vector>
 
 class GrDirectContext;
 class SkColorSpace;
@@ -256,11 +262,13 @@ bool SkJpegEncoderMgr::setParams(const SkYUVAPixmapInfo& srcInfo,
     return true;
 }
 
+// |restartEveryMCURow| is for the bands of a parallel encode (see encode_in_bands()).
 static std::unique_ptr<SkEncoder> Make(SkWStream* dst,
                                        const SkPixmap* src,
                                        const SkYUVAPixmaps* srcYUVA,
                                        const SkColorSpace* srcYUVAColorSpace,
-                                       const SkJpegEncoder::Options& options) {
+                                       const SkJpegEncoder::Options& options,
+                                       bool restartEveryMCURow = false) {
     // Exactly one of |src| or |srcYUVA| should be specified.
     if (srcYUVA) {
         SkASSERT(!src);
@@ -268,8 +276,10 @@ static std::unique_ptr<SkEncoder> Make(SkWStream* dst,
             return nullptr;
         }
     } else {
+        // |src| may have no pixels, in which case rows must come from
+        // encodeRows(const SkPixmap&).
         SkASSERT(src);
-        if (!src || !SkPixmapIsValid(*src)) {
+        if (!src || !SkImageInfoIsValid(src->info())) {
             return nullptr;
         }
     }
@@ -291,6 +301,12 @@ static std::unique_ptr<SkEncoder> Make(SkWStream* dst,
         }
     }
 
+    if (restartEveryMCURow) {
+        // Every band must use the same Huffman tables.
+        encoderMgr->cinfo()->optimize_coding = FALSE;
+        encoderMgr->cinfo()->restart_in_rows = 1;
+    }
+
     jpeg_set_quality(encoderMgr->cinfo(), options.fQuality, TRUE);
     jpeg_start_compress(encoderMgr->cinfo(), TRUE);
 
@@ -350,6 +366,10 @@ bool SkJpegEncoderImpl::onEncodeRows(int numRows) {
     }
 
     if (fSrcYUVA) {
+        // The planes can only come from the SkYUVAPixmaps the encoder was made with.
+        if (fRows) {
+            return false;
+        }
         // TODO(ccameron): Consider using jpeg_write_raw_data, to avoid having to re-pack the data.
         for (int i = 0; i < numRows; i++) {
             yuva_copy_row(fSrcYUVA, fCurrRow + i, fStorage.get());
@@ -359,8 +379,8 @@ bool SkJpegEncoderImpl::onEncodeRows(int numRows) {
     } else {
         const size_t srcBytes = SkColorTypeBytesPerPixel(fSrc.colorType()) * fSrc.width();
         const size_t jpegSrcBytes = fEncoderMgr->cinfo()->input_components * fSrc.width();
-        const void* srcRow = fSrc.addr(0, fCurrRow);
         for (int i = 0; i < numRows; i++) {
+            const void* srcRow = this->srcRow(fCurrRow + i);
             JSAMPLE* jpegSrcRow = (JSAMPLE*)(const_cast<void*>(srcRow));
             if (fEncoderMgr->proc()) {
                 sk_msan_assert_initialized(srcRow, SkTAddOffset<const void>(srcRow, srcBytes));
@@ -379,7 +399,6 @@ bool SkJpegEncoderImpl::onEncodeRows(int numRows) {
             }
 
             jpeg_write_scanlines(fEncoderMgr->cinfo(), &jpegSrcRow, 1);
-            srcRow = SkTAddOffset<const void>(srcRow, fSrc.rowBytes());
         }
     }
 
@@ -391,9 +410,140 @@ bool SkJpegEncoderImpl::onEncodeRows(int numRows) {
     return true;
 }
 
+// Parallel encoding: each band of rows is compressed as a JPEG of its own, with a restart marker
+// after every MCU row. The entropy-coded data of a band then starts from the state that a restart
+// leaves behind (byte aligned, DC predictions reset), so the bands' data can be joined with restart
+// markers, behind the headers of the first band.
+namespace {
+
+constexpr int kBandPixels = 128 * 1024;
+
+// The height of a row of MCUs for |info| and |options|, or 0 if they cannot be encoded.
+int mcu_height(const SkImageInfo& info, const SkJpegEncoder::Options& options) {
+    std::unique_ptr<SkJpegEncoderMgr> encoderMgr = SkJpegEncoderMgr::Make(nullptr);
+    skjpeg_error_mgr::AutoPushJmpBuf jmp(encoderMgr->errorMgr());
+    if (setjmp(jmp) || !encoderMgr->setParams(info, options)) {
+        return 0;
+    }
+
+    int maxVSampFactor = 1;
+    for (int i = 0; i < encoderMgr->cinfo()->num_components; i++) {
+        maxVSampFactor = std::max(maxVSampFactor, encoderMgr->cinfo()->comp_info[i].v_samp_factor);
+    }
+    return maxVSampFactor * DCTSIZE;
+}
+
+// Where the height is stored in the frame header, and where the entropy-coded data starts, in a
+// JPEG written by libjpeg-turbo.
+struct JpegLayout {
+    size_t fHeightOffset = 0;
+    size_t fScanOffset = 0;
+    size_t fScanEnd = 0;
+};
+
+bool parse_layout(const SkData& jpeg, JpegLayout* layout) {
+    const uint8_t* data = jpeg.bytes();
+    const size_t size = jpeg.size();
+    if (size < 4 || data[0] != 0xFF || data[1] != kJpegMarkerStartOfImage ||
+        data[size - 2] != 0xFF || data[size - 1] != kJpegMarkerEndOfImage) {
+        return false;
+    }
+
+    for (size_t offset = 2; offset + 4 <= size;) {
+        if (data[offset] != 0xFF) {
+            return false;
+        }
+        const uint8_t marker = data[offset + 1];
+        const size_t end = offset + 2 + ((data[offset + 2] << 8) | data[offset + 3]);
+        if (end > size - 2) {
+            return false;
+        }
+        if (marker == kJpegMarkerStartOfFrameBaseline) {
+            // After the length, the frame header has the sample precision, and then the height.
+            layout->fHeightOffset = offset + 5;
+        } else if (marker == kJpegMarkerStartOfScan) {
+            layout->fScanOffset = end;
+            layout->fScanEnd = size - 2;
+            return layout->fHeightOffset != 0;
+        }
+        offset = end;
+    }
+    return false;
+}
+
+bool encode_in_bands(SkWStream* dst, const SkPixmap& src, const SkJpegEncoder::Options& options) {
+    // Within each band, restart markers are numbered from zero. Bands that are a multiple of eight
+    // MCU rows number them just as the whole image would.
+    const int mcuHeight = mcu_height(src.info(), options);
+    const int bandAlignment = 8 * mcuHeight;
+    int rowsPerBand = std::max(1, kBandPixels / src.width());
+    rowsPerBand = std::max(1, rowsPerBand / std::max(1, bandAlignment)) * bandAlignment;
+    if (mcuHeight == 0 || src.height() <= rowsPerBand || src.height() > JPEG_MAX_DIMENSION) {
+        auto encoder = SkJpegEncoder::Make(dst, src, options);
+        return encoder && encoder->encodeRows(src.height());
+    }
+
+    const int numBands = (src.height() + rowsPerBand - 1) / rowsPerBand;
+    std::vector<sk_sp<SkData>> bands(numBands);
+    SkTaskGroup tasks(*options.fExecutor);
+    tasks.batch(numBands, [&](int i) {
+        const int top = i * rowsPerBand;
+        SkPixmap band;
+        if (!src.extractSubset(&band, SkIRect::MakeLTRB(0, top, src.width(),
+                                                        std::min(src.height(),
+                                                                 top + rowsPerBand)))) {
+            return;
+        }
+        SkDynamicMemoryWStream stream;
+        auto encoder = Make(&stream, &band, nullptr, nullptr, options, true);
+        if (encoder && encoder->encodeRows(band.height())) {
+            bands[i] = stream.detachAsData();
+        }
+    });
+    tasks.wait();
+
+    std::vector<JpegLayout> layouts(numBands);
+    for (int i = 0; i < numBands; i++) {
+        if (!bands[i] || !parse_layout(*bands[i], &layouts[i])) {
+            return false;
+        }
+    }
+
+    // The headers of the first band, for the height of the whole image.
+    const uint8_t* first = bands[0]->bytes();
+    const size_t heightOffset = layouts[0].fHeightOffset;
+    const uint8_t height[2] = {(uint8_t)(src.height() >> 8), (uint8_t)src.height()};
+    if (!dst->write(first, heightOffset) || !dst->write(height, sizeof(height)) ||
+        !dst->write(first + heightOffset + 2, layouts[0].fScanOffset - heightOffset - 2)) {
+        return false;
+    }
+
+    const int mcuRowsPerBand = rowsPerBand / mcuHeight;
+    for (int i = 0; i < numBands; i++) {
+        if (i > 0) {
+            const uint8_t restart[2] = {0xFF, (uint8_t)(kJpegMarkerRestart0 +
+                                                        (i * mcuRowsPerBand - 1) % 8)};
+            if (!dst->write(restart, sizeof(restart))) {
+                return false;
+            }
+        }
+        if (!dst->write(bands[i]->bytes() + layouts[i].fScanOffset,
+                        layouts[i].fScanEnd - layouts[i].fScanOffset)) {
+            return false;
+        }
+    }
+    const uint8_t endOfImage[2] = {0xFF, kJpegMarkerEndOfImage};
+    return dst->write(endOfImage, sizeof(endOfImage));
+}
+
+}  // namespace
+
 namespace SkJpegEncoder {
 
 bool Encode(SkWStream* dst, const SkPixmap& src, const Options& options) {
+    if (options.fExecutor && SkPixmapIsValid(src)) {
+        return encode_in_bands(dst, src, options);
+    }
     auto encoder = Make(dst, src, options);
     return encoder.get() && encoder->encodeRows(src.height());
 }
@@ -422,6 +572,9 @@ sk_sp<SkData> Encode(GrDirectContext* ctx, const SkImage* img, const Options& op
 }
 
 std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkPixmap& src, const Options& options) {
+    if (!SkPixmapIsValid(src)) {
+        return nullptr;
+    }
     return Make(dst, &src, nullptr, nullptr, options);
 }
 
@@ -432,4 +585,9 @@ std::unique_ptr<SkEncoder> Make(SkWStream* dst,
     return Make(dst, nullptr, &src, srcColorSpace, options);
 }
 
+std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkImageInfo& info, const Options& options) {
+    SkPixmap src(info, nullptr, info.minRowBytes());
+    return Make(dst, &src, nullptr, nullptr, options);
+}
+
 }  // namespace SkJpegEncoder
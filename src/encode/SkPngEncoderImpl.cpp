@@ -13,6 +13,7 @@
 #include "include/core/SkColorType.h"
 #include "include/core/SkData.h"
 #include "include/core/SkDataTable.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkPixmap.h"
 #include "include/core/SkRefCnt.h"
@@ -26,7 +27,10 @@
 #include "include/private/base/SkTemplates.h"
 #include "modules/skcms/skcms.h"
 #include "src/base/SkMSAN.h"
+#include "src/base/SkVx.h"
 #include "src/codec/SkPngPriv.h"
+#include "src/core/SkImageInfoPriv.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/encode/SkImageEncoderFns.h"
 #include "src/encode/SkImageEncoderPriv.h"
 #include "src/image/SkImage_Base.h"
@@ -34,6 +38,7 @@
 #include <algorithm>
 #include <csetjmp>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <memory>
 #include <utility>
@@ -42,6 +47,8 @@
 #include <png.h>
 #include <pngconf.h>
 
+#include "zlib.h"  // NO_G3_REWRITE
+
 class GrDirectContext;
 class SkImage;
 
@@ -81,10 +88,17 @@ public:
     bool setColorSpace(const SkImageInfo& info, const SkPngEncoder::Options& options);
     bool writeInfo(const SkImageInfo& srcInfo);
     void chooseProc(const SkImageInfo& srcInfo);
+    // Selects run-length compression, and one filter for the whole image, which is chosen by
+    // chooseFastFilter() once the first rows are available. Call after chooseProc().
+    bool useFastProfile();
+    bool chooseFastFilter(const SkPixmap& sample);
 
     png_structp pngPtr() { return fPngPtr; }
     png_infop infoPtr() { return fInfoPtr; }
     int pngBytesPerPixel() const { return fPngBytesPerPixel; }
+    int filters() const { return fFilters; }
+    int zlibLevel() const { return fZLibLevel; }
+    int zlibStrategy() const { return fZLibStrategy; }
     transform_scanline_proc proc() const { return fProc; }
 
     ~SkPngEncoderMgr() { png_destroy_write_struct(&fPngPtr, &fInfoPtr); }
@@ -95,6 +109,10 @@ private:
     png_structp fPngPtr;
     png_infop fInfoPtr;
     int fPngBytesPerPixel;
+    int fFilters;
+    int fZLibLevel;
+    int fZLibStrategy;
+    bool fChooseFastFilter = false;
     transform_scanline_proc fProc;
 };
 
@@ -220,10 +238,14 @@ bool SkPngEncoderMgr::setHeader(const SkImageInfo& srcInfo, const SkPngEncoder::
     int filters = (int)options.fFilterFlags & (int)SkPngEncoder::FilterFlag::kAll;
     SkASSERT(filters == (int)options.fFilterFlags);
     png_set_filter(fPngPtr, PNG_FILTER_TYPE_BASE, filters);
+    fFilters = filters;
+    // libpng's choice of strategy, unless the fast profile overrides it.
+    fZLibStrategy = (filters & ~PNG_FILTER_NONE) ? Z_FILTERED : Z_DEFAULT_STRATEGY;
 
     int zlibLevel = std::min(std::max(0, options.fZLibLevel), 9);
     SkASSERT(zlibLevel == options.fZLibLevel);
     png_set_compression_level(fPngPtr, zlibLevel);
+    fZLibLevel = zlibLevel;
 
     // Set comments in tEXt chunk
     const sk_sp<SkDataTable>& comments = options.fComments;
@@ -444,8 +466,12 @@ bool SkPngEncoderImpl::onEncodeRows(int numRows) {
         return false;
     }
 
-    const void* srcRow = fSrc.addr(0, fCurrRow);
+    if (fCurrRow == 0 && !fEncoderMgr->chooseFastFilter(fRows ? *fRows : fSrc)) {
+        return false;
+    }
+
     for (int y = 0; y < numRows; y++) {
+        const void* srcRow = this->srcRow(fCurrRow + y);
         sk_msan_assert_initialized(srcRow,
                                    (const uint8_t*)srcRow + (fSrc.width() << fSrc.shiftPerPixel()));
         fEncoderMgr->proc()((char*)fStorage.get(),
@@ -455,7 +481,6 @@ bool SkPngEncoderImpl::onEncodeRows(int numRows) {
 
         png_bytep rowPtr = (png_bytep)fStorage.get();
         png_write_rows(fEncoderMgr->pngPtr(), &rowPtr, 1);
-        srcRow = SkTAddOffset<const void>(srcRow, fSrc.rowBytes());
     }
 
     fCurrRow += numRows;
@@ -466,9 +491,398 @@ bool SkPngEncoderImpl::onEncodeRows(int numRows) {
     return true;
 }
 
-namespace SkPngEncoder {
-std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkPixmap& src, const Options& options) {
-    if (!SkPixmapIsValid(src)) {
+// Banded encoding: libpng writes the chunks that come before and after the image data, and the
+// IDAT chunks are assembled here from bands of rows that are filtered and deflated independently
+// (in parallel, given an executor). Every band but the last ends with a sync flush, which
+// byte-aligns the deflate stream, so the compressed bands can simply be concatenated. The adler32
+// checksums of the bands are combined for the zlib trailer.
+namespace {
+
+// Roughly how many bytes of filtered rows go into each band.
+constexpr size_t kBandBytes = 256 * 1024;
+
+// The filter types, as stored in the first byte of each filtered row.
+enum PngFilterType : uint8_t {
+    kNone_PngFilterType  = 0,
+    kSub_PngFilterType   = 1,
+    kUp_PngFilterType    = 2,
+    kAvg_PngFilterType   = 3,
+    kPaeth_PngFilterType = 4,
+};
+
+constexpr int kFilterFlagFor[] = {PNG_FILTER_NONE, PNG_FILTER_SUB, PNG_FILTER_UP, PNG_FILTER_AVG,
+                                  PNG_FILTER_PAETH};
+
+using U8x16  = skvx::Vec<16, uint8_t>;
+using I16x16 = skvx::Vec<16, int16_t>;
+
+I16x16 abs16(const I16x16& x) { return skvx::max(x, -x); }
+
+// The predictors, for one pixel's bytes ('a' to the left, 'b' above, 'c' above-left).
+uint8_t avg_predictor(int a, int b) { return (a + b) >> 1; }
+
+uint8_t paeth_predictor(int a, int b, int c) {
+    int pa = std::abs(b - c), pb = std::abs(a - c), pc = std::abs(a + b - 2 * c);
+    return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+}
+
+I16x16 paeth_predictor(const I16x16& a, const I16x16& b, const I16x16& c) {
+    I16x16 pa = abs16(b - c), pb = abs16(a - c), pc = abs16(a + b - 2 * c);
+    return skvx::if_then_else((pa <= pb) & (pa <= pc), a, skvx::if_then_else(pb <= pc, b, c));
+}
+
+// Writes the filter type and then 'row' filtered against 'prev' (the previous row, or zeros for
+// the first row) to 'dst', which must hold rowBytes + 1 bytes. Encoding only reads unfiltered
+// bytes, so every filter vectorizes; the first pixel, which has no left neighbor, and the tail are
+// done a byte at a time.
+void filter_row(uint8_t* dst, PngFilterType type, const uint8_t* row, const uint8_t* prev,
+                size_t rowBytes, size_t bpp) {
+    *dst++ = type;
+    if (type == kNone_PngFilterType) {
+        memcpy(dst, row, rowBytes);
+        return;
+    }
+    if (type == kUp_PngFilterType) {
+        size_t i = 0;
+        for (; i + 16 <= rowBytes; i += 16) {
+            (U8x16::Load(row + i) - U8x16::Load(prev + i)).store(dst + i);
+        }
+        for (; i < rowBytes; i++) {
+            dst[i] = row[i] - prev[i];
+        }
+        return;
+    }
+
+    size_t i = 0;
+    for (; i < std::min(bpp, rowBytes); i++) {
+        switch (type) {
+            case kSub_PngFilterType:   dst[i] = row[i];                            break;
+            case kAvg_PngFilterType:   dst[i] = row[i] - avg_predictor(0, prev[i]); break;
+            case kPaeth_PngFilterType: dst[i] = row[i] - prev[i];                  break;
+            default:                   SkUNREACHABLE;
+        }
+    }
+    switch (type) {
+        case kSub_PngFilterType:
+            for (; i + 16 <= rowBytes; i += 16) {
+                (U8x16::Load(row + i) - U8x16::Load(row + i - bpp)).store(dst + i);
+            }
+            for (; i < rowBytes; i++) {
+                dst[i] = row[i] - row[i - bpp];
+            }
+            break;
+        case kAvg_PngFilterType:
+            for (; i + 16 <= rowBytes; i += 16) {
+                U8x16 a = U8x16::Load(row + i - bpp), b = U8x16::Load(prev + i);
+                // The floor of the average, without widening.
+                (U8x16::Load(row + i) - ((a & b) + ((a ^ b) >> 1))).store(dst + i);
+            }
+            for (; i < rowBytes; i++) {
+                dst[i] = row[i] - avg_predictor(row[i - bpp], prev[i]);
+            }
+            break;
+        case kPaeth_PngFilterType:
+            for (; i + 16 <= rowBytes; i += 16) {
+                I16x16 pred = paeth_predictor(skvx::cast<int16_t>(U8x16::Load(row + i - bpp)),
+                                              skvx::cast<int16_t>(U8x16::Load(prev + i)),
+                                              skvx::cast<int16_t>(U8x16::Load(prev + i - bpp)));
+                (U8x16::Load(row + i) - skvx::cast<uint8_t>(pred)).store(dst + i);
+            }
+            for (; i < rowBytes; i++) {
+                dst[i] = row[i] - paeth_predictor(row[i - bpp], prev[i], prev[i - bpp]);
+            }
+            break;
+        default:
+            SkUNREACHABLE;
+    }
+}
+
+// libpng's heuristic for choosing among several filters: the sum of the filtered bytes' magnitudes,
+// treating them as signed.
+size_t filter_cost(const uint8_t* filtered, size_t rowBytes) {
+    skvx::Vec<16, int32_t> sums(0);
+    size_t i = 0;
+    for (; i + 16 <= rowBytes; i += 16) {
+        sums += skvx::cast<int32_t>(abs16(skvx::cast<int16_t>(
+                skvx::Vec<16, int8_t>::Load(filtered + i))));
+    }
+    size_t cost = 0;
+    for (int lane = 0; lane < 16; lane++) {
+        cost += sums[lane];
+    }
+    for (; i < rowBytes; i++) {
+        cost += std::abs((int)(int8_t)filtered[i]);
+    }
+    return cost;
+}
+
+// Returns the enabled filters, in order, in 'candidates'.
+int filter_candidates(int filters, PngFilterType candidates[5]) {
+    int count = 0;
+    for (PngFilterType type : {kNone_PngFilterType, kSub_PngFilterType, kUp_PngFilterType,
+                               kAvg_PngFilterType, kPaeth_PngFilterType}) {
+        if (filters & kFilterFlagFor[type]) {
+            candidates[count++] = type;
+        }
+    }
+    if (count == 0) {
+        candidates[count++] = kNone_PngFilterType;
+    }
+    return count;
+}
+
+// For the fast profile: picks the one enabled filter that does best, by the heuristic above, over
+// a sample of rows.
+int choose_image_filter(const SkPixmap& src, transform_scanline_proc proc, size_t rowBytes,
+                        size_t bpp, int filters) {
+    PngFilterType candidates[5];
+    const int numCandidates = filter_candidates(filters, candidates);
+    if (numCandidates == 1) {
+        return kFilterFlagFor[candidates[0]];
+    }
+
+    constexpr int kSampleRows = 16;
+    const int srcBytesPerPixel = SkColorTypeBytesPerPixel(src.colorType());
+    skia_private::AutoTMalloc<uint8_t> storage(3 * rowBytes + 1);
+    uint8_t* prev = storage.get();
+    uint8_t* curr = prev + rowBytes;
+    uint8_t* filtered = curr + rowBytes;
+
+    size_t costs[5] = {};
+    const int step = std::max(1, src.height() / kSampleRows);
+    for (int y = step / 2; y < src.height(); y += step) {
+        if (y == 0) {
+            memset(prev, 0, rowBytes);
+        } else {
+            proc((char*)prev, (const char*)src.addr(0, y - 1), src.width(), srcBytesPerPixel);
+        }
+        proc((char*)curr, (const char*)src.addr(0, y), src.width(), srcBytesPerPixel);
+        for (int i = 0; i < numCandidates; i++) {
+            filter_row(filtered, candidates[i], curr, prev, rowBytes, bpp);
+            costs[i] += filter_cost(filtered + 1, rowBytes);
+        }
+    }
+    int best = 0;
+    for (int i = 1; i < numCandidates; i++) {
+        if (costs[i] < costs[best]) {
+            best = i;
+        }
+    }
+    return kFilterFlagFor[candidates[best]];
+}
+
+struct PngBand {
+    int fFirstRow;
+    int fNumRows;
+    bool fLast;
+
+    // Outputs
+    bool fSuccess = false;
+    uLong fAdler;
+    size_t fFilteredSize;
+    skia_private::AutoTMalloc<uint8_t> fCompressed;
+    size_t fCompressedSize = 0;
+};
+
+void encode_band(const SkPixmap& src, transform_scanline_proc proc, size_t pngRowBytes,
+                 size_t pngBytesPerPixel, int filters, int zlibLevel, int zlibStrategy,
+                 PngBand* band) {
+    const int srcBytesPerPixel = SkColorTypeBytesPerPixel(src.colorType());
+    PngFilterType candidates[5];
+    const int numCandidates = filter_candidates(filters, candidates);
+
+    // The unfiltered previous and current rows, and a row to try each candidate filter in.
+    skia_private::AutoTMalloc<uint8_t> storage(2 * pngRowBytes + (pngRowBytes + 1));
+    uint8_t* prev = storage.get();
+    uint8_t* curr = prev + pngRowBytes;
+    uint8_t* trial = curr + pngRowBytes;
+
+    // The first row is filtered against the last row of the previous band.
+    if (band->fFirstRow == 0) {
+        memset(prev, 0, pngRowBytes);
+    } else {
+        proc((char*)prev, (const char*)src.addr(0, band->fFirstRow - 1), src.width(),
+             srcBytesPerPixel);
+    }
+
+    band->fFilteredSize = band->fNumRows * (pngRowBytes + 1);
+    skia_private::AutoTMalloc<uint8_t> filtered(band->fFilteredSize);
+    uint8_t* dst = filtered.get();
+    for (int y = band->fFirstRow; y < band->fFirstRow + band->fNumRows; y++) {
+        const void* srcRow = src.addr(0, y);
+        sk_msan_assert_initialized(srcRow,
+                                   (const uint8_t*)srcRow + (src.width() << src.shiftPerPixel()));
+        proc((char*)curr, (const char*)srcRow, src.width(), srcBytesPerPixel);
+
+        filter_row(dst, candidates[0], curr, prev, pngRowBytes, pngBytesPerPixel);
+        if (numCandidates > 1) {
+            size_t bestCost = filter_cost(dst + 1, pngRowBytes);
+            for (int i = 1; i < numCandidates; i++) {
+                filter_row(trial, candidates[i], curr, prev, pngRowBytes, pngBytesPerPixel);
+                size_t cost = filter_cost(trial + 1, pngRowBytes);
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    memcpy(dst, trial, pngRowBytes + 1);
+                }
+            }
+        }
+
+        dst += pngRowBytes + 1;
+        std::swap(prev, curr);
+    }
+
+    band->fAdler = adler32(adler32(0L, Z_NULL, 0), filtered.get(), band->fFilteredSize);
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream, zlibLevel, Z_DEFLATED, -MAX_WBITS, 8, zlibStrategy) != Z_OK) {
+        return;
+    }
+
+    // deflateBound() does not account for the (at most five byte) empty block of a sync flush.
+    const size_t bound = deflateBound(&stream, band->fFilteredSize) + 16;
+    band->fCompressed.reset(bound);
+    stream.next_in = filtered.get();
+    stream.avail_in = (uInt)band->fFilteredSize;
+    stream.next_out = band->fCompressed.get();
+    stream.avail_out = (uInt)bound;
+
+    const int result = deflate(&stream, band->fLast ? Z_FINISH : Z_SYNC_FLUSH);
+    band->fSuccess = stream.avail_in == 0 &&
+                     (band->fLast ? result == Z_STREAM_END : result == Z_OK && stream.avail_out);
+    band->fCompressedSize = bound - stream.avail_out;
+    deflateEnd(&stream);
+}
+
+void write_be32(uint8_t* dst, uint32_t value) {
+    dst[0] = (uint8_t)(value >> 24);
+    dst[1] = (uint8_t)(value >> 16);
+    dst[2] = (uint8_t)(value >>  8);
+    dst[3] = (uint8_t)(value      );
+}
+
+// Writes one band as an IDAT chunk, with the zlib header before the first band and the trailer
+// after the last. Also writes the IEND chunk after the last band.
+bool write_band(png_structp pngPtr, const PngBand& band, bool first, int zlibLevel,
+                uLong* adler) {
+    // The zlib header: deflate with a 32K window, the compression level as zlib reports it, and a
+    // check value that makes the header a multiple of 31.
+    uint8_t header[2] = {0x78, 0};
+    header[1] = (zlibLevel < 2 ? 0 : zlibLevel < 6 ? 1 : zlibLevel == 6 ? 2 : 3) << 6;
+    header[1] += 31 - ((header[0] << 8) + header[1]) % 31;
+
+    *adler = adler32_combine(*adler, band.fAdler, (z_off_t)band.fFilteredSize);
+    uint8_t trailer[4];
+    write_be32(trailer, (uint32_t)*adler);
+
+    if (setjmp(png_jmpbuf(pngPtr))) {
+        return false;
+    }
+    static constexpr png_byte kIDAT[5] = {'I', 'D', 'A', 'T', '\0'};
+    static constexpr png_byte kIEND[5] = {'I', 'E', 'N', 'D', '\0'};
+    png_write_chunk_start(pngPtr, kIDAT, (first ? sizeof(header) : 0) + band.fCompressedSize +
+                                         (band.fLast ? sizeof(trailer) : 0));
+    if (first) {
+        png_write_chunk_data(pngPtr, header, sizeof(header));
+    }
+    png_write_chunk_data(pngPtr, band.fCompressed.get(), band.fCompressedSize);
+    if (band.fLast) {
+        png_write_chunk_data(pngPtr, trailer, sizeof(trailer));
+    }
+    png_write_chunk_end(pngPtr);
+    if (band.fLast) {
+        png_write_chunk(pngPtr, kIEND, nullptr, 0);
+    }
+    return true;
+}
+
+}  // namespace
+
+bool SkPngEncoderMgr::useFastProfile() {
+    if (setjmp(png_jmpbuf(fPngPtr))) {
+        return false;
+    }
+
+    fChooseFastFilter = fProc != nullptr;
+    fZLibStrategy = Z_RLE;
+    png_set_compression_strategy(fPngPtr, fZLibStrategy);
+    return true;
+}
+
+bool SkPngEncoderMgr::chooseFastFilter(const SkPixmap& sample) {
+    if (!fChooseFastFilter) {
+        return true;
+    }
+    if (setjmp(png_jmpbuf(fPngPtr))) {
+        return false;
+    }
+
+    fChooseFastFilter = false;
+    const size_t rowBytes = fPngBytesPerPixel * (size_t)sample.width();
+    fFilters = choose_image_filter(sample, fProc, rowBytes, fPngBytesPerPixel, fFilters);
+    png_set_filter(fPngPtr, PNG_FILTER_TYPE_BASE, fFilters);
+    return true;
+}
+
+bool SkPngEncoderImpl::encodeInBands(SkExecutor* executor) {
+    SkASSERT(fCurrRow == 0);
+    png_structp pngPtr = fEncoderMgr->pngPtr();
+    transform_scanline_proc proc = fEncoderMgr->proc();
+    const size_t pngBytesPerPixel = fEncoderMgr->pngBytesPerPixel();
+    const size_t pngRowBytes = pngBytesPerPixel * fSrc.width();
+
+    // libpng transforms the rows it is given when a filler is set (opaque F16); leave that to it.
+    if (!proc || png_get_rowbytes(pngPtr, fEncoderMgr->infoPtr()) != pngRowBytes ||
+        pngRowBytes + 1 > 0xFFFFFFFF) {
+        return this->encodeRows(fSrc.height());
+    }
+    if (!fEncoderMgr->chooseFastFilter(fSrc)) {
+        return false;
+    }
+
+    const int rowsPerBand = (int)std::max<size_t>(1, kBandBytes / (pngRowBytes + 1));
+    const int numBands = (fSrc.height() + rowsPerBand - 1) / rowsPerBand;
+    std::vector<PngBand> bands(numBands);
+    for (int i = 0; i < numBands; i++) {
+        bands[i].fFirstRow = i * rowsPerBand;
+        bands[i].fNumRows = std::min(rowsPerBand, fSrc.height() - bands[i].fFirstRow);
+        bands[i].fLast = i == numBands - 1;
+    }
+
+    const int filters = fEncoderMgr->filters();
+    const int zlibLevel = fEncoderMgr->zlibLevel();
+    const int zlibStrategy = fEncoderMgr->zlibStrategy();
+    auto encode = [&](int i) {
+        encode_band(fSrc, proc, pngRowBytes, pngBytesPerPixel, filters, zlibLevel, zlibStrategy,
+                    &bands[i]);
+    };
+    if (executor) {
+        SkTaskGroup tasks(*executor);
+        tasks.batch(numBands, encode);
+        tasks.wait();
+    }
+
+    uLong adler = adler32(0L, Z_NULL, 0);
+    for (int i = 0; i < numBands; i++) {
+        // Without an executor, each band is written (and freed) as soon as it is encoded.
+        if (!executor) {
+            encode(i);
+        }
+        if (!bands[i].fSuccess || !write_band(pngPtr, bands[i], i == 0, zlibLevel, &adler)) {
+            return false;
+        }
+        bands[i].fCompressed.reset(0);
+    }
+
+    fCurrRow = fSrc.height();
+    return true;
+}
+
+// |src| may have no pixels, in which case rows must come from encodeRows(const SkPixmap&).
+static std::unique_ptr<SkPngEncoderImpl> make_encoder(SkWStream* dst,
+                                                      const SkPixmap& src,
+                                                      const SkPngEncoder::Options& options) {
+    if (!SkImageInfoIsValid(src.info())) {
         return nullptr;
     }
 
@@ -491,12 +905,37 @@ std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkPixmap& src, const Optio
 
     encoderMgr->chooseProc(src.info());
 
+    if (options.fProfile == SkPngEncoder::Profile::kFast && !encoderMgr->useFastProfile()) {
+        return nullptr;
+    }
+
     return std::make_unique<SkPngEncoderImpl>(std::move(encoderMgr), src);
 }
 
+namespace SkPngEncoder {
+std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkPixmap& src, const Options& options) {
+    if (!SkPixmapIsValid(src)) {
+        return nullptr;
+    }
+    return make_encoder(dst, src, options);
+}
+
+std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkImageInfo& info, const Options& options) {
+    return make_encoder(dst, SkPixmap(info, nullptr, info.minRowBytes()), options);
+}
+
 bool Encode(SkWStream* dst, const SkPixmap& src, const Options& options) {
-    auto encoder = Make(dst, src, options);
-    return encoder.get() && encoder->encodeRows(src.height());
+    if (!SkPixmapIsValid(src)) {
+        return false;
+    }
+    auto encoder = make_encoder(dst, src, options);
+    if (!encoder) {
+        return false;
+    }
+    if (options.fExecutor || options.fProfile == Profile::kFast) {
+        return encoder->encodeInBands(options.fExecutor);
+    }
+    return encoder->encodeRows(src.height());
 }
 
 sk_sp<SkData> Encode(GrDirectContext* ctx, const SkImage* img, const Options& options) {
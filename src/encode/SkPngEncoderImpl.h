@@ -12,6 +12,7 @@
 
 #include <memory>
 
+class SkExecutor;
 class SkPixmap;
 class SkPngEncoderMgr;
 
@@ -22,6 +23,11 @@ public:
     SkPngEncoderImpl(std::unique_ptr<SkPngEncoderMgr>, const SkPixmap& src);
     ~SkPngEncoderImpl() override;
 
+    // Encodes all of the rows, filtering and compressing bands of them without libpng, on the
+    // executor's threads if there is one. Falls back to encodeRows() when libpng needs to
+    // transform the rows.
+    bool encodeInBands(SkExecutor* executor);
+
 protected:
     bool onEncodeRows(int numRows) override;
     std::unique_ptr<SkPngEncoderMgr> fEncoderMgr;
@@ -10,12 +10,16 @@
 #include "include/core/SkBitmap.h"
 #include "include/core/SkColorSpace.h"
 #include "include/core/SkData.h"
+#include "include/core/SkDecodedImageCache.h"
+#include "include/core/SkGraphics.h"
 #include "include/core/SkImageGenerator.h"
 #include "include/core/SkPixmap.h"
 #include "include/core/SkSize.h"
+#include "include/core/SkStream.h"
 #include "include/core/SkYUVAInfo.h"
 #include "src/core/SkBitmapCache.h"
 #include "src/core/SkCachedData.h"
+#include "src/core/SkMD5.h"
 #include "src/core/SkNextID.h"
 #include "src/core/SkResourceCache.h"
 #include "src/core/SkYUVPlanesCache.h"
@@ -104,6 +108,35 @@ SkImage_Lazy::SkImage_Lazy(Validator* validator)
     SkASSERT(fSharedGenerator);
 }
 
+sk_sp<SkData> SkImage_Lazy::decodedImageCacheKey() const {
+    fDecodedImageCacheKeyOnce([this] {
+        sk_sp<SkData> encoded = ScopedGenerator(fSharedGenerator)->refEncodedData();
+        if (!encoded) {
+            return;
+        }
+        SkMD5 md5;
+        md5.write(encoded->data(), encoded->size());
+        const SkMD5::Digest digest = md5.finish();
+
+        // Unique IDs are not stable across processes, so key on the encoded content and on
+        // everything about our SkImageInfo that affects the decoded pixels.
+        const SkImageInfo& info = this->imageInfo();
+        SkDynamicMemoryWStream key;
+        key.write("SkImage_Lazy:v1", 16);
+        key.write(digest.data, sizeof(digest.data));
+        key.write32(info.width());
+        key.write32(info.height());
+        key.write32(info.colorType());
+        key.write32(info.alphaType());
+        if (SkColorSpace* cs = info.colorSpace()) {
+            sk_sp<SkData> csData = cs->serialize();
+            key.write(csData->data(), csData->size());
+        }
+        fDecodedImageCacheKey = key.detachAsData();
+    });
+    return fDecodedImageCacheKey;
+}
+
 bool SkImage_Lazy::getROPixels(GrDirectContext* ctx, SkBitmap* bitmap,
                                SkImage::CachingHint chint) const {
     auto check_output_bitmap = [bitmap]() {
@@ -118,21 +151,57 @@ bool SkImage_Lazy::getROPixels(GrDirectContext* ctx, SkBitmap* bitmap,
         return true;
     }
 
+    // Before decoding, look for the pixels in the client's second-tier cache (if any).
+    const SkImageInfo& info = this->imageInfo();
+    sk_sp<SkDecodedImageCache> decodedCache = SkGraphics::GetDecodedImageCache();
+    sk_sp<SkData> decodedKey = decodedCache ? this->decodedImageCacheKey() : nullptr;
+    sk_sp<SkData> decoded = decodedKey ? decodedCache->load(*decodedKey) : nullptr;
+    if (decoded && decoded->size() != info.computeMinByteSize()) {
+        decoded = nullptr;
+    }
+    auto store_decoded = [&](const SkPixmap& pmap) {
+        if (!decodedKey) {
+            return;
+        }
+        if (pmap.rowBytes() == info.minRowBytes()) {
+            decodedCache->store(*decodedKey,
+                                *SkData::MakeWithoutCopy(pmap.addr(), pmap.computeByteSize()));
+        } else {
+            sk_sp<SkData> tight = SkData::MakeUninitialized(info.computeMinByteSize());
+            if (pmap.readPixels(info, tight->writable_data(), info.minRowBytes())) {
+                decodedCache->store(*decodedKey, *tight);
+            }
+        }
+    };
+
     if (SkImage::kAllow_CachingHint == chint) {
         SkPixmap pmap;
         SkBitmapCache::RecPtr cacheRec = SkBitmapCache::Alloc(desc, this->imageInfo(), &pmap);
         if (!cacheRec) {
             return false;
         }
-        bool success = false;
-        {   // make sure ScopedGenerator goes out of scope before we try readPixelsProxy
-            success = ScopedGenerator(fSharedGenerator)->getPixels(pmap);
-        }
-        if (!success && !this->readPixelsProxy(ctx, pmap)) {
-            return false;
+        // If the cached pixels can't be copied, decode as if they weren't there.
+        bool success = decoded &&
+                       SkPixmap(info, decoded->data(), info.minRowBytes()).readPixels(pmap);
+        if (!success) {
+            {   // make sure ScopedGenerator goes out of scope before we try readPixelsProxy
+                success = ScopedGenerator(fSharedGenerator)->getPixels(pmap);
+            }
+            if (!success && !this->readPixelsProxy(ctx, pmap)) {
+                return false;
+            }
+            store_decoded(pmap);
         }
         SkBitmapCache::Add(std::move(cacheRec), bitmap);
         this->notifyAddedToRasterCache();
+    } else if (decoded) {
+        // The data is typically memory-mapped, so wrap it rather than copying it.
+        auto release = [](void*, void* data) { static_cast<SkData*>(data)->unref(); };
+        void* pixels = const_cast<void*>(decoded->data());
+        if (!bitmap->installPixels(info, pixels, info.minRowBytes(), release, decoded.release())) {
+            return false;
+        }
+        bitmap->setImmutable();
     } else {
         if (!bitmap->tryAllocPixels(this->imageInfo())) {
             return false;
@@ -144,6 +213,7 @@ bool SkImage_Lazy::getROPixels(GrDirectContext* ctx, SkBitmap* bitmap,
         if (!success && !this->readPixelsProxy(ctx, bitmap->pixmap())) {
             return false;
         }
+        store_decoded(bitmap->pixmap());
         bitmap->setImmutable();
     }
     check_output_bitmap();
@@ -17,6 +17,7 @@
 #include "include/core/SkYUVAPixmaps.h"
 #include "include/private/SkIDChangeListener.h"
 #include "include/private/base/SkMutex.h"
+#include "include/private/base/SkOnce.h"
 #include "src/image/SkImage_Base.h"
 
 #include <cstddef>
@@ -90,6 +91,10 @@ private:
 
     class ScopedGenerator;
 
+    // Returns the key for this image's pixels in the SkDecodedImageCache, or null if the
+    // generator has no encoded data to derive a stable key from.
+    sk_sp<SkData> decodedImageCacheKey() const;
+
     // Note that this->imageInfo() is not necessarily the info from the generator. It may be
     // cropped by onMakeSubset and its color type/space may be changed by
     // onMakeColorTypeAndColorSpace.
@@ -99,6 +104,9 @@ private:
     // and SkImage_Lazy instances. Cache the result of the last successful call.
     mutable SkMutex        fOnMakeColorTypeAndSpaceMutex;
     mutable sk_sp<SkImage> fOnMakeColorTypeAndSpaceResult;
+    // Hashing the encoded data is not free, so compute the decoded image cache key once.
+    mutable SkOnce         fDecodedImageCacheKeyOnce;
+    mutable sk_sp<SkData>  fDecodedImageCacheKey;
     // When the SkImage_Lazy goes away, we will iterate over all the listeners to inform them
     // of the unique ID's demise. This is used to remove cached textures from GrContext.
     mutable SkIDChangeListener::List fUniqueIDListeners;
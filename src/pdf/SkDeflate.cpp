@@ -8,13 +8,18 @@
 #include "src/pdf/SkDeflate.h"
 
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
 #include "include/private/base/SkMalloc.h"
+#include "include/private/base/SkSemaphore.h"
 #include "include/private/base/SkTo.h"
 #include "src/core/SkTraceEvent.h"
 
 #include "zlib.h"  // NO_G3_REWRITE
 
 #include <algorithm>
+#include <atomic>
+#include <deque>
+#include <vector>
 
 namespace {
 
@@ -28,45 +33,209 @@ void skia_free_func(void*, void* address) { sk_free(address); }
 
 }  // namespace
 
-#define SKDEFLATEWSTREAM_INPUT_BUFFER_SIZE 4096
-#define SKDEFLATEWSTREAM_OUTPUT_BUFFER_SIZE 4224  // 4096 + 128, usually big
-                                                  // enough to always do a
-                                                  // single loop.
+#define SKDEFLATEWSTREAM_INPUT_BUFFER_SIZE 65536
+#define SKDEFLATEWSTREAM_OUTPUT_BUFFER_SIZE 66048  // 65536 + 512, usually big
+                                                   // enough to always do a
+                                                   // single loop.
+
+// zlib's largest window is 32KB (windowBits 15); the extra hash and match memory of
+// MAX_MEM_LEVEL is what the larger profiles need to find matches in it.
+static constexpr int kWindowBits = 15;
+static constexpr int kMemLevel = 9;
+
+// The most blocks that may be waiting to be written at once; bounds the memory a parallel
+// stream holds to about this many kParallelBlockSize inputs and outputs.
+static constexpr size_t kMaxPendingBlocks = 4;
+
+static int profile_level(SkDeflateWStream::Profile profile) {
+    switch (profile) {
+        case SkDeflateWStream::Profile::kFast:    return 1;
+        case SkDeflateWStream::Profile::kDefault: return 6;
+        case SkDeflateWStream::Profile::kMax:     return 9;
+    }
+    SkUNREACHABLE;
+}
+
+static void init_zstream(z_stream* zStream, int compressionLevel, int windowBits) {
+    zStream->next_in = nullptr;
+    zStream->zalloc = &skia_alloc_func;
+    zStream->zfree = &skia_free_func;
+    zStream->opaque = nullptr;
+    SkDEBUGCODE(int r =) deflateInit2(zStream, compressionLevel, Z_DEFLATED, windowBits,
+                                      kMemLevel, Z_DEFAULT_STRATEGY);
+    SkASSERT(Z_OK == r);
+}
 
 // called by both write() and finalize()
 static void do_deflate(int flush,
                        z_stream* zStream,
                        SkWStream* out,
-                       unsigned char* inBuffer,
-                       size_t inBufferSize) {
-    zStream->next_in = inBuffer;
-    zStream->avail_in = SkToInt(inBufferSize);
-    unsigned char outBuffer[SKDEFLATEWSTREAM_OUTPUT_BUFFER_SIZE];
+                       const unsigned char* inBuffer,
+                       size_t inBufferSize,
+                       unsigned char* outBuffer,
+                       size_t outBufferSize) {
+    zStream->next_in = const_cast<unsigned char*>(inBuffer);
+    zStream->avail_in = SkToUInt(inBufferSize);
     SkDEBUGCODE(int returnValue;)
     do {
         zStream->next_out = outBuffer;
-        zStream->avail_out = sizeof(outBuffer);
+        zStream->avail_out = SkToUInt(outBufferSize);
         SkDEBUGCODE(returnValue =) deflate(zStream, flush);
         SkASSERT(!zStream->msg);
 
-        out->write(outBuffer, sizeof(outBuffer) - zStream->avail_out);
+        out->write(outBuffer, outBufferSize - zStream->avail_out);
     } while (zStream->avail_in || !zStream->avail_out);
     SkASSERT(flush == Z_FINISH
                  ? returnValue == Z_STREAM_END
                  : returnValue == Z_OK);
 }
 
+namespace {
+
+// One kParallelBlockSize piece of a parallel stream, deflated on its own as raw deflate data
+// that ends on a byte boundary (a full flush), or with the final block if it is the last.
+struct Block {
+    std::vector<unsigned char> fInput;
+    SkDynamicMemoryWStream     fOutput;
+    size_t                     fInputSize = 0;
+    uLong                      fCheck = 0;  // adler32 or crc32 of fInput.
+    bool                       fLast = false;
+    bool                       fGzip = false;
+    int                        fLevel = Z_DEFAULT_COMPRESSION;
+    std::atomic<bool>          fClaimed{false};
+    SkSemaphore                fDone;
+
+    // Whichever of the executor's thread and the writing thread claims the block first
+    // compresses it.
+    bool claim() { return !fClaimed.exchange(true, std::memory_order_acq_rel); }
+
+    void compress() {
+        TRACE_EVENT0("skia", TRACE_FUNC);
+        const unsigned char* data = fInput.data();
+        uInt size = SkToUInt(fInputSize);
+        fCheck = fGzip ? crc32(crc32(0, nullptr, 0), data, size)
+                       : adler32(adler32(0, nullptr, 0), data, size);
+        z_stream zStream;
+        init_zstream(&zStream, fLevel, -kWindowBits);
+        std::unique_ptr<unsigned char[]> outBuffer(
+                new unsigned char[SKDEFLATEWSTREAM_OUTPUT_BUFFER_SIZE]);
+        do_deflate(fLast ? Z_FINISH : Z_FULL_FLUSH, &zStream, &fOutput, data, size,
+                   outBuffer.get(), SKDEFLATEWSTREAM_OUTPUT_BUFFER_SIZE);
+        (void)deflateEnd(&zStream);
+        fInput = std::vector<unsigned char>();
+    }
+};
+
+}  // namespace
+
+static void write_be32(SkWStream* out, uint32_t v) {
+    const uint8_t bytes[4] = {(uint8_t)(v >> 24), (uint8_t)(v >> 16),
+                              (uint8_t)(v >> 8), (uint8_t)v};
+    out->write(bytes, sizeof(bytes));
+}
+
+static void write_le32(SkWStream* out, uint32_t v) {
+    const uint8_t bytes[4] = {(uint8_t)v, (uint8_t)(v >> 8),
+                              (uint8_t)(v >> 16), (uint8_t)(v >> 24)};
+    out->write(bytes, sizeof(bytes));
+}
+
+// The header deflateInit2() would have written for this level and format. See RFC 1950 and
+// RFC 1952.
+static void write_header(SkWStream* out, int level, bool gzip) {
+    if (gzip) {
+        // Magic, deflate, no flags, no modification time, extra flags, unknown OS.
+        const uint8_t xfl = level == 9 ? 2 : level == 1 ? 4 : 0;
+        const uint8_t header[10] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, xfl, 0xff};
+        out->write(header, sizeof(header));
+        return;
+    }
+    const uint8_t cmf = 0x78;  // deflate, 32KB window.
+    const uint8_t flevel = level == Z_DEFAULT_COMPRESSION ? 2
+                         : level < 2                      ? 0
+                         : level < 6                      ? 1
+                         : level == 6                     ? 2
+                                                          : 3;
+    uint8_t flg = flevel << 6;
+    flg += 31 - (cmf * 256 + flg) % 31;
+    const uint8_t header[2] = {cmf, flg};
+    out->write(header, sizeof(header));
+}
+
 // Hide all zlib impl details.
 struct SkDeflateWStream::Impl {
     SkWStream* fOut;
     unsigned char fInBuffer[SKDEFLATEWSTREAM_INPUT_BUFFER_SIZE];
+    unsigned char fOutBuffer[SKDEFLATEWSTREAM_OUTPUT_BUFFER_SIZE];
     size_t fInBufferIndex;
+    size_t fTotalIn;
+    int fLevel;
+    bool fGzip;
     z_stream fZStream;
+
+    // Only used when compressing in parallel.
+    SkExecutor* fExecutor;
+    std::vector<unsigned char> fBlockInput;
+    std::deque<std::shared_ptr<Block>> fPendingBlocks;
+    uLong fCheck;
+    bool fStartedBlocks;
+
+    void startBlock(bool last) {
+        if (!fStartedBlocks) {
+            write_header(fOut, fLevel, fGzip);
+            fCheck = fGzip ? crc32(0, nullptr, 0) : adler32(0, nullptr, 0);
+            fStartedBlocks = true;
+        }
+        auto block = std::make_shared<Block>();
+        block->fInput = std::move(fBlockInput);
+        block->fInputSize = block->fInput.size();
+        block->fLast = last;
+        block->fGzip = fGzip;
+        block->fLevel = fLevel;
+        fBlockInput = std::vector<unsigned char>();
+        if (last) {
+            // Nothing is left to overlap with the last block, so compress it here.
+            block->fClaimed = true;
+            block->compress();
+            block->fDone.signal();
+        } else {
+            fExecutor->add([block]() {
+                if (block->claim()) {
+                    block->compress();
+                    block->fDone.signal();
+                }
+            });
+        }
+        fPendingBlocks.push_back(std::move(block));
+        while (fPendingBlocks.size() > (last ? 0 : kMaxPendingBlocks)) {
+            this->finishBlock();
+        }
+    }
+
+    void finishBlock() {
+        std::shared_ptr<Block> block = std::move(fPendingBlocks.front());
+        fPendingBlocks.pop_front();
+        if (block->claim()) {
+            block->compress();
+        } else {
+            block->fDone.wait();
+        }
+        fCheck = fGzip ? crc32_combine(fCheck, block->fCheck, block->fInputSize)
+                       : adler32_combine(fCheck, block->fCheck, block->fInputSize);
+        block->fOutput.writeToAndReset(fOut);
+    }
 };
 
+SkDeflateWStream::SkDeflateWStream(SkWStream* out,
+                                   Profile profile,
+                                   bool gzip,
+                                   SkExecutor* executor)
+    : SkDeflateWStream(out, profile_level(profile), gzip, executor) {}
+
 SkDeflateWStream::SkDeflateWStream(SkWStream* out,
                                    int compressionLevel,
-                                   bool gzip)
+                                   bool gzip,
+                                   SkExecutor* executor)
     : fImpl(std::make_unique<SkDeflateWStream::Impl>()) {
 
     // There has existed at some point at least one zlib implementation which thought it was being
@@ -74,21 +243,21 @@ SkDeflateWStream::SkDeflateWStream(SkWStream* out,
     // for the no-compression level which should always be deterministically pass-through.
     // Users should instead consider the zero compression level broken and handle it themselves.
     SkASSERT(compressionLevel != 0);
+    SkASSERT(compressionLevel <= 9 && compressionLevel >= -1);
 
     fImpl->fOut = out;
     fImpl->fInBufferIndex = 0;
-    if (!fImpl->fOut) {
+    fImpl->fTotalIn = 0;
+    fImpl->fLevel = compressionLevel;
+    fImpl->fGzip = gzip;
+    fImpl->fExecutor = executor;
+    fImpl->fCheck = 0;
+    fImpl->fStartedBlocks = false;
+    if (!fImpl->fOut || fImpl->fExecutor) {
+        // A parallel stream only needs fZStream if it turns out to be shorter than one block.
         return;
     }
-    fImpl->fZStream.next_in = nullptr;
-    fImpl->fZStream.zalloc = &skia_alloc_func;
-    fImpl->fZStream.zfree = &skia_free_func;
-    fImpl->fZStream.opaque = nullptr;
-    SkASSERT(compressionLevel <= 9 && compressionLevel >= -1);
-    SkDEBUGCODE(int r =) deflateInit2(&fImpl->fZStream, compressionLevel,
-                                      Z_DEFLATED, gzip ? 0x1F : 0x0F,
-                                      8, Z_DEFAULT_STRATEGY);
-    SkASSERT(Z_OK == r);
+    init_zstream(&fImpl->fZStream, compressionLevel, gzip ? kWindowBits + 16 : kWindowBits);
 }
 
 SkDeflateWStream::~SkDeflateWStream() { this->finalize(); }
@@ -98,9 +267,28 @@ void SkDeflateWStream::finalize() {
     if (!fImpl->fOut) {
         return;
     }
-    do_deflate(Z_FINISH, &fImpl->fZStream, fImpl->fOut, fImpl->fInBuffer,
-               fImpl->fInBufferIndex);
-    (void)deflateEnd(&fImpl->fZStream);
+    if (fImpl->fExecutor && fImpl->fStartedBlocks) {
+        fImpl->startBlock(/*last=*/true);
+        if (fImpl->fGzip) {
+            write_le32(fImpl->fOut, SkToU32(fImpl->fCheck));
+            write_le32(fImpl->fOut, SkToU32(fImpl->fTotalIn & 0xFFFFFFFF));
+        } else {
+            write_be32(fImpl->fOut, SkToU32(fImpl->fCheck));
+        }
+    } else {
+        const unsigned char* input = fImpl->fInBuffer;
+        size_t inputSize = fImpl->fInBufferIndex;
+        if (fImpl->fExecutor) {
+            // Too short to split; compress it as one ordinary stream.
+            init_zstream(&fImpl->fZStream, fImpl->fLevel,
+                         fImpl->fGzip ? kWindowBits + 16 : kWindowBits);
+            input = fImpl->fBlockInput.data();
+            inputSize = fImpl->fBlockInput.size();
+        }
+        do_deflate(Z_FINISH, &fImpl->fZStream, fImpl->fOut, input, inputSize,
+                   fImpl->fOutBuffer, sizeof(fImpl->fOutBuffer));
+        (void)deflateEnd(&fImpl->fZStream);
+    }
     fImpl->fOut = nullptr;
 }
 
@@ -110,6 +298,19 @@ bool SkDeflateWStream::write(const void* void_buffer, size_t len) {
         return false;
     }
     const char* buffer = (const char*)void_buffer;
+    fImpl->fTotalIn += len;
+    if (fImpl->fExecutor) {
+        while (len > 0) {
+            size_t tocopy = std::min(len, kParallelBlockSize - fImpl->fBlockInput.size());
+            fImpl->fBlockInput.insert(fImpl->fBlockInput.end(), buffer, buffer + tocopy);
+            len -= tocopy;
+            buffer += tocopy;
+            if (fImpl->fBlockInput.size() == kParallelBlockSize && len > 0) {
+                fImpl->startBlock(/*last=*/false);
+            }
+        }
+        return true;
+    }
     while (len > 0) {
         size_t tocopy =
                 std::min(len, sizeof(fImpl->fInBuffer) - fImpl->fInBufferIndex);
@@ -122,7 +323,8 @@ bool SkDeflateWStream::write(const void* void_buffer, size_t len) {
         // if the buffer isn't filled, don't call into zlib yet.
         if (sizeof(fImpl->fInBuffer) == fImpl->fInBufferIndex) {
             do_deflate(Z_NO_FLUSH, &fImpl->fZStream, fImpl->fOut,
-                       fImpl->fInBuffer, fImpl->fInBufferIndex);
+                       fImpl->fInBuffer, fImpl->fInBufferIndex,
+                       fImpl->fOutBuffer, sizeof(fImpl->fOutBuffer));
             fImpl->fInBufferIndex = 0;
         }
     }
@@ -130,5 +332,5 @@ bool SkDeflateWStream::write(const void* void_buffer, size_t len) {
 }
 
 size_t SkDeflateWStream::bytesWritten() const {
-    return fImpl->fZStream.total_in + fImpl->fInBufferIndex;
+    return fImpl->fTotalIn;
 }
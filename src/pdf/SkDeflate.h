@@ -11,6 +11,10 @@
 
 #include "include/core/SkStream.h"
 
+#include <memory>
+
+class SkExecutor;
+
 /**
   * Wrap a stream in this class to compress the information written to
   * this stream using the Deflate algorithm.
@@ -19,6 +23,13 @@
   */
 class SkDeflateWStream final : public SkWStream {
 public:
+    /** Trade-offs between speed and size, for callers that don't need a specific zlib level. */
+    enum class Profile {
+        kFast,     // zlib level 1.
+        kDefault,  // zlib's default level, 6.
+        kMax,      // zlib level 9.
+    };
+
     /** Does not take ownership of the stream.
 
         @param compressionLevel 1 is best speed; 9 is best compression.
@@ -29,10 +40,26 @@ public:
         a wrapper, documented in RFC 1952, around a deflate stream."
         gzip adds a header with a magic number to the beginning of the
         stream, allowing a client to identify a gzip file.
+
+        @param executor if set, streams longer than kParallelBlockSize are split
+        into blocks of that size, which are compressed independently on the
+        executor's threads and joined with full flushes. The output is a little
+        larger, since no block can refer back into the one before it. The
+        calling thread compresses any block no thread has started by the time
+        its output is needed, so this is safe to use from the executor's own
+        threads.
      */
     SkDeflateWStream(SkWStream*,
                      int compressionLevel,
-                     bool gzip = false);
+                     bool gzip = false,
+                     SkExecutor* executor = nullptr);
+
+    SkDeflateWStream(SkWStream*,
+                     Profile,
+                     bool gzip = false,
+                     SkExecutor* executor = nullptr);
+
+    static constexpr size_t kParallelBlockSize = 1 << 20;
 
     /** The destructor calls finalize(). */
     ~SkDeflateWStream() override;
@@ -14,6 +14,7 @@
 #include "include/core/SkData.h"
 #include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
+#include "include/core/SkPixmap.h"
 #include "include/core/SkStream.h"
 #include "include/encode/SkICC.h"
 #include "include/encode/SkJpegEncoder.h"
@@ -26,6 +27,8 @@
 #include "src/pdf/SkPDFUnion.h"
 #include "src/pdf/SkPDFUtils.h"
 
+#include <algorithm>
+#include <cstring>
 
 /*static*/ const SkEncodedInfo& SkPDFBitmap::GetEncodedInfo(SkCodec& codec) {
     return codec.getEncodedInfo();
@@ -128,7 +131,7 @@ void do_deflated_alpha(const SkPixmap& pm, SkPDFDocument* doc, SkPDFIndirectRefe
     SkWStream* stream = &buffer;
     std::optional<SkDeflateWStream> deflateWStream;
     if (format == SkPDFStreamFormat::Flate) {
-        deflateWStream.emplace(&buffer, SkToInt(compressionLevel));
+        deflateWStream.emplace(&buffer, SkToInt(compressionLevel), false, doc->executor());
         stream = &*deflateWStream;
     }
     if (kAlpha_8_SkColorType == pm.colorType()) {
@@ -205,7 +208,7 @@ void do_deflated_image(const SkPixmap& pm,
     SkWStream* stream = &buffer;
     std::optional<SkDeflateWStream> deflateWStream;
     if (format == SkPDFStreamFormat::Flate) {
-        deflateWStream.emplace(&buffer, SkToInt(compressionLevel));
+        deflateWStream.emplace(&buffer, SkToInt(compressionLevel), false, doc->executor());
         stream = &*deflateWStream;
     }
     SkPDFUnion colorSpace = SkPDFUnion::Name("DeviceGray");
@@ -396,3 +399,95 @@ SkPDFIndirectReference SkPDFSerializeImage(const SkImage* img,
     serialize_image(img, encodingQuality, doc, ref);
     return ref;
 }
+
+namespace {
+// An SkPDFImageContentKey's hash covers at most this many rows of an image's pixels, or this many
+// bytes from each end of its encoded data. Equal hashes are confirmed by comparing everything.
+constexpr int kHashedRows = 16;
+constexpr size_t kHashedEncodedBytes = 4096;
+
+uint32_t hash_encoded(const SkData& data) {
+    const size_t n = std::min(data.size(), kHashedEncodedBytes);
+    uint32_t hash = SkChecksum::Hash32(data.bytes(), n, SkToU32(data.size()));
+    return SkChecksum::Hash32(data.bytes() + data.size() - n, n, hash);
+}
+
+uint32_t hash_pixels(const SkPixmap& pm) {
+    const uint32_t header[] = {SkToU32(pm.width()), SkToU32(pm.height()),
+                               SkToU32(pm.colorType()), SkToU32(pm.alphaType())};
+    uint32_t hash = SkChecksum::Hash32(header, sizeof(header));
+    const size_t rowBytes = pm.info().minRowBytes();
+    const int step = std::max(1, pm.height() / kHashedRows);
+    for (int y = 0; y < pm.height(); y += step) {
+        hash = SkChecksum::Hash32(pm.addr(0, y), rowBytes, hash);
+    }
+    return hash;
+}
+
+bool same_pixels(const SkPixmap& a, const SkPixmap& b) {
+    if (a.info() != b.info()) {
+        return false;
+    }
+    const size_t rowBytes = a.info().minRowBytes();
+    for (int y = 0; y < a.height(); ++y) {
+        if (0 != memcmp(a.addr(0, y), b.addr(0, y), rowBytes)) {
+            return false;
+        }
+    }
+    return true;
+}
+}  // namespace
+
+bool SkPDFImageContentKey::Make(const SkImage* image,
+                                bool usePixels,
+                                SkPDFImageContentKey* key) {
+    SkASSERT(image);
+    SkASSERT(key);
+    if (sk_sp<SkData> encoded = image->refEncodedData()) {
+        key->fHash = hash_encoded(*encoded);
+        key->fEncoded = std::move(encoded);
+        key->fRaster = nullptr;
+        return true;
+    }
+    SkPixmap pixmap;
+    if (usePixels && image->peekPixels(&pixmap)) {
+        key->fHash = hash_pixels(pixmap);
+        key->fEncoded = nullptr;
+        key->fRaster = sk_ref_sp(image);
+        return true;
+    }
+    return false;
+}
+
+bool SkPDFImageContentKey::operator==(const SkPDFImageContentKey& that) const {
+    if (fHash != that.fHash) {
+        return false;
+    }
+    if (fEncoded || that.fEncoded) {
+        return fEncoded && that.fEncoded && fEncoded->equals(that.fEncoded.get());
+    }
+    SkPixmap a, b;
+    return fRaster->peekPixels(&a) && that.fRaster->peekPixels(&b) && same_pixels(a, b);
+}
+
+SkBitmapKey SkPDFCanonicalImageKey(SkPDFDocument* doc,
+                                   const SkImage* image,
+                                   const SkBitmapKey& key) {
+    SkASSERT(doc);
+    if (const SkBitmapKey* canonical = doc->fCanonicalImageKeys.find(key)) {
+        return *canonical;
+    }
+    SkBitmapKey canonical = key;
+    // An incremental document doesn't keep raster images alive just to compare their pixels.
+    const bool usePixels = !doc->metadata().fIncremental;
+    SkPDFImageContentKey content;
+    if (image && SkPDFImageContentKey::Make(image, usePixels, &content)) {
+        if (const SkBitmapKey* found = doc->fImageContentMap.find(content)) {
+            canonical = *found;
+        } else {
+            doc->fImageContentMap.set(std::move(content), key);
+        }
+    }
+    doc->fCanonicalImageKeys.set(key, canonical);
+    return canonical;
+}
@@ -8,10 +8,14 @@
 #define SkPDFBitmap_DEFINED
 
 #include "include/core/SkData.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkRefCnt.h"
 #include "src/core/SkChecksum.h"
+#include "src/pdf/SkBitmapKey.h"
+
+#include <cstdint>
 
 class SkCodec;
-class SkImage;
 class SkPDFDocument;
 struct SkEncodedInfo;
 struct SkPDFIndirectReference;
@@ -44,4 +48,34 @@ struct SkPDFIccProfileKey {
     };
 };
 
+/**
+ *  An image's contents: its encoded data if it has any, otherwise its pixels. Holds a ref on
+ *  the data or image so that later images can be compared against it.
+ */
+struct SkPDFImageContentKey {
+    sk_sp<SkData> fEncoded;
+    sk_sp<const SkImage> fRaster;
+    uint32_t fHash = 0;
+
+    /** Returns false if the image has no encoded data and its pixels can't be read without
+     *  decoding or drawing it (e.g. a lazily generated or GPU-backed image), or if
+     *  usePixels is false.
+     */
+    static bool Make(const SkImage*, bool usePixels, SkPDFImageContentKey*);
+
+    // Compares the full contents; fHash only samples them.
+    bool operator==(const SkPDFImageContentKey&) const;
+
+    struct Hash {
+        uint32_t operator()(const SkPDFImageContentKey& k) const { return k.fHash; }
+    };
+};
+
+/**
+ *  Returns the key of the first image the document saw with the same contents as this one, or
+ *  'key' if there was none. Images that draw the same pixels through different SkImages (or
+ *  different pixel refs) can then share one Image XObject.
+ */
+SkBitmapKey SkPDFCanonicalImageKey(SkPDFDocument*, const SkImage*, const SkBitmapKey& key);
+
 #endif  // SkPDFBitmap_DEFINED
@@ -660,20 +660,37 @@ void SkPDFDevice::drawSprite(const SkBitmap& bm, int x, int y, const SkPaint& pa
 ////////////////////////////////////////////////////////////////////////////////
 
 namespace {
+// Writes glyphs as text-showing operators. Glyphs on the same line are shown with a single
+// operator: a run of glyphs that follow one another by their advances is a string, and a
+// horizontal gap between two glyphs becomes a TJ kerning adjustment.
 class GlyphPositioner {
 public:
     GlyphPositioner(SkDynamicMemoryWStream* content,
                     SkScalar textSkewX,
+                    SkScalar textScale,
                     SkPoint origin)
         : fContent(content)
         , fCurrentMatrixOrigin(origin)
-        , fTextSkewX(textSkewX) {
+        , fTextSkewX(textSkewX)
+        , fTextScale(textScale) {
     }
     ~GlyphPositioner() { this->flush(); }
     void flush() {
         if (fInText) {
-            fContent->writeText("> Tj\n");
+            if (fInString) {
+                fText.writeText(">");
+            }
+            if (fAdjusted) {
+                fContent->writeText("[");
+                fText.writeToAndReset(fContent);
+                fContent->writeText("] TJ\n");
+            } else {
+                fText.writeToAndReset(fContent);
+                fContent->writeText(" Tj\n");
+            }
             fInText = false;
+            fInString = false;
+            fAdjusted = false;
         }
     }
     void setFont(SkPDFFont* pdfFont) {
@@ -701,40 +718,58 @@ public:
         }
         SkPoint position = xy - fCurrentMatrixOrigin;
         if (!fViewersAgreeOnXAdvance || position != SkPoint{fXAdvance, 0}) {
-            this->flush();
-            SkPDFUtils::AppendScalar(position.x() - position.y() * fTextSkewX, fContent);
-            fContent->writeText(" ");
-            SkPDFUtils::AppendScalar(-position.y(), fContent);
-            fContent->writeText(" Td ");
-            fCurrentMatrixOrigin = xy;
-            fXAdvance = 0;
-            fViewersAgreeOnXAdvance = true;
+            if (fInText && fViewersAgreeOnXAdvance && position.y() == 0 && fTextScale > 0) {
+                // Same line: move along it in thousandths of the (scaled) font size.
+                if (fInString) {
+                    fText.writeText(">");
+                    fInString = false;
+                }
+                fText.writeText(" ");
+                SkPDFUtils::AppendScalar((fXAdvance - position.x()) * 1000 / fTextScale, &fText);
+                fText.writeText(" ");
+                fAdjusted = true;
+                fXAdvance = position.x();
+            } else {
+                this->flush();
+                SkPDFUtils::AppendScalar(position.x() - position.y() * fTextSkewX, fContent);
+                fContent->writeText(" ");
+                SkPDFUtils::AppendScalar(-position.y(), fContent);
+                fContent->writeText(" Td ");
+                fCurrentMatrixOrigin = xy;
+                fXAdvance = 0;
+                fViewersAgreeOnXAdvance = true;
+            }
         }
         fXAdvance += advanceWidth;
         if (!fViewersAgreeOnAdvancesInFont) {
             fViewersAgreeOnXAdvance = false;
         }
-        if (!fInText) {
-            fContent->writeText("<");
+        if (!fInString) {
+            fText.writeText("<");
+            fInString = true;
             fInText = true;
         }
         if (fPDFFont->multiByteGlyphs()) {
-            SkPDFUtils::WriteUInt16BE(fContent, glyph);
+            SkPDFUtils::WriteUInt16BE(&fText, glyph);
         } else {
             SkASSERT(0 == glyph >> 8);
-            SkPDFUtils::WriteUInt8(fContent, static_cast<uint8_t>(glyph));
+            SkPDFUtils::WriteUInt8(&fText, static_cast<uint8_t>(glyph));
         }
     }
 
 private:
     SkDynamicMemoryWStream* fContent;
+    SkDynamicMemoryWStream fText;  // The operands of the current text-showing operator.
     SkPDFFont* fPDFFont = nullptr;
     SkPoint fCurrentMatrixOrigin;
     SkScalar fXAdvance = 0.0f;
     bool fViewersAgreeOnAdvancesInFont = true;
     bool fViewersAgreeOnXAdvance = true;
     SkScalar fTextSkewX;
+    SkScalar fTextScale;  // Font size times horizontal scale.
     bool fInText = false;
+    bool fInString = false;
+    bool fAdjusted = false;
     bool fInitialized = false;
 };
 }  // namespace
@@ -822,12 +857,22 @@ static bool needs_new_font(SkPDFFont* font, const SkGlyph* glyph,
 
 void SkPDFDevice::internalDrawGlyphRun(
         const sktext::GlyphRun& glyphRun, SkPoint offset, const SkPaint& runPaint) {
+    this->internalDrawGlyphRuns({&glyphRun, 1}, offset, runPaint);
+}
 
-    const SkGlyphID* glyphIDs = glyphRun.glyphsIDs().data();
-    uint32_t glyphCount = SkToU32(glyphRun.glyphsIDs().size());
-    const SkFont& glyphRunFont = glyphRun.font();
+void SkPDFDevice::internalDrawGlyphRuns(
+        SkSpan<const sktext::GlyphRun> glyphRuns, SkPoint offset, const SkPaint& runPaint) {
+    SkASSERT(!glyphRuns.empty());
+    const SkFont& glyphRunFont = glyphRuns.front().font();
 
-    if (!glyphCount || !glyphIDs || glyphRunFont.getSize() <= 0 || this->hasEmptyClip()) {
+    size_t glyphCount = 0;
+    for (const sktext::GlyphRun& glyphRun : glyphRuns) {
+        SkASSERT(glyphRun.font() == glyphRunFont);
+        if (glyphRun.glyphsIDs().data()) {
+            glyphCount += glyphRun.glyphsIDs().size();
+        }
+    }
+    if (!glyphCount || glyphRunFont.getSize() <= 0 || this->hasEmptyClip()) {
         return;
     }
     if (runPaint.getPathEffect()
@@ -836,7 +881,11 @@ void SkPDFDevice::internalDrawGlyphRun(
         || this->localToDevice().hasPerspective()
         || SkPaint::kFill_Style != runPaint.getStyle()) {
         // Stroked Text doesn't work well with Type3 fonts.
-        this->drawGlyphRunAsPath(glyphRun, offset, runPaint);
+        for (const sktext::GlyphRun& glyphRun : glyphRuns) {
+            if (!glyphRun.glyphsIDs().empty()) {
+                this->drawGlyphRunAsPath(glyphRun, offset, runPaint);
+            }
+        }
         return;
     }
     SkTypeface* typeface = glyphRunFont.getTypeface();
@@ -853,8 +902,6 @@ void SkPDFDevice::internalDrawGlyphRun(
 
     const std::vector<SkUnichar>& glyphToUnicode = SkPDFFont::GetUnicodeMap(typeface, fDocument);
 
-    SkClusterator clusterator(glyphRun);
-
     int emSize;
     SkStrikeSpec strikeSpec = SkStrikeSpec::MakePDFVector(*typeface, &emSize);
 
@@ -874,6 +921,8 @@ void SkPDFDevice::internalDrawGlyphRun(
     }
     SkDynamicMemoryWStream* out = content.stream();
 
+    // All of the runs share one text object, so the font and text matrix are only set when
+    // they change, and runs on the same line are shown by the same operator.
     out->writeText("BT\n");
     SK_AT_SCOPE_EXIT(out->writeText("ET\n"));
 
@@ -883,97 +932,117 @@ void SkPDFDevice::internalDrawGlyphRun(
     pageXform.postConcat(fDocument->currentPageTransform());
 
     ScopedOutputMarkedContentTags mark(fNodeId, {SK_ScalarNaN, SK_ScalarNaN}, fDocument, out);
-    if (!glyphRun.text().empty()) {
-        fDocument->addNodeTitle(fNodeId, glyphRun.text());
-    }
 
     const int numGlyphs = typeface->countGlyphs();
 
-    if (clusterator.reversedChars()) {
-        out->writeText("/ReversedChars BMC\n");
-    }
-    SK_AT_SCOPE_EXIT(if (clusterator.reversedChars()) { out->writeText("EMC\n"); } );
-    GlyphPositioner glyphPositioner(out, glyphRunFont.getSkewX(), offset);
+    GlyphPositioner glyphPositioner(out, glyphRunFont.getSkewX(),
+                                    textSize * glyphRunFont.getScaleX(), offset);
     SkPDFFont* font = nullptr;
 
     SkBulkGlyphMetricsAndPaths paths{strikeSpec};
-    auto glyphs = paths.glyphs(glyphRun.glyphsIDs());
 
-    while (SkClusterator::Cluster c = clusterator.next()) {
-        int index = c.fGlyphIndex;
-        int glyphLimit = index + c.fGlyphCount;
+    auto drawRun = [&](const sktext::GlyphRun& glyphRun) {
+        const SkGlyphID* glyphIDs = glyphRun.glyphsIDs().data();
+        if (glyphRun.glyphsIDs().empty() || !glyphIDs) {
+            return;
+        }
+        if (!glyphRun.text().empty()) {
+            fDocument->addNodeTitle(fNodeId, glyphRun.text());
+        }
 
-        bool actualText = false;
-        SK_AT_SCOPE_EXIT(if (actualText) {
+        SkClusterator clusterator(glyphRun);
+        if (clusterator.reversedChars()) {
+            glyphPositioner.flush();
+            out->writeText("/ReversedChars BMC\n");
+        }
+        SK_AT_SCOPE_EXIT(if (clusterator.reversedChars()) {
                              glyphPositioner.flush();
                              out->writeText("EMC\n");
                          });
-        if (c.fUtf8Text) {  // real cluster
-            // Check if `/ActualText` needed.
-            const char* textPtr = c.fUtf8Text;
-            const char* textEnd = c.fUtf8Text + c.fTextByteLength;
-            SkUnichar unichar = SkUTF::NextUTF8(&textPtr, textEnd);
-            if (unichar < 0) {
-                return;
-            }
-            if (textPtr < textEnd ||                                    // >1 code points in cluster
-                c.fGlyphCount > 1 ||                                    // >1 glyphs in cluster
-                unichar != map_glyph(glyphToUnicode, glyphIDs[index]))  // 1:1 but wrong mapping
-            {
-                glyphPositioner.flush();
-                out->writeText("/Span<</ActualText ");
-                SkPDFWriteTextString(out, c.fUtf8Text, c.fTextByteLength);
-                out->writeText(" >> BDC\n");  // begin marked-content sequence
-                                               // with an associated property list.
-                actualText = true;
-            }
-        }
-        for (; index < glyphLimit; ++index) {
-            SkGlyphID gid = glyphIDs[index];
-            if (numGlyphs <= gid) {
-                continue;
+
+        auto glyphs = paths.glyphs(glyphRun.glyphsIDs());
+
+        while (SkClusterator::Cluster c = clusterator.next()) {
+            int index = c.fGlyphIndex;
+            int glyphLimit = index + c.fGlyphCount;
+
+            bool actualText = false;
+            SK_AT_SCOPE_EXIT(if (actualText) {
+                                 glyphPositioner.flush();
+                                 out->writeText("EMC\n");
+                             });
+            if (c.fUtf8Text) {  // real cluster
+                // Check if `/ActualText` needed.
+                const char* textPtr = c.fUtf8Text;
+                const char* textEnd = c.fUtf8Text + c.fTextByteLength;
+                SkUnichar unichar = SkUTF::NextUTF8(&textPtr, textEnd);
+                if (unichar < 0) {
+                    return;
+                }
+                if (textPtr < textEnd ||                                  // >1 code points
+                    c.fGlyphCount > 1 ||                                  // >1 glyphs
+                    unichar != map_glyph(glyphToUnicode, glyphIDs[index]))  // wrong mapping
+                {
+                    glyphPositioner.flush();
+                    out->writeText("/Span<</ActualText ");
+                    SkPDFWriteTextString(out, c.fUtf8Text, c.fTextByteLength);
+                    out->writeText(" >> BDC\n");  // begin marked-content sequence
+                                                   // with an associated property list.
+                    actualText = true;
+                }
             }
-            SkPoint xy = glyphRun.positions()[index];
-            // Do a glyph-by-glyph bounds-reject if positions are absolute.
-            SkRect glyphBounds = get_glyph_bounds_device_space(
-                    glyphs[index], textScaleX, textScaleY,
-                    xy + offset, this->localToDevice());
-            if (glyphBounds.isEmpty()) {
-                if (!contains(clipStackBounds, {glyphBounds.x(), glyphBounds.y()})) {
+            for (; index < glyphLimit; ++index) {
+                SkGlyphID gid = glyphIDs[index];
+                if (numGlyphs <= gid) {
                     continue;
                 }
-            } else {
-                if (!clipStackBounds.intersects(glyphBounds)) {
-                    continue;  // reject glyphs as out of bounds
+                SkPoint xy = glyphRun.positions()[index];
+                // Do a glyph-by-glyph bounds-reject if positions are absolute.
+                SkRect glyphBounds = get_glyph_bounds_device_space(
+                        glyphs[index], textScaleX, textScaleY,
+                        xy + offset, this->localToDevice());
+                if (glyphBounds.isEmpty()) {
+                    if (!contains(clipStackBounds, {glyphBounds.x(), glyphBounds.y()})) {
+                        continue;
+                    }
+                } else {
+                    if (!clipStackBounds.intersects(glyphBounds)) {
+                        continue;  // reject glyphs as out of bounds
+                    }
                 }
-            }
-            if (needs_new_font(font, glyphs[index], fontType)) {
-                // Not yet specified font or need to switch font.
-                font = SkPDFFont::GetFontResource(fDocument, glyphs[index], typeface);
-                SkASSERT(font);  // All preconditions for SkPDFFont::GetFontResource are met.
-                glyphPositioner.setFont(font);
-                SkPDFWriteResourceName(out, SkPDFResourceType::kFont,
-                                       add_resource(fFontResources, font->indirectReference()));
-                out->writeText(" ");
-                SkPDFUtils::AppendScalar(textSize, out);
-                out->writeText(" Tf\n");
+                if (needs_new_font(font, glyphs[index], fontType)) {
+                    // Not yet specified font or need to switch font.
+                    font = SkPDFFont::GetFontResource(fDocument, glyphs[index], typeface);
+                    SkASSERT(font);  // All preconditions for SkPDFFont::GetFontResource are met.
+                    glyphPositioner.setFont(font);
+                    SkPDFWriteResourceName(out, SkPDFResourceType::kFont,
+                                           add_resource(fFontResources,
+                                                        font->indirectReference()));
+                    out->writeText(" ");
+                    SkPDFUtils::AppendScalar(textSize, out);
+                    out->writeText(" Tf\n");
 
-            }
-            font->noteGlyphUsage(gid);
-            SkGlyphID encodedGlyph = font->glyphToPDFFontEncoding(gid);
-            SkScalar advance = advanceScale * glyphs[index]->advanceX();
-            if (mark) {
-                SkRect absoluteGlyphBounds = pageXform.mapRect(glyphBounds);
-                SkPoint& markPoint = mark.point();
-                if (markPoint.isFinite()) {
-                    markPoint.fX = std::min(absoluteGlyphBounds.fLeft  , markPoint.fX);
-                    markPoint.fY = std::max(absoluteGlyphBounds.fBottom, markPoint.fY); // PDF top
-                } else {
-                    markPoint = SkPoint{absoluteGlyphBounds.fLeft, absoluteGlyphBounds.fBottom};
                 }
+                font->noteGlyphUsage(gid);
+                SkGlyphID encodedGlyph = font->glyphToPDFFontEncoding(gid);
+                SkScalar advance = advanceScale * glyphs[index]->advanceX();
+                if (mark) {
+                    SkRect absoluteGlyphBounds = pageXform.mapRect(glyphBounds);
+                    SkPoint& markPoint = mark.point();
+                    if (markPoint.isFinite()) {
+                        markPoint.fX = std::min(absoluteGlyphBounds.fLeft  , markPoint.fX);
+                        markPoint.fY = std::max(absoluteGlyphBounds.fBottom, markPoint.fY);
+                    } else {
+                        markPoint = SkPoint{absoluteGlyphBounds.fLeft,
+                                            absoluteGlyphBounds.fBottom};
+                    }
+                }
+                glyphPositioner.writeGlyph(encodedGlyph, advance, xy);
             }
-            glyphPositioner.writeGlyph(encodedGlyph, advance, xy);
         }
+    };
+    for (const sktext::GlyphRun& glyphRun : glyphRuns) {
+        drawRun(glyphRun);
     }
 }
 
@@ -982,8 +1051,14 @@ void SkPDFDevice::onDrawGlyphRunList(SkCanvas*,
                                      const SkPaint& initialPaint,
                                      const SkPaint& drawingPaint) {
     SkASSERT(!glyphRunList.hasRSXForm());
-    for (const sktext::GlyphRun& glyphRun : glyphRunList) {
-        this->internalDrawGlyphRun(glyphRun, glyphRunList.origin(), drawingPaint);
+    // Adjacent runs with the same font (all runs in a list share a paint) are drawn together.
+    size_t start = 0;
+    for (size_t i = 1; i <= glyphRunList.size(); ++i) {
+        if (i == glyphRunList.size() || glyphRunList[i].font() != glyphRunList[start].font()) {
+            this->internalDrawGlyphRuns({&glyphRunList[start], i - start},
+                                        glyphRunList.origin(), drawingPaint);
+            start = i;
+        }
     }
 }
 
@@ -1699,7 +1774,9 @@ void SkPDFDevice::internalDrawImageRect(SkKeyedImage imageSubset,
         // (maybe in the resource cache?)
     }
 
-    SkBitmapKey key = imageSubset.key();
+    // Images with the same contents share an XObject, whichever SkImage they are drawn from.
+    SkBitmapKey key = SkPDFCanonicalImageKey(fDocument, imageSubset.image().get(),
+                                             imageSubset.key());
     SkPDFIndirectReference* pdfimagePtr = fDocument->fPDFBitmapMap.find(key);
     SkPDFIndirectReference pdfimage = pdfimagePtr ? *pdfimagePtr : SkPDFIndirectReference();
     if (!pdfimagePtr) {
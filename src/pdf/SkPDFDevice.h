@@ -14,6 +14,7 @@
 #include "include/core/SkPaint.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkSpan.h"
 #include "include/core/SkStream.h"
 #include "src/core/SkClipStack.h"
 #include "src/core/SkClipStackDevice.h"
@@ -167,6 +168,9 @@ private:
 
     void internalDrawGlyphRun(
             const sktext::GlyphRun& glyphRun, SkPoint offset, const SkPaint& runPaint);
+    // Draws runs that share a font in one text object.
+    void internalDrawGlyphRuns(
+            SkSpan<const sktext::GlyphRun> glyphRuns, SkPoint offset, const SkPaint& runPaint);
     void drawGlyphRunAsPath(
             const sktext::GlyphRun& glyphRun, SkPoint offset, const SkPaint& runPaint);
 
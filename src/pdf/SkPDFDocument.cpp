@@ -12,6 +12,8 @@
 #include "include/docs/SkPDFDocument.h"
 #include "include/private/base/SkTo.h"
 #include "src/base/SkUTF.h"
+#include "src/core/SkStreamPriv.h"
+#include "src/pdf/SkDeflate.h"
 #include "src/pdf/SkPDFDevice.h"
 #include "src/pdf/SkPDFFont.h"
 #include "src/pdf/SkPDFGradientShader.h"
@@ -20,6 +22,7 @@
 #include "src/pdf/SkPDFTag.h"
 #include "src/pdf/SkPDFUtils.h"
 
+#include <algorithm>
 #include <utility>
 
 // For use in SkCanvas::drawAnnotation
@@ -61,28 +64,70 @@ static size_t difference(size_t minuend, size_t subtrahend) {
 void SkPDFOffsetMap::markStartOfObject(int referenceNumber, const SkWStream* s) {
     SkASSERT(referenceNumber > 0);
     size_t index = SkToSizeT(referenceNumber - 1);
-    if (index >= fOffsets.size()) {
-        fOffsets.resize(index + 1);
+    if (index >= fEntries.size()) {
+        fEntries.resize(index + 1);
     }
-    fOffsets[index] = SkToInt(difference(s->bytesWritten(), fBaseOffset));
+    fEntries[index] = {this->currentOffset(s), -1};
+}
+
+void SkPDFOffsetMap::markObjectInStream(int referenceNumber, int objectStream, int index) {
+    SkASSERT(referenceNumber > 0);
+    SkASSERT(objectStream > 0);
+    SkASSERT(index >= 0);
+    size_t i = SkToSizeT(referenceNumber - 1);
+    if (i >= fEntries.size()) {
+        fEntries.resize(i + 1);
+    }
+    fEntries[i] = {objectStream, index};
+}
+
+int SkPDFOffsetMap::currentOffset(const SkWStream* s) const {
+    return SkToInt(difference(s->bytesWritten(), fBaseOffset));
 }
 
 int SkPDFOffsetMap::objectCount() const {
-    return SkToInt(fOffsets.size() + 1); // Include the special zeroth object in the count.
+    return SkToInt(fEntries.size() + 1); // Include the special zeroth object in the count.
 }
 
 int SkPDFOffsetMap::emitCrossReferenceTable(SkWStream* s) const {
-    int xRefFileOffset = SkToInt(difference(s->bytesWritten(), fBaseOffset));
+    int xRefFileOffset = this->currentOffset(s);
     s->writeText("xref\n0 ");
     s->writeDecAsText(this->objectCount());
     s->writeText("\n0000000000 65535 f \n");
-    for (int offset : fOffsets) {
-        SkASSERT(offset > 0);  // Offset was set.
-        s->writeBigDecAsText(offset, 10);
+    for (const Entry& entry : fEntries) {
+        SkASSERT(entry.fOffset > 0);  // Offset was set.
+        SkASSERT(entry.fIndex < 0);   // Object streams need a cross-reference stream.
+        s->writeBigDecAsText(entry.fOffset, 10);
         s->writeText(" 00000 n \n");
     }
     return xRefFileOffset;
 }
+
+static void write_big_endian(SkWStream* s, uint32_t value, int bytes) {
+    for (int shift = 8 * (bytes - 1); shift >= 0; shift -= 8) {
+        s->write8(SkToU8((value >> shift) & 0xFF));
+    }
+}
+
+void SkPDFOffsetMap::emitCrossReferenceStreamEntries(SkWStream* s) const {
+    const int* w = kCrossReferenceStreamWidths;
+    // Object zero is the head of the (empty) list of free objects.
+    write_big_endian(s, 0, w[0]);
+    write_big_endian(s, 0, w[1]);
+    write_big_endian(s, 0xFFFF, w[2]);
+    for (const Entry& entry : fEntries) {
+        SkASSERT(entry.fOffset > 0);  // Offset was set.
+        if (entry.fIndex < 0) {
+            write_big_endian(s, 1, w[0]);
+            write_big_endian(s, SkToU32(entry.fOffset), w[1]);
+            write_big_endian(s, 0, w[2]);
+        } else {
+            write_big_endian(s, 2, w[0]);
+            write_big_endian(s, SkToU32(entry.fOffset), w[1]);
+            write_big_endian(s, SkToU32(entry.fIndex), w[2]);
+        }
+    }
+}
 //
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -93,9 +138,11 @@ static_assert((SKPDF_MAGIC[1] & 0x7F) == "Skia"[1], "");
 static_assert((SKPDF_MAGIC[2] & 0x7F) == "Skia"[2], "");
 static_assert((SKPDF_MAGIC[3] & 0x7F) == "Skia"[3], "");
 #endif
-static void serializeHeader(SkPDFOffsetMap* offsetMap, SkWStream* wStream) {
+static void serializeHeader(SkPDFOffsetMap* offsetMap, SkWStream* wStream, bool objectStreams) {
     offsetMap->markStartOfDocument(wStream);
-    wStream->writeText("%PDF-1.4\n%" SKPDF_MAGIC "\n");
+    // Object and cross-reference streams are PDF 1.5 features.
+    wStream->writeText(objectStreams ? "%PDF-1.5\n%" SKPDF_MAGIC "\n"
+                                     : "%PDF-1.4\n%" SKPDF_MAGIC "\n");
     // The PDF spec recommends including a comment with four
     // bytes, all with their high bits set.  "\xD3\xEB\xE9\xE1" is
     // "Skia" with the high bits set.
@@ -112,6 +159,41 @@ static void begin_indirect_object(SkPDFOffsetMap* offsetMap,
 
 static void end_indirect_object(SkWStream* s) { s->writeText("\nendobj\n"); }
 
+static void populate_trailer_dict(SkPDFDict* trailerDict,
+                                  int objectCount,
+                                  SkPDFIndirectReference infoDict,
+                                  SkPDFIndirectReference docCatalog,
+                                  SkUUID uuid) {
+    trailerDict->insertInt("Size", objectCount);
+    SkASSERT(docCatalog != SkPDFIndirectReference());
+    trailerDict->insertRef("Root", docCatalog);
+    SkASSERT(infoDict != SkPDFIndirectReference());
+    trailerDict->insertRef("Info", infoDict);
+    if (SkUUID() != uuid) {
+        trailerDict->insertObject("ID", SkPDFMetadata::MakePdfId(uuid, uuid));
+    }
+}
+
+// Writes 'dict' and 'content' as a stream, deflated unless compression is off.
+static void write_stream(SkPDFDict* dict,
+                         std::unique_ptr<SkStreamAsset> content,
+                         SkPDF::Metadata::CompressionLevel compressionLevel,
+                         SkWStream* wStream) {
+    if (compressionLevel != SkPDF::Metadata::CompressionLevel::None) {
+        SkDynamicMemoryWStream compressed;
+        SkDeflateWStream deflateWStream(&compressed, SkToInt(compressionLevel));
+        SkStreamCopy(&deflateWStream, content.get());
+        deflateWStream.finalize();
+        content = compressed.detachAsStream();
+        dict->insertName("Filter", "FlateDecode");
+    }
+    dict->insertInt("Length", content->getLength());
+    dict->emitObject(wStream);
+    wStream->writeText(" stream\n");
+    wStream->writeStream(content.get(), content->getLength());
+    wStream->writeText("\nendstream");
+}
+
 // Xref table and footer
 static void serialize_footer(const SkPDFOffsetMap& offsetMap,
                              SkWStream* wStream,
@@ -120,14 +202,7 @@ static void serialize_footer(const SkPDFOffsetMap& offsetMap,
                              SkUUID uuid) {
     int xRefFileOffset = offsetMap.emitCrossReferenceTable(wStream);
     SkPDFDict trailerDict;
-    trailerDict.insertInt("Size", offsetMap.objectCount());
-    SkASSERT(docCatalog != SkPDFIndirectReference());
-    trailerDict.insertRef("Root", docCatalog);
-    SkASSERT(infoDict != SkPDFIndirectReference());
-    trailerDict.insertRef("Info", infoDict);
-    if (SkUUID() != uuid) {
-        trailerDict.insertObject("ID", SkPDFMetadata::MakePdfId(uuid, uuid));
-    }
+    populate_trailer_dict(&trailerDict, offsetMap.objectCount(), infoDict, docCatalog, uuid);
     wStream->writeText("trailer\n");
     trailerDict.emitObject(wStream);
     wStream->writeText("\nstartxref\n");
@@ -135,68 +210,134 @@ static void serialize_footer(const SkPDFOffsetMap& offsetMap,
     wStream->writeText("\n%%EOF\n");
 }
 
+// Xref stream and footer. The xref stream is the last object, and holds the trailer's entries.
+static void serialize_xref_stream_footer(SkPDFOffsetMap* offsetMap,
+                                         SkWStream* wStream,
+                                         SkPDFIndirectReference xrefStream,
+                                         SkPDFIndirectReference infoDict,
+                                         SkPDFIndirectReference docCatalog,
+                                         SkUUID uuid,
+                                         SkPDF::Metadata::CompressionLevel compressionLevel) {
+    int xRefFileOffset = offsetMap->currentOffset(wStream);
+    begin_indirect_object(offsetMap, xrefStream, wStream);
+    SkASSERT(offsetMap->objectCount() == xrefStream.fValue + 1);
+
+    SkPDFDict dict("XRef");
+    populate_trailer_dict(&dict, offsetMap->objectCount(), infoDict, docCatalog, uuid);
+    const int* w = SkPDFOffsetMap::kCrossReferenceStreamWidths;
+    dict.insertObject("W", SkPDFMakeArray(w[0], w[1], w[2]));
+    SkDynamicMemoryWStream entries;
+    offsetMap->emitCrossReferenceStreamEntries(&entries);
+    write_stream(&dict, entries.detachAsStream(), compressionLevel, wStream);
+    end_indirect_object(wStream);
+
+    wStream->writeText("startxref\n");
+    wStream->writeBigDecAsText(xRefFileOffset);
+    wStream->writeText("\n%%EOF\n");
+}
+
+// PDF wants a tree describing all the pages in the document.  We arbitrary
+// choose 8 (kPageTreeNodeSize) as the number of allowed children.  The internal
+// nodes have type "Pages" with an array of children, a parent pointer, and
+// the number of leaves below the node as "Count."  The leaves have type "Page"
+// and need a parent pointer.
+static constexpr size_t kPageTreeNodeSize = 8;
+
+// In incremental mode, the most jobs (e.g. compressing a page's content or an image) left on the
+// executor when a page ends.
+static constexpr int kMaxQueuedIncrementalJobs = 16;
+
+// Readers parse a whole object stream to find any object in it, so they are kept fairly small.
+static constexpr size_t kMaxObjectsPerObjectStream = 100;
+
+namespace {
+struct PageTreeNode {
+    std::unique_ptr<SkPDFDict> fNode;
+    SkPDFIndirectReference fReservedRef;
+    int fPageObjectDescendantCount;
+
+    // Builds the next layer up, skipping internal nodes that would have only one child.
+    static std::vector<PageTreeNode> Layer(std::vector<PageTreeNode> vec, SkPDFDocument* doc) {
+        std::vector<PageTreeNode> result;
+        const size_t n = vec.size();
+        SkASSERT(n >= 1);
+        const size_t result_len = (n - 1) / kPageTreeNodeSize + 1;
+        SkASSERT(result_len >= 1);
+        SkASSERT(n == 1 || result_len < n);
+        result.reserve(result_len);
+        size_t index = 0;
+        for (size_t i = 0; i < result_len; ++i) {
+            if (n != 1 && index + 1 == n) {  // No need to create a new node.
+                result.push_back(std::move(vec[index++]));
+                continue;
+            }
+            SkPDFIndirectReference parent = doc->reserveRef();
+            auto kids_list = SkPDFMakeArray();
+            int descendantCount = 0;
+            for (size_t j = 0; j < kPageTreeNodeSize && index < n; ++j) {
+                PageTreeNode& node = vec[index++];
+                node.fNode->insertRef("Parent", parent);
+                kids_list->appendRef(doc->emit(*node.fNode, node.fReservedRef));
+                descendantCount += node.fPageObjectDescendantCount;
+            }
+            auto next = SkPDFMakeDict("Pages");
+            next->insertInt("Count", descendantCount);
+            next->insertObject("Kids", std::move(kids_list));
+            result.push_back(PageTreeNode{std::move(next), parent, descendantCount});
+        }
+        return result;
+    }
+
+    static SkPDFIndirectReference EmitRoot(std::vector<PageTreeNode> layer, SkPDFDocument* doc) {
+        while (layer.size() > 1) {
+            layer = PageTreeNode::Layer(std::move(layer), doc);
+        }
+        SkASSERT(layer.size() == 1);
+        const PageTreeNode& root = layer[0];
+        return doc->emit(*root.fNode, root.fReservedRef);
+    }
+};
+}  // namespace
+
+// Builds the tree bottom up from pages that have not been written yet.
 static SkPDFIndirectReference generate_page_tree(
         SkPDFDocument* doc,
         std::vector<std::unique_ptr<SkPDFDict>> pages,
         const std::vector<SkPDFIndirectReference>& pageRefs) {
-    // PDF wants a tree describing all the pages in the document.  We arbitrary
-    // choose 8 (kNodeSize) as the number of allowed children.  The internal
-    // nodes have type "Pages" with an array of children, a parent pointer, and
-    // the number of leaves below the node as "Count."  The leaves are passed
-    // into the method, have type "Page" and need a parent pointer. This method
-    // builds the tree bottom up, skipping internal nodes that would have only
-    // one child.
     SkASSERT(pages.size() > 0);
-    struct PageTreeNode {
-        std::unique_ptr<SkPDFDict> fNode;
-        SkPDFIndirectReference fReservedRef;
-        int fPageObjectDescendantCount;
-
-        static std::vector<PageTreeNode> Layer(std::vector<PageTreeNode> vec, SkPDFDocument* doc) {
-            std::vector<PageTreeNode> result;
-            static constexpr size_t kMaxNodeSize = 8;
-            const size_t n = vec.size();
-            SkASSERT(n >= 1);
-            const size_t result_len = (n - 1) / kMaxNodeSize + 1;
-            SkASSERT(result_len >= 1);
-            SkASSERT(n == 1 || result_len < n);
-            result.reserve(result_len);
-            size_t index = 0;
-            for (size_t i = 0; i < result_len; ++i) {
-                if (n != 1 && index + 1 == n) {  // No need to create a new node.
-                    result.push_back(std::move(vec[index++]));
-                    continue;
-                }
-                SkPDFIndirectReference parent = doc->reserveRef();
-                auto kids_list = SkPDFMakeArray();
-                int descendantCount = 0;
-                for (size_t j = 0; j < kMaxNodeSize && index < n; ++j) {
-                    PageTreeNode& node = vec[index++];
-                    node.fNode->insertRef("Parent", parent);
-                    kids_list->appendRef(doc->emit(*node.fNode, node.fReservedRef));
-                    descendantCount += node.fPageObjectDescendantCount;
-                }
-                auto next = SkPDFMakeDict("Pages");
-                next->insertInt("Count", descendantCount);
-                next->insertObject("Kids", std::move(kids_list));
-                result.push_back(PageTreeNode{std::move(next), parent, descendantCount});
-            }
-            return result;
-        }
-    };
     std::vector<PageTreeNode> currentLayer;
     currentLayer.reserve(pages.size());
     SkASSERT(pages.size() == pageRefs.size());
     for (size_t i = 0; i < pages.size(); ++i) {
         currentLayer.push_back(PageTreeNode{std::move(pages[i]), pageRefs[i], 1});
     }
+    // The root is always a "Pages" node, even for a single page.
     currentLayer = PageTreeNode::Layer(std::move(currentLayer), doc);
-    while (currentLayer.size() > 1) {
-        currentLayer = PageTreeNode::Layer(std::move(currentLayer), doc);
+    return PageTreeNode::EmitRoot(std::move(currentLayer), doc);
+}
+
+// Builds the tree bottom up from the parents that pages were written with in incremental mode.
+static SkPDFIndirectReference generate_incremental_page_tree(
+        SkPDFDocument* doc,
+        const std::vector<SkPDFIndirectReference>& leaves,
+        const std::vector<SkPDFIndirectReference>& pageRefs) {
+    SkASSERT(leaves.size() > 0);
+    SkASSERT(leaves.size() == (pageRefs.size() - 1) / kPageTreeNodeSize + 1);
+    std::vector<PageTreeNode> currentLayer;
+    currentLayer.reserve(leaves.size());
+    for (size_t i = 0; i < leaves.size(); ++i) {
+        const size_t first = i * kPageTreeNodeSize;
+        const size_t last = std::min(first + kPageTreeNodeSize, pageRefs.size());
+        auto kids_list = SkPDFMakeArray();
+        for (size_t page = first; page < last; ++page) {
+            kids_list->appendRef(pageRefs[page]);
+        }
+        auto leaf = SkPDFMakeDict("Pages");
+        leaf->insertInt("Count", SkToInt(last - first));
+        leaf->insertObject("Kids", std::move(kids_list));
+        currentLayer.push_back(PageTreeNode{std::move(leaf), leaves[i], SkToInt(last - first)});
     }
-    SkASSERT(currentLayer.size() == 1);
-    const PageTreeNode& root = currentLayer[0];
-    return doc->emit(*root.fNode, root.fReservedRef);
+    return PageTreeNode::EmitRoot(std::move(currentLayer), doc);
 }
 
 template<typename T, typename... Args>
@@ -229,6 +370,15 @@ SkPDFDocument::~SkPDFDocument() {
 
 SkPDFIndirectReference SkPDFDocument::emit(const SkPDFObject& object, SkPDFIndirectReference ref){
     SkAutoMutexExclusive lock(fMutex);
+    if (fMetadata.fObjectStreams) {
+        fObjectStreamMembers.push_back({ref.fValue, SkToInt(fObjectStreamData.bytesWritten())});
+        object.emitObject(&fObjectStreamData);
+        fObjectStreamData.writeText("\n");
+        if (fObjectStreamMembers.size() >= kMaxObjectsPerObjectStream) {
+            this->flushObjectStream();
+        }
+        return ref;
+    }
     object.emitObject(this->beginObject(ref));
     this->endObject();
     return ref;
@@ -243,16 +393,41 @@ void SkPDFDocument::endObject() SK_REQUIRES(fMutex) {
     end_indirect_object(this->getStream());
 }
 
+void SkPDFDocument::flushObjectStream() SK_REQUIRES(fMutex) {
+    if (fObjectStreamMembers.empty()) {
+        return;
+    }
+    SkPDFIndirectReference ref = this->reserveRef();
+    // The objects follow pairs of their numbers and offsets (relative to the first object).
+    SkDynamicMemoryWStream content;
+    for (size_t i = 0; i < fObjectStreamMembers.size(); ++i) {
+        const ObjectStreamMember& member = fObjectStreamMembers[i];
+        fOffsetMap.markObjectInStream(member.fNumber, ref.fValue, SkToInt(i));
+        content.writeDecAsText(member.fNumber);
+        content.writeText(" ");
+        content.writeDecAsText(member.fOffset);
+        content.writeText(" ");
+    }
+    SkPDFDict dict("ObjStm");
+    dict.insertInt("N", fObjectStreamMembers.size());
+    dict.insertInt("First", content.bytesWritten());
+    fObjectStreamData.writeToAndReset(&content);
+    fObjectStreamMembers.clear();
+    write_stream(&dict, content.detachAsStream(), fMetadata.fCompressionLevel,
+                 this->beginObject(ref));
+    this->endObject();
+}
+
 static SkSize operator*(SkISize u, SkScalar s) { return SkSize{u.width() * s, u.height() * s}; }
 static SkSize operator*(SkSize u, SkScalar s) { return SkSize{u.width() * s, u.height() * s}; }
 
 SkCanvas* SkPDFDocument::onBeginPage(SkScalar width, SkScalar height) {
     SkASSERT(fCanvas.imageInfo().dimensions().isZero());
-    if (fPages.empty()) {
+    if (0 == fEndedPageCount) {
         // if this is the first page if the document.
         {
             SkAutoMutexExclusive autoMutexAcquire(fMutex);
-            serializeHeader(&fOffsetMap, this->getStream());
+            serializeHeader(&fOffsetMap, this->getStream(), fMetadata.fObjectStreams);
 
         }
 
@@ -376,7 +551,21 @@ void SkPDFDocument::onEndPage() {
     // The StructParents unique identifier for each page is just its
     // 0-based page index.
     page->insertInt("StructParents", SkToInt(this->currentPageIndex()));
-    fPages.emplace_back(std::move(page));
+    if (fMetadata.fIncremental) {
+        if (fEndedPageCount % kPageTreeNodeSize == 0) {
+            fPageTreeLeaves.push_back(this->reserveRef());
+        }
+        page->insertRef("Parent", fPageTreeLeaves.back());
+        this->emit(*page, fPageRefs.back());
+        // The content keys hold the images' encoded data. Images are still deduplicated across
+        // pages by their IDs, which are small to keep.
+        fImageContentMap.reset();
+        // Don't let finished pages pile up in the executor's queue.
+        this->waitForJobs(kMaxQueuedIncrementalJobs);
+    } else {
+        fPages.emplace_back(std::move(page));
+    }
+    ++fEndedPageCount;
 }
 
 void SkPDFDocument::onAbort() {
@@ -585,7 +774,7 @@ SkString SkPDFDocument::nextFontSubsetTag() {
 
 void SkPDFDocument::onClose(SkWStream* stream) {
     SkASSERT(fCanvas.imageInfo().dimensions().isZero());
-    if (fPages.empty()) {
+    if (0 == fEndedPageCount) {
         this->waitForJobs();
         return;
     }
@@ -598,7 +787,10 @@ void SkPDFDocument::onClose(SkWStream* stream) {
         docCatalog->insertObject("OutputIntents", make_srgb_output_intents(this));
     }
 
-    docCatalog->insertRef("Pages", generate_page_tree(this, std::move(fPages), fPageRefs));
+    docCatalog->insertRef("Pages",
+                          fMetadata.fIncremental
+                                  ? generate_incremental_page_tree(this, fPageTreeLeaves, fPageRefs)
+                                  : generate_page_tree(this, std::move(fPages), fPageRefs));
 
     if (!fNamedDestinations.empty()) {
         docCatalog->insertRef("Dests", append_destinations(this, fNamedDestinations));
@@ -642,7 +834,14 @@ void SkPDFDocument::onClose(SkWStream* stream) {
     this->waitForJobs();
     {
         SkAutoMutexExclusive autoMutexAcquire(fMutex);
-        serialize_footer(fOffsetMap, this->getStream(), fInfoDict, docCatalogRef, fUUID);
+        if (fMetadata.fObjectStreams) {
+            this->flushObjectStream();
+            serialize_xref_stream_footer(&fOffsetMap, this->getStream(), this->reserveRef(),
+                                         fInfoDict, docCatalogRef, fUUID,
+                                         fMetadata.fCompressionLevel);
+        } else {
+            serialize_footer(fOffsetMap, this->getStream(), fInfoDict, docCatalogRef, fUUID);
+        }
     }
 }
 
@@ -650,9 +849,9 @@ void SkPDFDocument::incrementJobCount() { fJobCount++; }
 
 void SkPDFDocument::signalJobComplete() { fSemaphore.signal(); }
 
-void SkPDFDocument::waitForJobs() {
+void SkPDFDocument::waitForJobs(int maxQueued) {
      // fJobCount can increase while we wait.
-     while (fJobCount > 0) {
+     while (fJobCount > maxQueued) {
          fSemaphore.wait();
          --fJobCount;
      }
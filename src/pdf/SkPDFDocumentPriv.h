@@ -40,10 +40,21 @@ class SkPDFOffsetMap {
 public:
     void markStartOfDocument(const SkWStream*);
     void markStartOfObject(int referenceNumber, const SkWStream*);
+    // Records that the object is the index'th one packed into the object stream objectStream.
+    void markObjectInStream(int referenceNumber, int objectStream, int index);
+    int currentOffset(const SkWStream*) const;
     int objectCount() const;
     int emitCrossReferenceTable(SkWStream* s) const;
+    // Writes the binary entries of a cross-reference stream, with the field widths
+    // kCrossReferenceStreamWidths.
+    void emitCrossReferenceStreamEntries(SkWStream* s) const;
+    static constexpr int kCrossReferenceStreamWidths[3] = {1, 4, 2};
 private:
-    std::vector<int> fOffsets;
+    struct Entry {
+        int fOffset = 0;   // For an object in an object stream, that stream's object number.
+        int fIndex = -1;   // The object's index in its object stream, if it is in one.
+    };
+    std::vector<Entry> fEntries;
     size_t fBaseOffset = SIZE_MAX;
 };
 
@@ -138,7 +149,7 @@ public:
     SkExecutor* executor() const { return fExecutor; }
     void incrementJobCount();
     void signalJobComplete();
-    size_t currentPageIndex() { return fPages.size(); }
+    size_t currentPageIndex() { return fEndedPageCount; }
     size_t pageCount() { return fPageRefs.size(); }
 
     const SkMatrix& currentPageTransform() const;
@@ -151,6 +162,10 @@ public:
                            SkPDFIndirectReference,
                            SkPDFGradientShader::KeyHash> fGradientPatternMap;
     skia_private::THashMap<SkBitmapKey, SkPDFIndirectReference> fPDFBitmapMap;
+    skia_private::THashMap<SkPDFImageContentKey,
+                           SkBitmapKey,
+                           SkPDFImageContentKey::Hash> fImageContentMap;
+    skia_private::THashMap<SkBitmapKey, SkBitmapKey> fCanonicalImageKeys;
     skia_private::THashMap<SkPDFIccProfileKey,
                            SkPDFIndirectReference,
                            SkPDFIccProfileKey::Hash> fICCProfileMap;
@@ -176,6 +191,10 @@ private:
     SkCanvas fCanvas;
     std::vector<std::unique_ptr<SkPDFDict>> fPages;
     std::vector<SkPDFIndirectReference> fPageRefs;
+    // In incremental mode, the parents of the pages written so far, one per kPageTreeNodeSize
+    // pages. The rest of the page tree is written when the document closes.
+    std::vector<SkPDFIndirectReference> fPageTreeLeaves;
+    size_t fEndedPageCount = 0;
 
     sk_sp<SkPDFDevice> fPageDevice;
     std::atomic<int> fNextObjectNumber = {1};
@@ -195,7 +214,18 @@ private:
     SkMutex fMutex;
     SkSemaphore fSemaphore;
 
-    void waitForJobs();
+    // With fMetadata.fObjectStreams, objects that aren't streams are collected here, guarded by
+    // fMutex, and written in groups as object streams.
+    struct ObjectStreamMember {
+        int fNumber;
+        int fOffset;  // In fObjectStreamData.
+    };
+    SkDynamicMemoryWStream fObjectStreamData;
+    std::vector<ObjectStreamMember> fObjectStreamMembers;
+    void flushObjectStream();
+
+    // Waits until no more than maxQueued jobs are left.
+    void waitForJobs(int maxQueued = 0);
     SkWStream* beginObject(SkPDFIndirectReference);
     void endObject();
 };
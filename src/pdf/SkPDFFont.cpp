@@ -7,6 +7,7 @@
 
 #include "include/core/SkBitmap.h"
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFont.h"
 #include "include/core/SkFontMetrics.h"
 #include "include/core/SkFontTypes.h"
@@ -296,13 +297,25 @@ static sk_sp<SkData> stream_to_data(std::unique_ptr<SkStreamAsset> stream) {
     return SkData::MakeFromStream(stream.get(), size);
 }
 
-static void emit_subset_type0(const SkPDFFont& font, SkPDFDocument* doc) {
-    const SkAdvancedTypefaceMetrics* metricsPtr =
-        SkPDFFont::GetMetrics(font.typeface(), doc);
-    SkASSERT(metricsPtr);
-    if (!metricsPtr) { return; }
-    const SkAdvancedTypefaceMetrics& metrics = *metricsPtr;
-    SkASSERT(can_embed(metrics));
+namespace {
+// The indirect references a Type0 font's objects are written to. They are all reserved up front,
+// on the thread that calls emitSubset(), so that object numbers don't depend on the order in
+// which executor jobs finish.
+struct Type0Refs {
+    SkPDFIndirectReference fFontFile;
+    SkPDFIndirectReference fDescriptor;
+    SkPDFIndirectReference fCIDFont;
+    SkPDFIndirectReference fToUnicode;
+};
+}  // namespace
+
+// May run on the document's executor, so this must not touch the document's canonicalization
+// maps; anything it needs from them is looked up by emit_subset_type0() beforehand.
+static void serialize_subset_type0(const SkPDFFont& font,
+                                   const SkAdvancedTypefaceMetrics& metrics,
+                                   const SkUnichar* glyphToUnicode,
+                                   const Type0Refs& refs,
+                                   SkPDFDocument* doc) {
     SkAdvancedTypefaceMetrics::FontType type = font.getType();
     SkTypeface* face = font.typeface();
     SkASSERT(face);
@@ -314,6 +327,7 @@ static void emit_subset_type0(const SkPDFFont& font, SkPDFDocument* doc) {
     int ttcIndex;
     std::unique_ptr<SkStreamAsset> fontAsset = face->openStream(&ttcIndex);
     size_t fontSize = fontAsset ? fontAsset->getLength() : 0;
+    bool wroteFontFile = false;
     if (0 == fontSize) {
         SkDebugf("Error: (SkTypeface)(%p)::openStream() returned "
                  "empty stream (%p) when identified as kType1CID_Font "
@@ -331,11 +345,11 @@ static void emit_subset_type0(const SkPDFFont& font, SkPDFDocument* doc) {
                     if (subsetFontData) {
                         std::unique_ptr<SkPDFDict> tmp = SkPDFMakeDict();
                         tmp->insertInt("Length1", SkToInt(subsetFontData->size()));
-                        descriptor->insertRef(
-                                "FontFile2",
-                                SkPDFStreamOut(std::move(tmp),
-                                               SkMemoryStream::Make(std::move(subsetFontData)),
-                                               doc, SkPDFSteamCompressionEnabled::Yes));
+                        SkPDFSerializeStream(refs.fFontFile, std::move(tmp),
+                                             SkMemoryStream::Make(std::move(subsetFontData)),
+                                             doc, SkPDFSteamCompressionEnabled::Yes);
+                        descriptor->insertRef("FontFile2", refs.fFontFile);
+                        wroteFontFile = true;
                         break;
                     }
                     // If subsetting fails, fall back to original font data.
@@ -346,26 +360,33 @@ static void emit_subset_type0(const SkPDFFont& font, SkPDFDocument* doc) {
                 }
                 std::unique_ptr<SkPDFDict> tmp = SkPDFMakeDict();
                 tmp->insertInt("Length1", fontSize);
-                descriptor->insertRef("FontFile2",
-                                      SkPDFStreamOut(std::move(tmp), std::move(fontAsset),
-                                                     doc, SkPDFSteamCompressionEnabled::Yes));
+                SkPDFSerializeStream(refs.fFontFile, std::move(tmp), std::move(fontAsset),
+                                     doc, SkPDFSteamCompressionEnabled::Yes);
+                descriptor->insertRef("FontFile2", refs.fFontFile);
+                wroteFontFile = true;
                 break;
             }
             case SkAdvancedTypefaceMetrics::kType1CID_Font: {
                 std::unique_ptr<SkPDFDict> tmp = SkPDFMakeDict();
                 tmp->insertName("Subtype", "CIDFontType0C");
-                descriptor->insertRef("FontFile3",
-                                      SkPDFStreamOut(std::move(tmp), std::move(fontAsset),
-                                                     doc, SkPDFSteamCompressionEnabled::Yes));
+                SkPDFSerializeStream(refs.fFontFile, std::move(tmp), std::move(fontAsset),
+                                     doc, SkPDFSteamCompressionEnabled::Yes);
+                descriptor->insertRef("FontFile3", refs.fFontFile);
+                wroteFontFile = true;
                 break;
             }
             default:
                 SkASSERT(false);
         }
     }
+    if (!wroteFontFile) {
+        // The reference was reserved, so it must still be written for the xref table to be
+        // complete. Nothing refers to it.
+        doc->emit(SkPDFDict(), refs.fFontFile);
+    }
 
     auto newCIDFont = SkPDFMakeDict("Font");
-    newCIDFont->insertRef("FontDescriptor", doc->emit(*descriptor));
+    newCIDFont->insertRef("FontDescriptor", doc->emit(*descriptor, refs.fDescriptor));
     newCIDFont->insertName("BaseFont", metrics.fPostScriptName);
 
     switch (type) {
@@ -404,23 +425,54 @@ static void emit_subset_type0(const SkPDFFont& font, SkPDFDocument* doc) {
     fontDict.insertName("BaseFont", metrics.fPostScriptName);
     fontDict.insertName("Encoding", "Identity-H");
     auto descendantFonts = SkPDFMakeArray();
-    descendantFonts->appendRef(doc->emit(*newCIDFont));
+    descendantFonts->appendRef(doc->emit(*newCIDFont, refs.fCIDFont));
     fontDict.insertObject("DescendantFonts", std::move(descendantFonts));
 
-    const std::vector<SkUnichar>& glyphToUnicode =
-        SkPDFFont::GetUnicodeMap(font.typeface(), doc);
-    SkASSERT(SkToSizeT(font.typeface()->countGlyphs()) == glyphToUnicode.size());
     std::unique_ptr<SkStreamAsset> toUnicode =
-            SkPDFMakeToUnicodeCmap(glyphToUnicode.data(),
+            SkPDFMakeToUnicodeCmap(glyphToUnicode,
                                    &font.glyphUsage(),
                                    font.multiByteGlyphs(),
                                    font.firstGlyphID(),
                                    font.lastGlyphID());
-    fontDict.insertRef("ToUnicode", SkPDFStreamOut(nullptr, std::move(toUnicode), doc));
+    SkPDFSerializeStream(refs.fToUnicode, nullptr, std::move(toUnicode), doc);
+    fontDict.insertRef("ToUnicode", refs.fToUnicode);
 
     doc->emit(fontDict, font.indirectReference());
 }
 
+static void emit_subset_type0(const SkPDFFont& font, SkPDFDocument* doc) {
+    const SkAdvancedTypefaceMetrics* metricsPtr =
+        SkPDFFont::GetMetrics(font.typeface(), doc);
+    SkASSERT(metricsPtr);
+    if (!metricsPtr) { return; }
+    SkASSERT(can_embed(*metricsPtr));
+
+    // The map's entries may move as other typefaces are added to it, but their storage doesn't.
+    const std::vector<SkUnichar>& glyphToUnicode =
+        SkPDFFont::GetUnicodeMap(font.typeface(), doc);
+    SkASSERT(SkToSizeT(font.typeface()->countGlyphs()) == glyphToUnicode.size());
+    const SkUnichar* glyphToUnicodePtr = glyphToUnicode.data();
+
+    Type0Refs refs;
+    refs.fFontFile = doc->reserveRef();
+    refs.fDescriptor = doc->reserveRef();
+    refs.fCIDFont = doc->reserveRef();
+    refs.fToUnicode = doc->reserveRef();
+
+    // Subsetting, the glyph widths and the ToUnicode CMap are the expensive parts of a font, and
+    // are independent of every other font. The font itself lives in the document's font map,
+    // which is not modified once the document is closing.
+    if (SkExecutor* executor = doc->executor()) {
+        doc->incrementJobCount();
+        executor->add([&font, metricsPtr, glyphToUnicodePtr, refs, doc]() {
+            serialize_subset_type0(font, *metricsPtr, glyphToUnicodePtr, refs, doc);
+            doc->signalJobComplete();
+        });
+        return;
+    }
+    serialize_subset_type0(font, *metricsPtr, glyphToUnicodePtr, refs, doc);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // PDFType3Font
 ///////////////////////////////////////////////////////////////////////////////
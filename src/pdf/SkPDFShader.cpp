@@ -16,6 +16,8 @@
 #include "include/private/base/SkMath.h"
 #include "include/private/base/SkTPin.h"
 #include "include/private/base/SkTemplates.h"
+#include "src/pdf/SkKeyedImage.h"
+#include "src/pdf/SkPDFBitmap.h"
 #include "src/pdf/SkPDFDevice.h"
 #include "src/pdf/SkPDFDocumentPriv.h"
 #include "src/pdf/SkPDFFormXObject.h"
@@ -257,6 +259,37 @@ static SkPDFIndirectReference make_image_shader(SkPDFDocument* doc,
     return SkPDFStreamOut(std::move(dict), std::move(imageShader), doc);
 }
 
+// Image shaders are canonicalized by the contents of their image, so the same pixels drawn
+// through different SkImages (or rasterized again by the fallback below) share one pattern.
+static SkPDFIndirectReference find_or_make_image_shader(SkPDFDocument* doc,
+                                                        const SkMatrix& finalMatrix,
+                                                        SkTileMode tileModesX,
+                                                        SkTileMode tileModesY,
+                                                        const SkIRect& surfaceBBox,
+                                                        const SkImage* image,
+                                                        SkColor4f paintColor) {
+    SkPDFImageShaderKey key = {
+        finalMatrix,
+        surfaceBBox,
+        SkPDFCanonicalImageKey(doc, image, SkBitmapKeyFromImage(image)),
+        {tileModesX, tileModesY},
+        paintColor};
+    SkPDFIndirectReference* shaderPtr = doc->fImageShaderMap.find(key);
+    if (shaderPtr) {
+        return *shaderPtr;
+    }
+    SkPDFIndirectReference pdfShader =
+            make_image_shader(doc,
+                              finalMatrix,
+                              tileModesX,
+                              tileModesY,
+                              SkRect::Make(surfaceBBox),
+                              image,
+                              paintColor);
+    doc->fImageShaderMap.set(std::move(key), pdfShader);
+    return pdfShader;
+}
+
 // Generic fallback for unsupported shaders:
 //  * allocate a surfaceBBox-sized bitmap
 //  * shade the whole area
@@ -305,12 +338,12 @@ static SkPDFIndirectReference make_fallback_shader(SkPDFDocument* doc,
 
     sk_sp<SkImage> image = surface->makeImageSnapshot();
     SkASSERT(image);
-    return make_image_shader(doc,
-                             SkMatrix::Concat(canvasTransform, shaderTransform),
-                             SkTileMode::kClamp, SkTileMode::kClamp,
-                             SkRect::Make(surfaceBBox),
-                             image.get(),
-                             paintColor);
+    return find_or_make_image_shader(doc,
+                                     SkMatrix::Concat(canvasTransform, shaderTransform),
+                                     SkTileMode::kClamp, SkTileMode::kClamp,
+                                     surfaceBBox,
+                                     image.get(),
+                                     paintColor);
 }
 
 static SkColor4f adjust_color(SkShader* shader, SkColor4f paintColor) {
@@ -341,28 +374,13 @@ SkPDFIndirectReference SkPDFMakeShader(SkPDFDocument* doc,
     SkMatrix shaderTransform;
     SkTileMode imageTileModes[2];
     if (SkImage* skimg = shader->isAImage(&shaderTransform, imageTileModes)) {
-        SkMatrix finalMatrix = SkMatrix::Concat(canvasTransform, shaderTransform);
-        SkPDFImageShaderKey key = {
-            finalMatrix,
-            surfaceBBox,
-            SkBitmapKeyFromImage(skimg),
-            {imageTileModes[0], imageTileModes[1]},
-            paintColor};
-        SkPDFIndirectReference* shaderPtr = doc->fImageShaderMap.find(key);
-        if (shaderPtr) {
-            return *shaderPtr;
-        }
-        SkPDFIndirectReference pdfShader =
-                make_image_shader(doc,
-                                  finalMatrix,
-                                  imageTileModes[0],
-                                  imageTileModes[1],
-                                  SkRect::Make(surfaceBBox),
-                                  skimg,
-                                  paintColor);
-        doc->fImageShaderMap.set(std::move(key), pdfShader);
-        return pdfShader;
+        return find_or_make_image_shader(doc,
+                                         SkMatrix::Concat(canvasTransform, shaderTransform),
+                                         imageTileModes[0],
+                                         imageTileModes[1],
+                                         surfaceBBox,
+                                         skimg,
+                                         paintColor);
     }
-    // Don't bother to de-dup fallback shader.
     return make_fallback_shader(doc, shader, canvasTransform, surfaceBBox, paintColor);
 }
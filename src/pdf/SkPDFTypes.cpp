@@ -552,7 +552,8 @@ static void serialize_stream(SkPDFDict* origDict,
         stream->getLength() > kMinimumSavings)
     {
         SkDynamicMemoryWStream compressedData;
-        SkDeflateWStream deflateWStream(&compressedData,SkToInt(doc->metadata().fCompressionLevel));
+        SkDeflateWStream deflateWStream(&compressedData, SkToInt(doc->metadata().fCompressionLevel),
+                                        false, doc->executor());
         SkStreamCopy(&deflateWStream, stream);
         deflateWStream.finalize();
         #ifdef SK_PDF_BASE85_BINARY
@@ -604,3 +605,11 @@ SkPDFIndirectReference SkPDFStreamOut(std::unique_ptr<SkPDFDict> dict,
     serialize_stream(dict.get(), content.get(), compress, doc, ref);
     return ref;
 }
+
+void SkPDFSerializeStream(SkPDFIndirectReference ref,
+                          std::unique_ptr<SkPDFDict> dict,
+                          std::unique_ptr<SkStreamAsset> content,
+                          SkPDFDocument* doc,
+                          SkPDFSteamCompressionEnabled compress) {
+    serialize_stream(dict.get(), content.get(), compress, doc, ref);
+}
@@ -216,4 +216,15 @@ SkPDFIndirectReference SkPDFStreamOut(
     std::unique_ptr<SkStreamAsset> stream,
     SkPDFDocument* doc,
     SkPDFSteamCompressionEnabled compress = SkPDFSteamCompressionEnabled::Default);
+
+/** Like SkPDFStreamOut(), but writes to a reference the caller has already reserved, and
+ *  always serializes on the calling thread. For use by jobs already running on the
+ *  document's executor.
+ */
+void SkPDFSerializeStream(
+    SkPDFIndirectReference ref,
+    std::unique_ptr<SkPDFDict> dict,
+    std::unique_ptr<SkStreamAsset> stream,
+    SkPDFDocument* doc,
+    SkPDFSteamCompressionEnabled compress = SkPDFSteamCompressionEnabled::Default);
 #endif
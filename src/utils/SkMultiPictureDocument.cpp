@@ -20,6 +20,7 @@
 #include "include/private/base/SkTArray.h"
 #include "include/private/base/SkTo.h"
 #include "include/utils/SkNWayCanvas.h"
+#include "src/core/SkLRUCache.h"
 #include "src/utils/SkMultiPictureDocument.h"
 #include "src/utils/SkMultiPictureDocumentPriv.h"
 
@@ -29,6 +30,7 @@
 #include <cstring>
 #include <functional>
 #include <utility>
+#include <vector>
 
 using namespace skia_private;
 
@@ -36,13 +38,21 @@ using namespace skia_private;
   File format:
       BEGINNING_OF_FILE:
         kMagic
-        uint32_t version_number (==2)
+        uint32_t version_number (==3)
         uint32_t page_count
         {
           float sizeX
           float sizeY
         } * page_count
-        skp file
+        {
+          uint32_t byte_count
+        } * page_count
+        {
+          skp file (byte_count bytes)
+        } * page_count
+
+  Version 2 has no byte counts, and a single skp file drawing every page, each followed by an
+  annotation with the key kEndPage.
 */
 
 namespace {
@@ -51,15 +61,8 @@ static constexpr char kMagic[] = "Skia Multi-Picture Doc\n\n";
 
 static constexpr char kEndPage[] = "SkMultiPictureEndPage";
 
-const uint32_t kVersion = 2;
-
-static SkSize join(const TArray<SkSize>& sizes) {
-    SkSize joined = {0, 0};
-    for (SkSize s : sizes) {
-        joined = SkSize{std::max(joined.width(), s.width()), std::max(joined.height(), s.height())};
-    }
-    return joined;
-}
+const uint32_t kVersion = 3;
+const uint32_t kSinglePictureVersion = 2;
 
 struct MultiPictureDocument final : public SkDocument {
     const SkSerialProcs fProcs;
@@ -98,15 +101,15 @@ struct MultiPictureDocument final : public SkDocument {
         for (SkSize s : fSizes) {
             wStream->write(&s, sizeof(s));
         }
-        SkSize bigsize = join(fSizes);
-        SkCanvas* c = fPictureRecorder.beginRecording(SkRect::MakeSize(bigsize));
+        // Each page is serialized on its own, so that readers can read any one of them.
+        TArray<sk_sp<SkData>> pages;
         for (const sk_sp<SkPicture>& page : fPages) {
-            c->drawPicture(page);
-            // Annotations must include some data.
-            c->drawAnnotation(SkRect::MakeEmpty(), kEndPage, SkData::MakeWithCString("X"));
+            pages.push_back(page->serialize(&fProcs));
+            wStream->write32(SkToU32(pages.back()->size()));
+        }
+        for (const sk_sp<SkData>& page : pages) {
+            wStream->write(page->data(), page->size());
         }
-        sk_sp<SkPicture> p = fPictureRecorder.finishRecordingAsPicture();
-        p->serialize(wStream, &fProcs);
         fPages.clear();
         fSizes.clear();
         return;
@@ -146,6 +149,179 @@ struct PagerCanvas : public SkNWayCanvas {
     }
 };
 
+// Reads the header, leaving the stream at the page sizes.
+bool read_header(SkStreamSeekable* src, uint32_t* version, int* pageCount) {
+    if (!src) {
+        return false;
+    }
+    src->seek(0);
+    const size_t size = sizeof(kMagic) - 1;
+    char buffer[size];
+    if (size != src->read(buffer, size) || 0 != memcmp(kMagic, buffer, size)) {
+        return false;
+    }
+    if (!src->readU32(version) || (*version != kVersion && *version != kSinglePictureVersion)) {
+        return false;
+    }
+    uint32_t count;
+    if (!src->readU32(&count) || count > INT_MAX) {
+        return false;
+    }
+    *pageCount = SkTo<int>(count);
+    return true;
+}
+
+bool read_size(SkStreamSeekable* src, SkSize* size) {
+    return sizeof(*size) == src->read(size, sizeof(*size));
+}
+
+// Whether the rest of the stream, if its length is known, can hold pageCount entries of entrySize
+// bytes. Checked before allocating anything by the page count, which comes from the stream.
+bool has_room_for_pages(SkStreamSeekable* src, int pageCount, size_t entrySize) {
+    if (!src->hasLength() || !src->hasPosition()) {
+        return true;
+    }
+    const size_t position = src->getPosition(),
+                 length   = src->getLength();
+    return position <= length && (uint64_t)pageCount * entrySize <= length - position;
+}
+
+// Reads the byte count of each page, and returns where each page starts, followed by where the
+// last one ends.
+bool read_page_offsets(SkStreamSeekable* src, int pageCount, std::vector<size_t>* offsets) {
+    // Grown as the counts are read, as the stream may be shorter than pageCount says.
+    offsets->assign(1, 0);
+    for (int i = 0; i < pageCount; ++i) {
+        uint32_t byteCount;
+        if (!src->readU32(&byteCount)) {
+            return false;
+        }
+        offsets->push_back(byteCount);
+    }
+    (*offsets)[0] = src->getPosition();
+    for (int i = 0; i < pageCount; ++i) {
+        (*offsets)[i + 1] += (*offsets)[i];
+    }
+    return !src->hasLength() || offsets->back() <= src->getLength();
+}
+
+// Reads a version 2 document's pages, splitting the picture that draws them all. The stream must
+// be at the picture, following the page sizes.
+bool read_single_picture(SkStreamSeekable* src,
+                         SkDocumentPage* dstArray,
+                         int dstArrayCount,
+                         const SkDeserialProcs* procs) {
+    SkSize joined = {0.0f, 0.0f};
+    for (int i = 0; i < dstArrayCount; ++i) {
+        joined = SkSize{std::max(joined.width(), dstArray[i].fSize.width()),
+                        std::max(joined.height(), dstArray[i].fSize.height())};
+    }
+
+    auto picture = SkPicture::MakeFromStream(src, procs);
+    if (!picture) {
+        return false;
+    }
+
+    PagerCanvas canvas(joined.toCeil(), dstArray, dstArrayCount);
+    // Must call playback(), not drawPicture() to reach
+    // PagerCanvas::onDrawAnnotation().
+    picture->playback(&canvas);
+    if (canvas.fIndex != dstArrayCount) {
+        SkDEBUGF("Malformed SkMultiPictureDocument: canvas.fIndex=%d dstArrayCount=%d\n",
+            canvas.fIndex, dstArrayCount);
+    }
+    return true;
+}
+
+// Reads each page on its own, where the index says it starts.
+class IndexedReader final : public SkMultiPictureDocument::Reader {
+public:
+    IndexedReader(std::unique_ptr<SkStreamSeekable> stream,
+                  const SkDeserialProcs& procs,
+                  std::vector<SkSize> sizes,
+                  std::vector<size_t> offsets,
+                  int maxCachedPages)
+            : fStream(std::move(stream))
+            , fProcs(procs)
+            , fSizes(std::move(sizes))
+            , fOffsets(std::move(offsets))
+            , fCache(std::max(maxCachedPages, 1)) {}
+
+    int pageCount() const override { return SkToInt(fSizes.size()); }
+
+    SkSize pageSize(int i) const override {
+        return 0 <= i && i < this->pageCount() ? fSizes[i] : SkSize::MakeEmpty();
+    }
+
+    sk_sp<SkPicture> readPage(int i) override {
+        if (i < 0 || i >= this->pageCount()) {
+            return nullptr;
+        }
+        if (sk_sp<SkPicture>* page = fCache.find(i)) {
+            return *page;
+        }
+        const size_t offset = fOffsets[i],
+                     size   = fOffsets[i + 1] - offset;
+        sk_sp<SkPicture> page;
+        if (auto base = static_cast<const char*>(fStream->getMemoryBase())) {
+            page = SkPicture::MakeFromData(base + offset, size, &fProcs);
+        } else if (fStream->seek(offset)) {
+            sk_sp<SkData> data = SkData::MakeFromStream(fStream.get(), size);
+            page = data ? SkPicture::MakeFromData(data.get(), &fProcs) : nullptr;
+        }
+        if (page) {
+            fCache.insert(i, page);
+        }
+        return page;
+    }
+
+private:
+    std::unique_ptr<SkStreamSeekable> fStream;
+    const SkDeserialProcs fProcs;
+    const std::vector<SkSize> fSizes;
+    const std::vector<size_t> fOffsets;  // Where each page starts, then where the last ends.
+    SkLRUCache<int, sk_sp<SkPicture>> fCache;
+};
+
+// A version 2 document's pages can't be read on their own, so the first page read reads them all.
+class SinglePictureReader final : public SkMultiPictureDocument::Reader {
+public:
+    SinglePictureReader(std::unique_ptr<SkStreamSeekable> stream,
+                        const SkDeserialProcs& procs,
+                        const std::vector<SkSize>& sizes)
+            : fStream(std::move(stream)), fProcs(procs), fPages(sizes.size()) {
+        fPicturePosition = fStream->getPosition();
+        for (size_t i = 0; i < sizes.size(); ++i) {
+            fPages[i].fSize = sizes[i];
+        }
+    }
+
+    int pageCount() const override { return SkToInt(fPages.size()); }
+
+    SkSize pageSize(int i) const override {
+        return 0 <= i && i < this->pageCount() ? fPages[i].fSize : SkSize::MakeEmpty();
+    }
+
+    sk_sp<SkPicture> readPage(int i) override {
+        if (i < 0 || i >= this->pageCount()) {
+            return nullptr;
+        }
+        if (fStream) {
+            if (fStream->seek(fPicturePosition)) {
+                read_single_picture(fStream.get(), fPages.data(), this->pageCount(), &fProcs);
+            }
+            fStream.reset();
+        }
+        return fPages[i].fPicture;
+    }
+
+private:
+    std::unique_ptr<SkStreamSeekable> fStream;  // Until the pages are read.
+    size_t fPicturePosition;
+    const SkDeserialProcs fProcs;
+    std::vector<SkDocumentPage> fPages;
+};
+
 }  // namespace
 
 namespace SkMultiPictureDocument {
@@ -156,26 +332,10 @@ sk_sp<SkDocument> Make(SkWStream* dst,
 }
 
 int ReadPageCount(SkStreamSeekable* src) {
-    if (!src) {
-        return 0;
-    }
-    src->seek(0);
-    const size_t size = sizeof(kMagic) - 1;
-    char buffer[size];
-    if (size != src->read(buffer, size) || 0 != memcmp(kMagic, buffer, size)) {
-        src = nullptr;
-        return 0;
-    }
-    uint32_t versionNumber;
-    if (!src->readU32(&versionNumber) || versionNumber != kVersion) {
-        return 0;
-    }
-    uint32_t pageCount;
-    if (!src->readU32(&pageCount) || pageCount > INT_MAX) {
-        return 0;
-    }
+    uint32_t version;
+    int pageCount;
     // leave stream position right here.
-    return SkTo<int>(pageCount);
+    return read_header(src, &version, &pageCount) ? pageCount : 0;
 }
 
 bool ReadPageSizes(SkStreamSeekable* stream,
@@ -189,8 +349,7 @@ bool ReadPageSizes(SkStreamSeekable* stream,
         return false;
     }
     for (int i = 0; i < pageCount; ++i) {
-        SkSize& s = dstArray[i].fSize;
-        if (sizeof(s) != stream->read(&s, sizeof(s))) {
+        if (!read_size(stream, &dstArray[i].fSize)) {
             return false;
         }
     }
@@ -202,30 +361,68 @@ bool Read(SkStreamSeekable* src,
           SkDocumentPage* dstArray,
           int dstArrayCount,
           const SkDeserialProcs* procs) {
-    if (!ReadPageSizes(src, dstArray, dstArrayCount)) {
+    uint32_t version;
+    int pageCount;
+    if (!dstArray || !read_header(src, &version, &pageCount) || pageCount < 1 ||
+        pageCount != dstArrayCount) {
         return false;
     }
-    SkSize joined = {0.0f, 0.0f};
-    for (int i = 0; i < dstArrayCount; ++i) {
-        joined = SkSize{std::max(joined.width(), dstArray[i].fSize.width()),
-                        std::max(joined.height(), dstArray[i].fSize.height())};
+    for (int i = 0; i < pageCount; ++i) {
+        if (!read_size(src, &dstArray[i].fSize)) {
+            return false;
+        }
+    }
+    if (version == kSinglePictureVersion) {
+        return read_single_picture(src, dstArray, dstArrayCount, procs);
     }
 
-    auto picture = SkPicture::MakeFromStream(src, procs);
-    if (!picture) {
+    std::vector<size_t> offsets;
+    if (!read_page_offsets(src, pageCount, &offsets)) {
         return false;
     }
-
-    PagerCanvas canvas(joined.toCeil(), dstArray, dstArrayCount);
-    // Must call playback(), not drawPicture() to reach
-    // PagerCanvas::onDrawAnnotation().
-    picture->playback(&canvas);
-    if (canvas.fIndex != dstArrayCount) {
-        SkDEBUGF("Malformed SkMultiPictureDocument: canvas.fIndex=%d dstArrayCount=%d\n",
-            canvas.fIndex, dstArrayCount);
+    for (int i = 0; i < pageCount; ++i) {
+        sk_sp<SkData> data = SkData::MakeFromStream(src, offsets[i + 1] - offsets[i]);
+        dstArray[i].fPicture = data ? SkPicture::MakeFromData(data.get(), procs) : nullptr;
+        if (!dstArray[i].fPicture) {
+            return false;
+        }
     }
     return true;
 }
+
+std::unique_ptr<Reader> Reader::Make(std::unique_ptr<SkStreamSeekable> src,
+                                     const SkDeserialProcs* procs,
+                                     int maxCachedPages) {
+    uint32_t version;
+    int pageCount;
+    if (!read_header(src.get(), &version, &pageCount) || pageCount < 1) {
+        return nullptr;
+    }
+    // Each page has a size and, from version 3, a byte count.
+    const size_t entrySize = sizeof(SkSize) + (version == kVersion ? sizeof(uint32_t) : 0);
+    if (!has_room_for_pages(src.get(), pageCount, entrySize)) {
+        return nullptr;
+    }
+    std::vector<SkSize> sizes;
+    for (int i = 0; i < pageCount; ++i) {
+        SkSize size;
+        if (!read_size(src.get(), &size)) {
+            return nullptr;
+        }
+        sizes.push_back(size);
+    }
+    const SkDeserialProcs deserialProcs = procs ? *procs : SkDeserialProcs();
+    if (version == kSinglePictureVersion) {
+        return std::make_unique<SinglePictureReader>(std::move(src), deserialProcs, sizes);
+    }
+
+    std::vector<size_t> offsets;
+    if (!read_page_offsets(src.get(), pageCount, &offsets)) {
+        return nullptr;
+    }
+    return std::make_unique<IndexedReader>(std::move(src), deserialProcs, std::move(sizes),
+                                           std::move(offsets), maxCachedPages);
+}
 }  // namespace SkMultiPictureDocument
 
 sk_sp<SkDocument> SkMakeMultiPictureDocument(SkWStream* wStream, const SkSerialProcs* procs,
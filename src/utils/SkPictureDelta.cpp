@@ -0,0 +1,705 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/utils/SkPictureDelta.h"
+
+#include "include/core/SkCanvas.h"
+#include "include/core/SkData.h"
+#include "include/core/SkColorSpace.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkM44.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkPoint.h"
+#include "include/core/SkRRect.h"
+#include "include/core/SkRSXform.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRegion.h"
+#include "include/core/SkShader.h"
+#include "include/core/SkTextBlob.h"
+#include "include/core/SkTypeface.h"
+#include "include/core/SkVertices.h"
+#include "include/private/base/SkTo.h"
+#include "include/private/chromium/Slug.h"
+#include "include/utils/SkNWayCanvas.h"
+#include "src/core/SkBigPicture.h"
+#include "src/core/SkCanvasPriv.h"
+#include "src/core/SkChecksum.h"
+#include "src/core/SkDrawShadowInfo.h"
+#include "src/core/SkPicturePriv.h"
+#include "src/core/SkReadBuffer.h"
+#include "src/core/SkRecord.h"
+#include "src/core/SkRecordDraw.h"
+#include "src/core/SkRecorder.h"
+#include "src/core/SkRecords.h"
+#include "src/core/SkTHash.h"
+#include "src/core/SkTextBlobPriv.h"
+#include "src/core/SkVerticesPriv.h"
+#include "src/core/SkWriteBuffer.h"
+#include "src/utils/SkPatchUtils.h"
+
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+using namespace SkRecords;
+
+// A delta is:
+//   uint32   kMagic, kVersion
+//   uint32   the op count of the previous picture (0 if the delta stands alone)
+//   uint64   the hash of the previous picture's op hashes
+//   uint32   the op count of the new picture
+//   uint64   the hash of the new picture's op hashes, to check the next delta against
+//   rect     the cull rect of the new picture
+//   bytes    a serialized picture holding the ops of every kLiteral command (possibly empty)
+//   uint32   the command count, followed by the commands, each a Command and its arguments.
+// The new picture's ops are those the commands make, in order.
+static constexpr uint32_t kMagic   = SkSetFourByteTag('s', 'k', 'p', 'd');
+static constexpr uint32_t kVersion = 1;
+
+enum class Command : uint32_t {
+    kCopy,     // uint32 first, uint32 count: copy ops [first, first+count) of the previous picture.
+    kLiteral,  // uint32 count: take the next count ops of the serialized picture.
+    kSave,     // Save and Restore are not serialized: a picture must balance them.
+    kRestore,
+};
+
+namespace {
+
+void write_uint64(SkWriteBuffer* buffer, uint64_t value) {
+    buffer->writeUInt((uint32_t)value);
+    buffer->writeUInt((uint32_t)(value >> 32));
+}
+
+uint64_t read_uint64(SkReadBuffer* buffer) {
+    const uint64_t low = buffer->readUInt();
+    return low | (uint64_t)buffer->readUInt() << 32;
+}
+
+class ContentHasher;
+uint64_t hash_op(const SkRecord&, int i, ContentHasher*);
+
+uint64_t hash_picture(const std::vector<uint64_t>& opHashes) {
+    return SkChecksum::Hash64(opHashes.data(), opHashes.size() * sizeof(uint64_t));
+}
+
+// Keeps the hashes of images that can't be read back apart from those of their content.
+static constexpr uint64_t kUnreadableImageSeed = 0x756e72656164;
+
+uint64_t hash_image(const SkImage* image) {
+    const int32_t alphaType = image->alphaType();
+    if (sk_sp<SkData> encoded = image->refEncodedData()) {
+        return SkChecksum::Hash64(encoded->data(), encoded->size(), alphaType);
+    }
+    sk_sp<SkImage> raster = image->makeRasterImage(nullptr);
+    SkPixmap pixmap;
+    if (!raster || !raster->peekPixels(&pixmap)) {
+        // E.g. a texture, which can't be read back without its context.
+        const uint32_t id = image->uniqueID();
+        return SkChecksum::Hash64(&id, sizeof(id), kUnreadableImageSeed);
+    }
+    const SkImageInfo& info = pixmap.info();
+    const int32_t header[] = {info.width(), info.height(), info.colorType(), alphaType};
+    uint64_t hash = SkChecksum::Hash64(header, sizeof(header),
+                                       info.colorSpace() ? info.colorSpace()->hash() : 0);
+    for (int y = 0; y < info.height(); y++) {
+        hash = SkChecksum::Hash64(pixmap.addr(0, y), info.minRowBytes(), hash);
+    }
+    return hash;
+}
+
+// Hashes the content of the images, pictures and slugs that ops draw. Pictures read back from a
+// file (e.g. the frames of an MSKP) hold new objects each time, so their unique IDs never match
+// from one picture to the next. Hashes are remembered by unique ID for the next picture.
+class ContentHasher {
+public:
+    using Cache = std::unordered_map<uint64_t, uint64_t>;
+
+    explicit ContentHasher(const Cache& previous) : fPrevious(previous) {}
+
+    Cache detachCache() { return std::move(fCache); }
+
+    // Typefaces are written as their unique IDs; images and pictures nested in paints and other
+    // effects are written as their content hashes.
+    SkSerialProcs procs() {
+        SkSerialProcs procs;
+        procs.fImageProc = [](SkImage* image, void* ctx) {
+            return hash_data(static_cast<ContentHasher*>(ctx)->image(image));
+        };
+        procs.fImageCtx = this;
+        procs.fPictureProc = [](SkPicture* picture, void* ctx) {
+            return hash_data(static_cast<ContentHasher*>(ctx)->picture(picture));
+        };
+        procs.fPictureCtx = this;
+        procs.fTypefaceProc = [](SkTypeface* typeface, void*) {
+            const uint32_t id = typeface->uniqueID();
+            return SkData::MakeWithCopy(&id, sizeof(id));
+        };
+        return procs;
+    }
+
+    uint64_t image(const SkImage* image) {
+        return this->find(kImage, image->uniqueID(), [image] { return hash_image(image); });
+    }
+    uint64_t picture(const SkPicture* picture) {
+        return this->find(kPicture, picture->uniqueID(), [this, picture] {
+            const SkRect cull = picture->cullRect();
+            SkRecord record;
+            SkRecorder recorder(&record, cull);
+            picture->playback(&recorder);
+            std::vector<uint64_t> hashes;
+            hashes.push_back(SkChecksum::Hash64(&cull, sizeof(cull)));
+            for (int i = 0; i < record.count(); i++) {
+                hashes.push_back(hash_op(record, i, this));
+            }
+            return hash_picture(hashes);
+        });
+    }
+    uint64_t slug(const sktext::gpu::Slug* slug) {
+        return this->find(kSlug, slug->uniqueID(), [this, slug] {
+            sk_sp<SkData> data = slug->serialize(this->procs());
+            return SkChecksum::Hash64(data->data(), data->size());
+        });
+    }
+
+private:
+    // Images, pictures and slugs number their unique IDs separately.
+    enum Kind : uint64_t { kImage, kPicture, kSlug };
+
+    static sk_sp<SkData> hash_data(uint64_t hash) {
+        return SkData::MakeWithCopy(&hash, sizeof(hash));
+    }
+
+    template <typename Fn>
+    uint64_t find(Kind kind, uint32_t id, Fn&& hash) {
+        const uint64_t key = kind << 32 | id;
+        if (auto it = fCache.find(key); it != fCache.end()) {
+            return it->second;
+        }
+        auto it = fPrevious.find(key);
+        const uint64_t value = it != fPrevious.end() ? it->second : hash();
+        fCache[key] = value;
+        return value;
+    }
+
+    const Cache& fPrevious;
+    Cache fCache;
+};
+
+// Writes everything an op draws with into a buffer, to be hashed.
+class OpWriter {
+public:
+    OpWriter(SkWriteBuffer* buffer, ContentHasher* hasher) : fBuffer(buffer), fHasher(hasher) {}
+
+    template <typename T>
+    Type operator()(const T& op) {
+        this->write(op);
+        return T::kType;
+    }
+
+private:
+    // Save and Restore are matched by their type alone: a Restore's matrix follows from the ops
+    // before it.
+    void write(const NoOp&) {}
+    void write(const Restore&) {}
+    void write(const Save&) {}
+    void write(const SaveLayer& op) {
+        this->optional(op.bounds);
+        this->optional(op.paint);
+        fBuffer->writeFlattenable(op.backdrop.get());
+        fBuffer->writeUInt(op.saveLayerFlags);
+        fBuffer->writeScalar(op.backdropScale);
+        fBuffer->writeUInt(SkToU32(op.filters.size()));
+        for (size_t i = 0; i < op.filters.size(); i++) {
+            fBuffer->writeFlattenable(op.filters[i].get());
+        }
+    }
+    void write(const SaveBehind& op) { this->optional(op.subset); }
+
+    void write(const SetMatrix& op) { fBuffer->writeMatrix(op.matrix); }
+    void write(const SetM44& op) { fBuffer->write(op.matrix); }
+    void write(const Concat& op) { fBuffer->writeMatrix(op.matrix); }
+    void write(const Concat44& op) { fBuffer->write(op.matrix); }
+    void write(const Translate& op) {
+        fBuffer->writeScalar(op.dx);
+        fBuffer->writeScalar(op.dy);
+    }
+    void write(const Scale& op) {
+        fBuffer->writeScalar(op.sx);
+        fBuffer->writeScalar(op.sy);
+    }
+
+    void write(const ClipPath& op) {
+        fBuffer->writePath(op.path);
+        this->opAA(op.opAA);
+    }
+    void write(const ClipRRect& op) {
+        this->rrect(op.rrect);
+        this->opAA(op.opAA);
+    }
+    void write(const ClipRect& op) {
+        fBuffer->writeRect(op.rect);
+        this->opAA(op.opAA);
+    }
+    void write(const ClipRegion& op) {
+        fBuffer->writeRegion(op.region);
+        fBuffer->writeUInt((uint32_t)op.op);
+    }
+    void write(const ClipShader& op) {
+        fBuffer->writeFlattenable(op.shader.get());
+        fBuffer->writeUInt((uint32_t)op.op);
+    }
+    void write(const ResetClip&) {}
+
+    void write(const DrawArc& op) {
+        fBuffer->writePaint(op.paint);
+        fBuffer->writeRect(op.oval);
+        fBuffer->writeScalar(op.startAngle);
+        fBuffer->writeScalar(op.sweepAngle);
+        fBuffer->writeBool(op.useCenter);
+    }
+    void write(const DrawDRRect& op) {
+        fBuffer->writePaint(op.paint);
+        this->rrect(op.outer);
+        this->rrect(op.inner);
+    }
+    void write(const DrawDrawable& op) {
+        fBuffer->writeBool(op.matrix);
+        if (op.matrix) {
+            fBuffer->writeMatrix(*op.matrix);
+        }
+        fBuffer->writeRect(op.worstCaseBounds);
+        fBuffer->writeInt(op.index);
+    }
+    void write(const DrawImage& op) {
+        this->optional(op.paint);
+        this->image(op.image.get());
+        fBuffer->writeScalar(op.left);
+        fBuffer->writeScalar(op.top);
+        fBuffer->writeSampling(op.sampling);
+    }
+    void write(const DrawImageLattice& op) {
+        this->optional(op.paint);
+        this->image(op.image.get());
+        this->array<int>(op.xDivs, op.xCount);
+        this->array<int>(op.yDivs, op.yCount);
+        this->array<SkCanvas::Lattice::RectType>(op.flags, op.flagCount);
+        this->array<SkColor>(op.colors, op.flags ? op.flagCount : 0);
+        fBuffer->writeIRect(op.src);
+        fBuffer->writeRect(op.dst);
+        fBuffer->writeUInt((uint32_t)op.filter);
+    }
+    void write(const DrawImageRect& op) {
+        this->optional(op.paint);
+        this->image(op.image.get());
+        fBuffer->writeRect(op.src);
+        fBuffer->writeRect(op.dst);
+        fBuffer->writeSampling(op.sampling);
+        fBuffer->writeUInt(op.constraint);
+    }
+    void write(const DrawOval& op) {
+        fBuffer->writePaint(op.paint);
+        fBuffer->writeRect(op.oval);
+    }
+    void write(const DrawPaint& op) { fBuffer->writePaint(op.paint); }
+    void write(const DrawBehind& op) { fBuffer->writePaint(op.paint); }
+    void write(const DrawPath& op) {
+        fBuffer->writePaint(op.paint);
+        fBuffer->writePath(op.path);
+    }
+    void write(const DrawPicture& op) {
+        this->optional(op.paint);
+        write_uint64(fBuffer, fHasher->picture(op.picture.get()));
+        fBuffer->writeMatrix(op.matrix);
+    }
+    void write(const DrawPoints& op) {
+        fBuffer->writePaint(op.paint);
+        fBuffer->writeUInt(op.mode);
+        this->array<SkPoint>(op.pts, op.count);
+    }
+    void write(const DrawRRect& op) {
+        fBuffer->writePaint(op.paint);
+        this->rrect(op.rrect);
+    }
+    void write(const DrawRect& op) {
+        fBuffer->writePaint(op.paint);
+        fBuffer->writeRect(op.rect);
+    }
+    void write(const DrawRegion& op) {
+        fBuffer->writePaint(op.paint);
+        fBuffer->writeRegion(op.region);
+    }
+    void write(const DrawTextBlob& op) {
+        fBuffer->writePaint(op.paint);
+        SkTextBlobPriv::Flatten(*op.blob, *fBuffer);
+        fBuffer->writeScalar(op.x);
+        fBuffer->writeScalar(op.y);
+    }
+    void write(const DrawSlug& op) { write_uint64(fBuffer, fHasher->slug(op.slug.get())); }
+    void write(const DrawPatch& op) {
+        fBuffer->writePaint(op.paint);
+        this->array<SkPoint>(op.cubics, SkPatchUtils::kNumCtrlPts);
+        this->array<SkColor>(op.colors, SkPatchUtils::kNumCorners);
+        this->array<SkPoint>(op.texCoords, SkPatchUtils::kNumCorners);
+        fBuffer->writeUInt((uint32_t)op.bmode);
+    }
+    void write(const DrawAtlas& op) {
+        this->optional(op.paint);
+        this->image(op.atlas.get());
+        this->array<SkRSXform>(op.xforms, op.count);
+        this->array<SkRect>(op.texs, op.count);
+        this->array<SkColor>(op.colors, op.count);
+        fBuffer->writeUInt((uint32_t)op.mode);
+        fBuffer->writeSampling(op.sampling);
+        this->optional(op.cull);
+    }
+    void write(const DrawVertices& op) {
+        fBuffer->writePaint(op.paint);
+        op.vertices->priv().encode(*fBuffer);
+        fBuffer->writeUInt((uint32_t)op.bmode);
+    }
+    // Meshes are never sent (see SkPictureDeltaEncoder::encode()).
+    void write(const DrawMesh&) {}
+    void write(const DrawShadowRec& op) {
+        fBuffer->writePath(op.path);
+        fBuffer->writePoint3(op.rec.fZPlaneParams);
+        fBuffer->writePoint3(op.rec.fLightPos);
+        fBuffer->writeScalar(op.rec.fLightRadius);
+        fBuffer->writeColor(op.rec.fAmbientColor);
+        fBuffer->writeColor(op.rec.fSpotColor);
+        fBuffer->writeUInt(op.rec.fFlags);
+    }
+    void write(const DrawAnnotation& op) {
+        fBuffer->writeRect(op.rect);
+        fBuffer->writeString(std::string_view(op.key.c_str(), op.key.size()));
+        fBuffer->writeDataAsByteArray(op.value.get());
+    }
+    void write(const DrawEdgeAAQuad& op) {
+        fBuffer->writeRect(op.rect);
+        this->array<SkPoint>(op.clip, 4);
+        fBuffer->writeUInt(op.aa);
+        fBuffer->writeColor4f(op.color);
+        fBuffer->writeUInt((uint32_t)op.mode);
+    }
+    void write(const DrawEdgeAAImageSet& op) {
+        this->optional(op.paint);
+        for (int i = 0; i < op.count; i++) {
+            const SkCanvas::ImageSetEntry& entry = op.set[i];
+            this->image(entry.fImage.get());
+            fBuffer->writeRect(entry.fSrcRect);
+            fBuffer->writeRect(entry.fDstRect);
+            fBuffer->writeInt(entry.fMatrixIndex);
+            fBuffer->writeScalar(entry.fAlpha);
+            fBuffer->writeUInt(entry.fAAFlags);
+            fBuffer->writeBool(entry.fHasClip);
+        }
+        int clipCount, matrixCount;
+        SkCanvasPriv::GetDstClipAndMatrixCounts(op.set.get(), op.count, &clipCount, &matrixCount);
+        this->array<SkPoint>(op.dstClips, clipCount);
+        for (int i = 0; i < matrixCount; i++) {
+            fBuffer->writeMatrix(op.preViewMatrices[i]);
+        }
+        fBuffer->writeSampling(op.sampling);
+        fBuffer->writeUInt(op.constraint);
+    }
+
+    void optional(const SkRect* rect) {
+        fBuffer->writeBool(rect);
+        if (rect) {
+            fBuffer->writeRect(*rect);
+        }
+    }
+    void optional(const SkPaint* paint) {
+        fBuffer->writeBool(paint);
+        if (paint) {
+            fBuffer->writePaint(*paint);
+        }
+    }
+    void opAA(ClipOpAndAA opAA) {
+        fBuffer->writeUInt((uint32_t)opAA.op());
+        fBuffer->writeBool(opAA.aa());
+    }
+    void rrect(const SkRRect& rrect) {
+        char storage[SkRRect::kSizeInMemory];
+        rrect.writeToMemory(storage);
+        fBuffer->writePad32(storage, sizeof(storage));
+    }
+    void image(const SkImage* image) {
+        fBuffer->writeBool(image);
+        if (image) {
+            write_uint64(fBuffer, fHasher->image(image));
+        }
+    }
+    template <typename T>
+    void array(const T* array, int count) {
+        fBuffer->writeBool(array);
+        if (array) {
+            fBuffer->writeByteArray(array, count * sizeof(T));
+        }
+    }
+
+    SkWriteBuffer* fBuffer;
+    ContentHasher* fHasher;
+};
+
+struct OpType {
+    template <typename T>
+    Type operator()(const T&) { return T::kType; }
+};
+
+uint64_t hash_op(const SkRecord& record, int i, ContentHasher* hasher) {
+    char storage[1024];
+    SkBinaryWriteBuffer buffer(storage, sizeof(storage), hasher->procs());
+    const Type type = record.visit(i, OpWriter(&buffer, hasher));
+    if (buffer.usingInitialStorage()) {
+        return SkChecksum::Hash64(storage, buffer.bytesWritten(), type);
+    }
+    sk_sp<SkData> data = buffer.snapshotAsData();
+    return SkChecksum::Hash64(data->data(), data->size(), type);
+}
+
+// Forwards everything to a recorder, but leaves its own clip alone. SkPicturePlayback skips the
+// ops after a clip that leaves nothing visible, but the decoded picture needs every op that was
+// sent, so that the next delta can refer to them.
+class UnclippedForwarder final : public SkNWayCanvas {
+public:
+    UnclippedForwarder(SkCanvas* canvas, const SkIRect& bounds)
+            : SkNWayCanvas(std::max(bounds.right(), 1), std::max(bounds.bottom(), 1))
+            , fCanvas(canvas) {
+        this->addCanvas(canvas);
+    }
+
+protected:
+    void onClipRect(const SkRect& rect, SkClipOp op, ClipEdgeStyle edgeStyle) override {
+        fCanvas->clipRect(rect, op, kSoft_ClipEdgeStyle == edgeStyle);
+    }
+    void onClipRRect(const SkRRect& rrect, SkClipOp op, ClipEdgeStyle edgeStyle) override {
+        fCanvas->clipRRect(rrect, op, kSoft_ClipEdgeStyle == edgeStyle);
+    }
+    void onClipPath(const SkPath& path, SkClipOp op, ClipEdgeStyle edgeStyle) override {
+        fCanvas->clipPath(path, op, kSoft_ClipEdgeStyle == edgeStyle);
+    }
+    void onClipShader(sk_sp<SkShader> shader, SkClipOp op) override {
+        fCanvas->clipShader(std::move(shader), op);
+    }
+    void onClipRegion(const SkRegion& region, SkClipOp op) override {
+        fCanvas->clipRegion(region, op);
+    }
+
+private:
+    SkCanvas* fCanvas;
+};
+
+}  // namespace
+
+SkPictureDeltaEncoder::SkPictureDeltaEncoder(const SkSerialProcs& procs) : fProcs(procs) {}
+
+SkPictureDeltaEncoder::~SkPictureDeltaEncoder() = default;
+
+void SkPictureDeltaEncoder::reset() {
+    fHashes.clear();
+    fContentHashes.clear();
+}
+
+sk_sp<SkData> SkPictureDeltaEncoder::encode(const SkPicture* picture) {
+    // Record the picture afresh, so that its ops are the ones the decoder will record.
+    const SkRect cull = picture->cullRect();
+    SkRecord record;
+    SkRecorder recorder(&record, cull);
+    picture->playback(&recorder);
+
+    std::vector<int> ops;
+    std::vector<uint64_t> hashes;
+    ops.reserve(record.count());
+    hashes.reserve(record.count());
+    ContentHasher hasher(fContentHashes);
+    for (int i = 0; i < record.count(); i++) {
+        // Meshes can't be serialized, so they are left out, as SkPicture::serialize() leaves
+        // them out of pictures.
+        if (record.visit(i, OpType()) != DrawMesh_Type) {
+            ops.push_back(i);
+            hashes.push_back(hash_op(record, i, &hasher));
+        }
+    }
+
+    // Where each op first appears in the previous picture.
+    skia_private::THashMap<uint64_t, int> previous;
+    for (int i = (int)fHashes.size() - 1; i >= 0; i--) {
+        previous.set(fHashes[i], i);
+    }
+
+    struct Run {
+        Command fCommand;
+        int     fFirst;
+        int     fCount;
+    };
+    std::vector<Run> runs;
+    auto literals = sk_make_sp<SkRecord>();
+    SkRecorder literalRecorder(literals.get(), cull);
+    SkRecords::Draw drawLiteral(&literalRecorder, nullptr, nullptr, 0);
+    for (size_t i = 0; i < ops.size(); i++) {
+        const uint64_t hash = hashes[i];
+        // Extend a copy while the ops keep matching the previous picture's.
+        if (!runs.empty() && runs.back().fCommand == Command::kCopy) {
+            Run& run = runs.back();
+            const size_t next = run.fFirst + run.fCount;
+            if (next < fHashes.size() && fHashes[next] == hash) {
+                run.fCount++;
+                continue;
+            }
+        }
+        const Type type = record.visit(ops[i], OpType());
+        if (type == Save_Type || type == Restore_Type) {
+            runs.push_back({type == Save_Type ? Command::kSave : Command::kRestore, 0, 0});
+            continue;
+        }
+        if (const int* first = previous.find(hash)) {
+            runs.push_back({Command::kCopy, *first, 1});
+            continue;
+        }
+        record.visit(ops[i], drawLiteral);
+        if (!runs.empty() && runs.back().fCommand == Command::kLiteral) {
+            runs.back().fCount++;
+        } else {
+            runs.push_back({Command::kLiteral, 0, 1});
+        }
+    }
+
+    sk_sp<SkData> literalData;
+    if (literals->count() > 0) {
+        sk_sp<SkPicture> literalPicture = sk_make_sp<SkBigPicture>(
+                cull, literals, nullptr, nullptr, literalRecorder.approxBytesUsedBySubPictures());
+        literalData = literalPicture->serialize(&fProcs);
+    }
+
+    SkBinaryWriteBuffer buffer({});
+    buffer.writeUInt(kMagic);
+    buffer.writeUInt(kVersion);
+    buffer.writeUInt(SkToU32(fHashes.size()));
+    write_uint64(&buffer, hash_picture(fHashes));
+    buffer.writeUInt(SkToU32(ops.size()));
+    write_uint64(&buffer, hash_picture(hashes));
+    buffer.writeRect(cull);
+    buffer.writeDataAsByteArray(literalData.get());
+    buffer.writeUInt(SkToU32(runs.size()));
+    for (const Run& run : runs) {
+        buffer.writeUInt((uint32_t)run.fCommand);
+        if (run.fCommand == Command::kCopy) {
+            buffer.writeUInt(run.fFirst);
+        }
+        if (run.fCommand == Command::kCopy || run.fCommand == Command::kLiteral) {
+            buffer.writeUInt(run.fCount);
+        }
+    }
+
+    fHashes = std::move(hashes);
+    fContentHashes = hasher.detachCache();
+    return buffer.snapshotAsData();
+}
+
+SkPictureDeltaDecoder::SkPictureDeltaDecoder(const SkDeserialProcs& procs) : fProcs(procs) {}
+
+SkPictureDeltaDecoder::~SkPictureDeltaDecoder() = default;
+
+void SkPictureDeltaDecoder::reset() {
+    fLast = nullptr;
+    fLastHash = 0;
+}
+
+sk_sp<SkPicture> SkPictureDeltaDecoder::decode(const void* data, size_t length) {
+    SkReadBuffer buffer(data, length);
+    const uint32_t magic     = buffer.readUInt(),
+                   version   = buffer.readUInt(),
+                   prevCount = buffer.readUInt();
+    const uint64_t prevHash  = read_uint64(&buffer);
+    const uint32_t opCount   = buffer.readUInt();
+    const uint64_t hash      = read_uint64(&buffer);
+    const SkRect cull = buffer.readRect();
+    // fLast is always an SkBigPicture, made below.
+    const SkRecord* previous = prevCount && fLast ? SkPicturePriv::AsSkBigPicture(fLast)->record()
+                                                  : nullptr;
+    if (!buffer.validate(magic == kMagic && version == kVersion &&
+                         prevCount == (previous ? SkToU32(previous->count()) : 0) &&
+                         (!previous || prevHash == fLastHash))) {
+        return nullptr;
+    }
+
+    // Record the literal ops, leaving out the Saves and Restores that serialization wraps them
+    // in and that playback adds to balance them.
+    sk_sp<SkData> literalData = buffer.readByteArrayAsData();
+    SkRecord literals;
+    std::vector<int> literalOps;
+    if (literalData && literalData->size() > 0) {
+        sk_sp<SkPicture> literalPicture = SkPicture::MakeFromDataInPlace(literalData, &fProcs);
+        if (!literalPicture) {
+            return nullptr;
+        }
+        SkRecorder literalRecorder(&literals, literalPicture->cullRect());
+        UnclippedForwarder forwarder(&literalRecorder, literalPicture->cullRect().roundOut());
+        literalPicture->playback(&forwarder);
+        for (int i = 0; i < literals.count(); i++) {
+            const Type type = literals.visit(i, OpType());
+            if (type != Save_Type && type != Restore_Type) {
+                literalOps.push_back(i);
+            }
+        }
+    }
+
+    auto record = sk_make_sp<SkRecord>();
+    SkRecorder recorder(record.get(), cull);
+    SkRecords::Draw draw(&recorder, nullptr, nullptr, 0);
+    size_t nextLiteral = 0;
+    const uint32_t commandCount = buffer.readUInt();
+    for (uint32_t i = 0; i < commandCount && buffer.isValid(); i++) {
+        switch ((Command)buffer.readUInt()) {
+            case Command::kCopy: {
+                const uint32_t first = buffer.readUInt(),
+                               count = buffer.readUInt();
+                if (buffer.validate(first <= prevCount && count <= prevCount - first)) {
+                    for (uint32_t op = first; op < first + count; op++) {
+                        previous->visit(op, draw);
+                    }
+                }
+                break;
+            }
+            case Command::kLiteral: {
+                const uint32_t count = buffer.readUInt();
+                if (buffer.validate(count <= literalOps.size() - nextLiteral)) {
+                    for (uint32_t op = 0; op < count; op++) {
+                        literals.visit(literalOps[nextLiteral++], draw);
+                    }
+                }
+                break;
+            }
+            case Command::kSave:
+                recorder.save();
+                break;
+            case Command::kRestore:
+                buffer.validate(recorder.getSaveCount() > 1);
+                recorder.restore();
+                break;
+            default:
+                buffer.validate(false);
+                break;
+        }
+    }
+    // Every op must be there for the next delta to refer to.
+    if (!buffer.isValid() || SkToU32(record->count()) != opCount ||
+        nextLiteral != literalOps.size()) {
+        return nullptr;
+    }
+
+    fLast = sk_make_sp<SkBigPicture>(cull, std::move(record), nullptr, nullptr,
+                                     recorder.approxBytesUsedBySubPictures());
+    fLastHash = hash;
+    return fLast;
+}
@@ -8,8 +8,11 @@
 #include "include/codec/SkAndroidCodec.h"
 #include "include/codec/SkCodec.h"
 #include "include/codec/SkEncodedImageFormat.h"
+#include "include/codec/SkThumbnails.h"
+#include "include/core/SkBitmap.h"
 #include "include/core/SkColorSpace.h"
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSize.h"
@@ -23,8 +26,10 @@
 #include <cstdint>
 #include <cstring>
 #include <initializer_list>
+#include <iterator>
 #include <memory>
 #include <utility>
+#include <vector>
 
 static SkISize times(const SkISize& size, float factor) {
     return { (int) (size.width() * factor), (int) (size.height() * factor) };
@@ -272,3 +277,44 @@ DEF_TEST(AndroidCodec_PQ, r) {
     static constexpr skcms_Matrix3x3 kExpected = SkNamedGamut::kRec2020;
     REPORTER_ASSERT(r, 0 == memcmp(&matrix, &kExpected, sizeof(skcms_Matrix3x3)));
 }
+
+DEF_TEST(AndroidCodec_thumbnails, r) {
+    sk_sp<SkData> jpeg = GetResourceAsData("images/mandrill_512_q075.jpg");
+    sk_sp<SkData> png = GetResourceAsData("images/color_wheel.png");
+    if (!jpeg || !png) {
+        return;
+    }
+    const sk_sp<SkData> encoded[] = {
+        jpeg,
+        png,
+        nullptr,
+        SkData::MakeWithCString("not an image"),
+    };
+
+    // mandrill is 512x512, and color_wheel is 128x128.
+    const SkISize maxSize = {100, 200};
+    std::vector<SkBitmap> thumbs = SkThumbnails::Decode(encoded, maxSize);
+    REPORTER_ASSERT(r, thumbs.size() == std::size(encoded));
+    REPORTER_ASSERT(r, thumbs[0].dimensions() == SkISize::Make(100, 100));
+    REPORTER_ASSERT(r, thumbs[1].dimensions() == SkISize::Make(100, 100));
+    REPORTER_ASSERT(r, thumbs[2].drawsNothing());
+    REPORTER_ASSERT(r, thumbs[3].drawsNothing());
+
+    // Images that already fit are not enlarged.
+    thumbs = SkThumbnails::Decode(encoded, {1000, 1000});
+    REPORTER_ASSERT(r, thumbs[0].dimensions() == SkISize::Make(512, 512));
+
+    // Decoding on an executor gives the same results.
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(2);
+    SkThumbnails::Options options;
+    options.fExecutor = executor.get();
+    options.fMaxConcurrentDecodes = 2;
+    std::vector<SkBitmap> serial = SkThumbnails::Decode(encoded, maxSize);
+    std::vector<SkBitmap> parallel = SkThumbnails::Decode(encoded, maxSize, options);
+    for (size_t i = 0; i < serial.size(); i++) {
+        REPORTER_ASSERT(r, serial[i].info() == parallel[i].info());
+        REPORTER_ASSERT(r, serial[i].drawsNothing() ||
+                           0 == memcmp(serial[i].getPixels(), parallel[i].getPixels(),
+                                       serial[i].computeByteSize()));
+    }
+}
@@ -5,6 +5,7 @@
  * found in the LICENSE file.
  */
 
+#include "include/codec/SkAndroidCodec.h"
 #include "include/codec/SkCodec.h"
 #include "include/core/SkBitmap.h"
 #include "include/core/SkData.h"
@@ -14,6 +15,7 @@
 #include "include/core/SkString.h"
 #include "include/core/SkTypes.h"
 #include "include/private/base/SkDebug.h"
+#include "src/codec/SkCodecPriv.h"
 #include "tests/CodecPriv.h"
 #include "tests/FakeStreams.h"
 #include "tests/Test.h"
@@ -171,6 +173,86 @@ DEF_TEST(Codec_partialWuffs, r) {
     }
 }
 
+DEF_TEST(Codec_partialProgressiveJpeg, r) {
+    test_partial(r, "images/brickwork-texture.jpg");
+    test_partial(r, "images/flutter_logo.jpg");
+    test_partial(r, "images/b78329453.jpeg");
+
+    // Half of the file is enough for the early scans, so every row can be drawn already, albeit
+    // coarsely.
+    const char* path = "images/brickwork-texture.jpg";
+    sk_sp<SkData> file = GetResourceAsData(path);
+    if (!file) {
+        ERRORF(r, "missing %s", path);
+        return;
+    }
+    auto codec = SkCodec::MakeFromStream(std::make_unique<HaltingStream>(file, file->size() / 2));
+    if (!codec) {
+        ERRORF(r, "Failed to create codec for %s", path);
+        return;
+    }
+    const SkImageInfo info = standardize_info(codec.get());
+    SkBitmap bm;
+    bm.allocPixels(info);
+    REPORTER_ASSERT(r, SkCodec::kSuccess == codec->startIncrementalDecode(info, bm.getPixels(),
+                                                                          bm.rowBytes()));
+    int rowsDecoded = 0;
+    REPORTER_ASSERT(r, SkCodec::kIncompleteInput == codec->incrementalDecode(&rowsDecoded));
+    REPORTER_ASSERT(r, rowsDecoded == info.height());
+
+    // A single scan is left to the scanline decoder.
+    codec = SkCodec::MakeFromData(GetResourceAsData("images/mandrill_512_q075.jpg"));
+    if (codec) {
+        bm.allocPixels(standardize_info(codec.get()));
+        REPORTER_ASSERT(r, SkCodec::kUnimplemented ==
+                           codec->startIncrementalDecode(bm.info(), bm.getPixels(), bm.rowBytes()));
+    }
+}
+
+// SkAndroidCodec samples by 3 through the incremental decoder, writing only every third row of each
+// scan into a destination sized for the sampled image.
+DEF_TEST(Codec_progressiveJpegSampled, r) {
+    const char* path = "images/brickwork-texture.jpg";
+    sk_sp<SkData> file = GetResourceAsData(path);
+    SkBitmap truth;
+    if (!file || !create_truth(file, &truth)) {
+        ERRORF(r, "Failed to decode %s", path);
+        return;
+    }
+
+    constexpr int kSampleSize = 3;
+    SkAndroidCodec::AndroidOptions options;
+    options.fSampleSize = kSampleSize;
+    for (size_t length : {file->size(), file->size() / 2}) {
+        auto codec = SkAndroidCodec::MakeFromStream(std::make_unique<HaltingStream>(file, length));
+        if (!codec) {
+            ERRORF(r, "Failed to create codec for %s", path);
+            return;
+        }
+        const SkImageInfo info = SkImageInfo::MakeN32Premul(
+                codec->getSampledDimensions(kSampleSize));
+        SkBitmap bm;
+        bm.allocPixels(info);
+        const SkCodec::Result result = codec->getAndroidPixels(info, bm.getPixels(),
+                                                               bm.rowBytes(), &options);
+        if (length < file->size()) {
+            REPORTER_ASSERT(r, SkCodec::kIncompleteInput == result);
+            continue;
+        }
+        REPORTER_ASSERT(r, SkCodec::kSuccess == result);
+        for (int y = 0; y < info.height(); y++) {
+            for (int x = 0; x < info.width(); x++) {
+                const int srcX = get_start_coord(kSampleSize) + x * kSampleSize,
+                          srcY = get_start_coord(kSampleSize) + y * kSampleSize;
+                if (*bm.getAddr32(x, y) != *truth.getAddr32(srcX, srcY)) {
+                    ERRORF(r, "Sampled pixel (%d, %d) differs", x, y);
+                    return;
+                }
+            }
+        }
+    }
+}
+
 // Verify that when decoding an animated gif byte by byte we report the correct
 // fRequiredFrame as soon as getFrameInfo reports the frame.
 DEF_TEST(Codec_requiredFrame, r) {
@@ -1418,6 +1418,47 @@ DEF_TEST(Wuffs_seek_and_decode, r) {
 #endif
 }
 
+// Codecs read memory-backed streams (e.g. mmapped files) in place rather than copying them through
+// an intermediate buffer. Verify that decodes match those from a stream without a memory base.
+DEF_TEST(Codec_memoryStreamInPlace, r) {
+    for (const char* file : { "images/plane.png",
+                              "images/plane_interlaced.png",
+                              "images/yellow_rose.png",
+                              "images/flightAnim.gif",
+                              "images/randPixels.gif" }) {
+        sk_sp<SkData> data = GetResourceAsData(file);
+        if (!data) {
+            SkDebugf("Missing resources (%s). Set --resourcePath.\n", file);
+            continue;
+        }
+
+        auto decode = [&](std::unique_ptr<SkStream> stream, SkMD5::Digest* digest) {
+            std::unique_ptr<SkCodec> codec = SkCodec::MakeFromStream(
+                    std::move(stream), nullptr, nullptr,
+                    SkCodec::SelectionPolicy::kPreferStillImage);
+            if (!codec) {
+                ERRORF(r, "Failed to create codec for %s", file);
+                return false;
+            }
+            SkBitmap bm;
+            bm.allocPixels(codec->getInfo().makeColorType(kN32_SkColorType));
+            auto result = codec->getPixels(bm.pixmap());
+            if (result != SkCodec::kSuccess) {
+                ERRORF(r, "Failed to decode %s: %s", file, SkCodec::ResultToString(result));
+                return false;
+            }
+            *digest = md5(bm);
+            return true;
+        };
+
+        SkMD5::Digest inPlace, copied;
+        if (decode(SkMemoryStream::Make(data), &inPlace) &&
+            decode(std::make_unique<NotAssetMemStream>(data), &copied)) {
+            REPORTER_ASSERT(r, inPlace == copied, "%s", file);
+        }
+    }
+}
+
 // This test verifies that we fixed an assert statement that fired when reusing a png codec
 // after scaling.
 DEF_TEST(Codec_reusePng, r) {
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkColor.h"
+#include "include/core/SkData.h"
+#include "include/core/SkDecodedImageCache.h"
+#include "include/core/SkGraphics.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageGenerator.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkString.h"
+#include "include/core/SkUnPreMultiply.h"
+#include "include/private/base/SkMutex.h"
+#include "include/private/base/SkTemplates.h"
+#include "src/core/SkResourceCache.h"
+#include "tests/Test.h"
+
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace {
+
+// Produces a solid color, and counts how often it is asked to.
+class CountingGenerator : public SkImageGenerator {
+public:
+    CountingGenerator(sk_sp<SkData> encoded, SkColor color, int* decodeCount)
+            : SkImageGenerator(SkImageInfo::MakeN32Premul(8, 8))
+            , fEncoded(std::move(encoded))
+            , fColor(color)
+            , fDecodeCount(decodeCount) {}
+
+protected:
+    sk_sp<SkData> onRefEncodedData() override { return fEncoded; }
+
+    bool onGetPixels(const SkImageInfo& info, void* pixels, size_t rowBytes,
+                     const Options&) override {
+        (*fDecodeCount)++;
+        SkPMColor pm = SkPreMultiplyColor(fColor);
+        for (int y = 0; y < info.height(); y++) {
+            auto row = static_cast<SkPMColor*>(SkTAddOffset<void>(pixels, y * rowBytes));
+            for (int x = 0; x < info.width(); x++) {
+                row[x] = pm;
+            }
+        }
+        return true;
+    }
+
+private:
+    sk_sp<SkData> fEncoded;
+    SkColor       fColor;
+    int*          fDecodeCount;
+};
+
+class MemoryDecodedImageCache : public SkDecodedImageCache {
+public:
+    sk_sp<SkData> load(const SkData& key) override {
+        SkAutoMutexExclusive lock(fMutex);
+        auto it = fEntries.find(std::string((const char*)key.data(), key.size()));
+        return it == fEntries.end() ? nullptr : it->second;
+    }
+
+    void store(const SkData& key, const SkData& data) override {
+        SkAutoMutexExclusive lock(fMutex);
+        fEntries[std::string((const char*)key.data(), key.size())] =
+                SkData::MakeWithCopy(data.data(), data.size());
+    }
+
+private:
+    SkMutex fMutex;
+    std::map<std::string, sk_sp<SkData>> fEntries;
+};
+
+}  // namespace
+
+static SkColor read_first_pixel(const sk_sp<SkImage>& image, SkImage::CachingHint hint) {
+    SkPMColor pixel = 0;
+    SkImageInfo info = SkImageInfo::MakeN32Premul(1, 1);
+    if (!image->readPixels(nullptr, info, &pixel, sizeof(pixel), 0, 0, hint)) {
+        return SK_ColorTRANSPARENT;
+    }
+    return SkUnPreMultiply::PMColorToColor(pixel);
+}
+
+DEF_TEST(DecodedImageCache_Lazy, r) {
+    auto cache = sk_make_sp<MemoryDecodedImageCache>();
+    sk_sp<SkDecodedImageCache> previous = SkGraphics::SetDecodedImageCache(cache);
+
+    for (SkImage::CachingHint hint : {SkImage::kAllow_CachingHint,
+                                      SkImage::kDisallow_CachingHint}) {
+        SkResourceCache::PurgeAll();
+        sk_sp<SkData> encoded = SkData::MakeWithCString(
+                hint == SkImage::kAllow_CachingHint ? "allow" : "disallow");
+
+        // The first decode populates the second-tier cache.
+        int firstDecodes = 0;
+        sk_sp<SkImage> first = SkImages::DeferredFromGenerator(
+                std::make_unique<CountingGenerator>(encoded, SK_ColorBLUE, &firstDecodes));
+        REPORTER_ASSERT(r, read_first_pixel(first, hint) == SK_ColorBLUE);
+        REPORTER_ASSERT(r, firstDecodes == 1);
+
+        // A new image (with a new unique ID) over the same encoded data finds those pixels
+        // without decoding, even after the resource cache is purged. Its generator would
+        // produce a different color, were it asked.
+        SkResourceCache::PurgeAll();
+        int secondDecodes = 0;
+        sk_sp<SkImage> second = SkImages::DeferredFromGenerator(
+                std::make_unique<CountingGenerator>(encoded, SK_ColorRED, &secondDecodes));
+        REPORTER_ASSERT(r, read_first_pixel(second, hint) == SK_ColorBLUE);
+        REPORTER_ASSERT(r, secondDecodes == 0);
+    }
+
+    // Without encoded data there is no stable key, so every image decodes.
+    for (int i = 0; i < 2; i++) {
+        int decodes = 0;
+        sk_sp<SkImage> unkeyed = SkImages::DeferredFromGenerator(
+                std::make_unique<CountingGenerator>(nullptr, SK_ColorGREEN, &decodes));
+        REPORTER_ASSERT(r, read_first_pixel(unkeyed, SkImage::kDisallow_CachingHint) ==
+                           SK_ColorGREEN);
+        REPORTER_ASSERT(r, decodes == 1);
+    }
+
+    SkGraphics::SetDecodedImageCache(std::move(previous));
+}
+
+DEF_TEST(DecodedImageCache_File, r) {
+    SkString tmpDir = skiatest::GetTmpDir();
+    if (tmpDir.isEmpty()) {
+        return;
+    }
+    REPORTER_ASSERT(r, !SkDecodedImageCache::MakeFileCache(nullptr));
+
+    sk_sp<SkDecodedImageCache> cache = SkDecodedImageCache::MakeFileCache(tmpDir.c_str());
+    REPORTER_ASSERT(r, cache);
+    if (!cache) {
+        return;
+    }
+
+    sk_sp<SkData> key = SkData::MakeWithCString("DecodedImageCache_File");
+    sk_sp<SkData> pixels = SkData::MakeWithCString("not really pixels");
+    cache->store(*key, *pixels);
+
+    sk_sp<SkData> loaded = cache->load(*key);
+    REPORTER_ASSERT(r, loaded && loaded->equals(pixels.get()));
+    REPORTER_ASSERT(r, !cache->load(*SkData::MakeWithCString("missing")));
+}
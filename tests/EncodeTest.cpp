@@ -8,6 +8,7 @@
 #include "include/codec/SkCodec.h"
 #include "include/codec/SkEncodedImageFormat.h"
 #include "include/core/SkAlphaType.h"
+#include "include/core/SkBBHFactory.h"
 #include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
@@ -15,9 +16,14 @@
 #include "include/core/SkColorType.h"
 #include "include/core/SkData.h"
 #include "include/core/SkDataTable.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPictureRecorder.h"
 #include "include/core/SkPixmap.h"
+#include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkSurface.h"
@@ -37,6 +43,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstring>
 #include <initializer_list>
 #include <memory>
 #include <string>
@@ -188,6 +195,45 @@ DEF_TEST(Encode_JPG, r) {
     }
 }
 
+DEF_TEST(Encode_JpegParallel, r) {
+    SkBitmap bitmap;
+    if (!ToolUtils::GetResourceAsBitmap("images/mandrill_512.png", &bitmap)) {
+        return;
+    }
+    SkBitmap gray;
+    gray.allocPixels(bitmap.info().makeColorType(kGray_8_SkColorType));
+    REPORTER_ASSERT(r, bitmap.readPixels(gray.pixmap()));
+    SkBitmap small;
+    small.allocN32Pixels(100, 60);
+    small.eraseColor(SK_ColorCYAN);
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    for (const SkBitmap* src : {&bitmap, &gray, &small}) {
+        for (SkJpegEncoder::Downsample downsample : {SkJpegEncoder::Downsample::k420,
+                                                     SkJpegEncoder::Downsample::k444}) {
+            SkJpegEncoder::Options options;
+            options.fQuality = 90;
+            options.fDownsample = downsample;
+            SkDynamicMemoryWStream serial, parallel;
+            REPORTER_ASSERT(r, SkJpegEncoder::Encode(&serial, src->pixmap(), options));
+            options.fExecutor = executor.get();
+            REPORTER_ASSERT(r, SkJpegEncoder::Encode(&parallel, src->pixmap(), options));
+
+            // The bands use different Huffman tables, but the same coefficients.
+            SkBitmap serialBm, parallelBm;
+            REPORTER_ASSERT(r, ToolUtils::DecodeDataToBitmap(serial.detachAsData(), &serialBm));
+            REPORTER_ASSERT(r, ToolUtils::DecodeDataToBitmap(parallel.detachAsData(),
+                                                             &parallelBm));
+            bool same = serialBm.info() == parallelBm.info();
+            for (int y = 0; same && y < serialBm.height(); y++) {
+                same = !memcmp(serialBm.getAddr(0, y), parallelBm.getAddr(0, y),
+                               serialBm.info().minRowBytes());
+            }
+            REPORTER_ASSERT(r, same);
+        }
+    }
+}
+
 DEF_TEST(Encode_JpegDownsample, r) {
     SkBitmap bitmap;
     bool success = ToolUtils::GetResourceAsBitmap("images/mandrill_128.png", &bitmap);
@@ -343,6 +389,151 @@ DEF_TEST(Encode_PngOptions, r) {
     REPORTER_ASSERT(r, almost_equals(bm0, bm2, 0));
 }
 
+DEF_TEST(Encode_Bands, r) {
+    SkPictureRecorder recorder;
+    SkRTreeFactory factory;
+    SkCanvas* recording = recorder.beginRecording(SkRect::MakeWH(203, 150), &factory);
+    recording->clear(SK_ColorWHITE);
+    SkPaint paint;
+    for (int i = 0; i < 10; i++) {
+        paint.setColor(SkColorSetARGB(0xFF, 25 * i, 255 - 25 * i, 100));
+        recording->drawRect(SkRect::MakeXYWH(19 * i, 13 * i, 40, 35), paint);
+    }
+    sk_sp<SkPicture> picture = recorder.finishRecordingAsPicture();
+
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(203, 150);
+    SkCanvas(bitmap).drawPicture(picture);
+
+    auto encode = [](SkEncodedImageFormat format, SkWStream* dst, const SkPixmap& src,
+                     const SkImageInfo& info) -> std::unique_ptr<SkEncoder> {
+        if (format == SkEncodedImageFormat::kJPEG) {
+            return src.addr() ? SkJpegEncoder::Make(dst, src, {})
+                              : SkJpegEncoder::Make(dst, info, {});
+        }
+        return src.addr() ? SkPngEncoder::Make(dst, src, {}) : SkPngEncoder::Make(dst, info, {});
+    };
+
+    for (SkEncodedImageFormat format : {SkEncodedImageFormat::kJPEG, SkEncodedImageFormat::kPNG}) {
+        SkDynamicMemoryWStream whole, banded;
+        auto encoder = encode(format, &whole, bitmap.pixmap(), bitmap.info());
+        REPORTER_ASSERT(r, encoder && encoder->encodeRows(bitmap.height()));
+
+        // The same bytes, without the whole image ever being in memory.
+        encoder = encode(format, &banded, SkPixmap(), bitmap.info());
+        REPORTER_ASSERT(r, encoder);
+        if (!encoder) {
+            continue;
+        }
+        REPORTER_ASSERT(r, !encoder->encodeRows(16));  // There are no pixels to read.
+        REPORTER_ASSERT(r, encoder->encodeBands(16, SkEncoder::PictureRows(picture)));
+        sk_sp<SkData> expected = whole.detachAsData(), actual = banded.detachAsData();
+        REPORTER_ASSERT(r, expected->equals(actual.get()));
+
+        // Rows must match the image's width and color type.
+        SkDynamicMemoryWStream unused;
+        encoder = encode(format, &unused, SkPixmap(), bitmap.info());
+        SkBitmap narrow;
+        narrow.allocN32Pixels(100, 16);
+        REPORTER_ASSERT(r, encoder && !encoder->encodeRows(narrow.pixmap()));
+    }
+
+    // The fast PNG profile chooses its filter from the first band.
+    SkPngEncoder::Options options;
+    options.fProfile = SkPngEncoder::Profile::kFast;
+    SkDynamicMemoryWStream fast;
+    auto encoder = SkPngEncoder::Make(&fast, bitmap.info(), options);
+    REPORTER_ASSERT(r, encoder && encoder->encodeBands(32, SkEncoder::PictureRows(picture)));
+    SkBitmap decoded;
+    REPORTER_ASSERT(r, ToolUtils::DecodeDataToBitmap(fast.detachAsData(), &decoded));
+    REPORTER_ASSERT(r, almost_equals(bitmap, decoded, 0));
+}
+
+DEF_TEST(Encode_PngFastProfile, r) {
+    // Flat areas with sharp edges, like a screenshot.
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(300, 200);
+    SkCanvas canvas(bitmap);
+    canvas.clear(SK_ColorWHITE);
+    SkPaint paint;
+    paint.setColor(SK_ColorBLUE);
+    canvas.drawRect(SkRect::MakeXYWH(20, 20, 120, 40), paint);
+    paint.setColor(0x80FF0000);
+    canvas.drawCircle(200, 120, 60, paint);
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(2);
+    for (SkPngEncoder::FilterFlag filters : {SkPngEncoder::FilterFlag::kAll,
+                                             SkPngEncoder::FilterFlag::kPaeth}) {
+        SkPngEncoder::Options options;
+        options.fFilterFlags = filters;
+        SkDynamicMemoryWStream dflt, fast, fastParallel, fastIncremental;
+        REPORTER_ASSERT(r, SkPngEncoder::Encode(&dflt, bitmap.pixmap(), options));
+
+        options.fProfile = SkPngEncoder::Profile::kFast;
+        REPORTER_ASSERT(r, SkPngEncoder::Encode(&fast, bitmap.pixmap(), options));
+        std::unique_ptr<SkEncoder> encoder =
+                SkPngEncoder::Make(&fastIncremental, bitmap.pixmap(), options);
+        REPORTER_ASSERT(r, encoder && encoder->encodeRows(100) && encoder->encodeRows(100));
+        options.fExecutor = executor.get();
+        REPORTER_ASSERT(r, SkPngEncoder::Encode(&fastParallel, bitmap.pixmap(), options));
+
+        SkBitmap expected;
+        REPORTER_ASSERT(r, ToolUtils::DecodeDataToBitmap(dflt.detachAsData(), &expected));
+        for (SkDynamicMemoryWStream* stream : {&fast, &fastParallel, &fastIncremental}) {
+            SkBitmap actual;
+            REPORTER_ASSERT(r, ToolUtils::DecodeDataToBitmap(stream->detachAsData(), &actual));
+            REPORTER_ASSERT(r, almost_equals(expected, actual, 0));
+        }
+    }
+}
+
+DEF_TEST(Encode_PngParallel, r) {
+    SkBitmap bitmap;
+    if (!ToolUtils::GetResourceAsBitmap("images/mandrill_512.png", &bitmap)) {
+        return;
+    }
+
+    // Large enough to be split into several bands: 8 bytes per pixel, and premul to exercise the
+    // row transforms. Opaque F16 is left to libpng, and so is encoded serially.
+    SkBitmap f16;
+    f16.allocPixels(bitmap.info().makeColorType(kRGBA_F16_SkColorType)
+                                 .makeAlphaType(kPremul_SkAlphaType));
+    REPORTER_ASSERT(r, bitmap.readPixels(f16.pixmap()));
+    SkBitmap opaqueF16;
+    opaqueF16.allocPixels(f16.info().makeAlphaType(kOpaque_SkAlphaType));
+    REPORTER_ASSERT(r, bitmap.readPixels(opaqueF16.pixmap()));
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    for (const SkBitmap* src : {&bitmap, &f16, &opaqueF16}) {
+        for (SkPngEncoder::FilterFlag filters : {SkPngEncoder::FilterFlag::kAll,
+                                                 SkPngEncoder::FilterFlag::kSub,
+                                                 SkPngEncoder::FilterFlag::kNone}) {
+            for (int zlibLevel : {0, 1, 6}) {
+                SkPngEncoder::Options options;
+                options.fFilterFlags = filters;
+                options.fZLibLevel = zlibLevel;
+
+                SkDynamicMemoryWStream serial, parallel;
+                REPORTER_ASSERT(r, SkPngEncoder::Encode(&serial, src->pixmap(), options));
+                options.fExecutor = executor.get();
+                REPORTER_ASSERT(r, SkPngEncoder::Encode(&parallel, src->pixmap(), options));
+
+                SkBitmap serialBm, parallelBm;
+                REPORTER_ASSERT(r, ToolUtils::DecodeDataToBitmap(serial.detachAsData(),
+                                                                 &serialBm));
+                REPORTER_ASSERT(r, ToolUtils::DecodeDataToBitmap(parallel.detachAsData(),
+                                                                 &parallelBm));
+                bool same = serialBm.info() == parallelBm.info();
+                for (int y = 0; same && y < serialBm.height(); y++) {
+                    same = !memcmp(serialBm.getAddr(0, y), parallelBm.getAddr(0, y),
+                                   serialBm.info().minRowBytes());
+                }
+                REPORTER_ASSERT(r, same);
+            }
+        }
+    }
+}
+
 #ifndef SK_BUILD_FOR_GOOGLE3
 DEF_TEST(Encode_WebpQuality, r) {
     SkBitmap bm;
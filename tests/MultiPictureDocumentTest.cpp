@@ -22,6 +22,7 @@
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSamplingOptions.h"
+#include "include/core/SkSize.h"
 #include "include/core/SkSerialProcs.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkString.h"
@@ -181,6 +182,121 @@ DEF_TEST(SkMultiPictureDocument_Serialize_and_deserialize, reporter) {
     }
 }
 
+// Test reading the pages of a multi picture document on demand, and out of order.
+DEF_TEST(SkMultiPictureDocument_Reader, reporter) {
+    SkDynamicMemoryWStream stream;
+    sk_sp<SkDocument> multipic = SkMultiPictureDocument::Make(&stream);
+
+    static const int NUM_FRAMES = 5;
+    auto surface(SkSurfaces::Raster(SkImageInfo::MakeN32Premul(100, 100)));
+    surface->getCanvas()->clear(SK_ColorGREEN);
+    sk_sp<SkImage> image(surface->makeImageSnapshot());
+
+    std::vector<sk_sp<SkImage>> expectedImages;
+    for (int i = 0; i < NUM_FRAMES; i++) {
+        // Each page has its own size.
+        const SkImageInfo info = SkImageInfo::MakeN32Premul(200 + i, 256);
+        draw_basic(multipic->beginPage(info.width(), info.height()), i, image);
+        multipic->endPage();
+        auto surf = SkSurfaces::Raster(info);
+        draw_basic(surf->getCanvas(), i, image);
+        expectedImages.push_back(surf->makeImageSnapshot());
+    }
+    multipic->close();
+
+    auto reader = SkMultiPictureDocument::Reader::Make(stream.detachAsStream(), nullptr,
+                                                       /*maxCachedPages=*/2);
+    REPORTER_ASSERT(reporter, reader);
+    if (!reader) {
+        return;
+    }
+    REPORTER_ASSERT(reporter, reader->pageCount() == NUM_FRAMES);
+
+    for (int i : {3, 0, 4, 3, 1, 2}) {
+        REPORTER_ASSERT(reporter, reader->pageSize(i) == SkSize::Make(200 + i, 256));
+        sk_sp<SkPicture> page = reader->readPage(i);
+        REPORTER_ASSERT(reporter, page, "Failed to read page %d", i);
+        if (!page) {
+            continue;
+        }
+        auto surf = SkSurfaces::Raster(expectedImages[i]->imageInfo());
+        surf->getCanvas()->drawPicture(page);
+        auto img = surf->makeImageSnapshot();
+        REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(img.get(), expectedImages[i].get()),
+                        "Page %d is wrong", i);
+    }
+    REPORTER_ASSERT(reporter, !reader->readPage(-1));
+    REPORTER_ASSERT(reporter, !reader->readPage(NUM_FRAMES));
+
+    // Anything that isn't a multi picture document is rejected.
+    const char garbage[] = "Skia Multi-Picture Doc\n\n";
+    REPORTER_ASSERT(reporter, !SkMultiPictureDocument::Reader::Make(
+            std::make_unique<SkMemoryStream>(garbage, sizeof(garbage))));
+
+    // So is a page count the stream is too short for, before anything is allocated for it.
+    SkDynamicMemoryWStream truncated;
+    truncated.writeText("Skia Multi-Picture Doc\n\n");
+    truncated.write32(3);
+    truncated.write32(1 << 30);
+    truncated.write32(0);
+    REPORTER_ASSERT(reporter, !SkMultiPictureDocument::Reader::Make(truncated.detachAsStream()));
+}
+
+// Test reading a version 2 document, which has one picture drawing every page, each followed by
+// an end-of-page annotation. SkMultiPictureDocument::Make() no longer writes these.
+DEF_TEST(SkMultiPictureDocument_ReaderVersion2, reporter) {
+    static const int NUM_FRAMES = 3;
+    auto surface(SkSurfaces::Raster(SkImageInfo::MakeN32Premul(100, 100)));
+    surface->getCanvas()->clear(SK_ColorGREEN);
+    sk_sp<SkImage> image(surface->makeImageSnapshot());
+
+    SkPictureRecorder recorder;
+    SkCanvas* joined = recorder.beginRecording(SkRect::MakeWH(200 + NUM_FRAMES, 256));
+    std::vector<sk_sp<SkImage>> expectedImages;
+    for (int i = 0; i < NUM_FRAMES; i++) {
+        const SkImageInfo info = SkImageInfo::MakeN32Premul(200 + i, 256);
+        SkPictureRecorder pageRecorder;
+        draw_basic(pageRecorder.beginRecording(info.width(), info.height()), i, image);
+        joined->drawPicture(pageRecorder.finishRecordingAsPicture());
+        joined->drawAnnotation(SkRect::MakeEmpty(), "SkMultiPictureEndPage", nullptr);
+
+        auto surf = SkSurfaces::Raster(info);
+        draw_basic(surf->getCanvas(), i, image);
+        expectedImages.push_back(surf->makeImageSnapshot());
+    }
+
+    SkDynamicMemoryWStream stream;
+    stream.writeText("Skia Multi-Picture Doc\n\n");
+    stream.write32(2);
+    stream.write32(NUM_FRAMES);
+    for (int i = 0; i < NUM_FRAMES; i++) {
+        const SkSize size = SkSize::Make(200 + i, 256);
+        stream.write(&size, sizeof(size));
+    }
+    recorder.finishRecordingAsPicture()->serialize(&stream);
+
+    auto reader = SkMultiPictureDocument::Reader::Make(stream.detachAsStream());
+    REPORTER_ASSERT(reporter, reader);
+    if (!reader) {
+        return;
+    }
+    REPORTER_ASSERT(reporter, reader->pageCount() == NUM_FRAMES);
+
+    for (int i : {2, 0, 1}) {
+        REPORTER_ASSERT(reporter, reader->pageSize(i) == SkSize::Make(200 + i, 256));
+        sk_sp<SkPicture> page = reader->readPage(i);
+        REPORTER_ASSERT(reporter, page, "Failed to read page %d", i);
+        if (!page) {
+            continue;
+        }
+        auto surf = SkSurfaces::Raster(expectedImages[i]->imageInfo());
+        surf->getCanvas()->drawPicture(page);
+        auto img = surf->makeImageSnapshot();
+        REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(img.get(), expectedImages[i].get()),
+                        "Page %d is wrong", i);
+    }
+}
+
 
 #if defined(SK_GANESH) && defined(SK_BUILD_FOR_ANDROID) && __ANDROID_API__ >= 26
 
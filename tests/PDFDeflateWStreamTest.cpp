@@ -8,6 +8,8 @@
 #include "include/core/SkTypes.h"
 
 #ifdef SK_SUPPORT_PDF
+#include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkString.h"
 #include "include/private/base/SkDebug.h"
@@ -21,6 +23,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 
 using namespace skia_private;
@@ -177,4 +180,55 @@ DEF_TEST(SkPDF_DeflateWStream, r) {
     REPORTER_ASSERT(r, !emptyDeflateWStream.writeText("FOO"));
 }
 
+// Streams that span several parallel blocks, and ones that end on or just past a block
+// boundary, should inflate to their input for every profile, and with or without an executor.
+DEF_TEST(SkPDF_DeflateWStream_Parallel, r) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    SkRandom random(654321);
+    const size_t kBlock = SkDeflateWStream::kParallelBlockSize;
+    for (size_t size : {(size_t)1000, kBlock, kBlock + 1, 3 * kBlock + 12345}) {
+        // Compressible, but not trivially so.
+        AutoTMalloc<uint8_t> buffer(size);
+        for (size_t j = 0; j < size; ++j) {
+            buffer[j] = "PDF text 0123456789"[random.nextULessThan(19)];
+        }
+        for (SkDeflateWStream::Profile profile : {SkDeflateWStream::Profile::kFast,
+                                                  SkDeflateWStream::Profile::kDefault,
+                                                  SkDeflateWStream::Profile::kMax}) {
+            sk_sp<SkData> serial;
+            for (SkExecutor* exec : {(SkExecutor*)nullptr, executor.get()}) {
+                SkDynamicMemoryWStream dynamicMemoryWStream;
+                {
+                    SkDeflateWStream deflateWStream(&dynamicMemoryWStream, profile, false, exec);
+                    size_t j = 0;
+                    while (j < size) {
+                        size_t writeSize = std::min(size - j, (size_t)random.nextRangeU(1, 100000));
+                        REPORTER_ASSERT(r, deflateWStream.write(&buffer[j], writeSize));
+                        j += writeSize;
+                    }
+                    REPORTER_ASSERT(r, deflateWStream.bytesWritten() == size);
+                }
+                std::unique_ptr<SkStreamAsset> compressed(dynamicMemoryWStream.detachAsStream());
+                std::unique_ptr<SkStreamAsset> decompressed(stream_inflate(r, compressed.get()));
+                if (!decompressed || decompressed->getLength() != size) {
+                    ERRORF(r, "Parallel deflate of %zu bytes failed to round trip.", size);
+                    continue;
+                }
+                sk_sp<SkData> data = SkData::MakeFromStream(decompressed.get(), size);
+                REPORTER_ASSERT(r, data && 0 == memcmp(data->data(), buffer.get(), size));
+
+                // Streams that fit in one block are identical whether or not there's an executor.
+                compressed->rewind();
+                sk_sp<SkData> bytes = SkData::MakeFromStream(compressed.get(),
+                                                             compressed->getLength());
+                if (!exec) {
+                    serial = bytes;
+                } else if (size <= kBlock) {
+                    REPORTER_ASSERT(r, serial->equals(bytes.get()));
+                }
+            }
+        }
+    }
+}
+
 #endif
@@ -13,9 +13,14 @@
 #include "include/core/SkFont.h"
 #include "include/core/SkImage.h" // IWYU pragma: keep
 #include "include/core/SkPaint.h"
+#include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkSamplingOptions.h"
+#include "include/core/SkShader.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkString.h"
+#include "include/core/SkTextBlob.h"
+#include "include/core/SkTileMode.h"
 #include "include/docs/SkPDFDocument.h"
 #include "src/utils/SkOSPath.h"
 #include "tests/Test.h"
@@ -25,6 +30,7 @@
 #include <cstdio>
 #include <cstring>
 #include <memory>
+#include <string>
 
 static void test_empty(skiatest::Reporter* reporter) {
     SkDynamicMemoryWStream stream;
@@ -267,3 +273,236 @@ DEF_TEST(SkPDF_abort_jobs, rep) {
     doc->abort();
 }
 
+static sk_sp<SkData> make_pdf_with_fonts(SkExecutor* executor) {
+    SkPDF::Metadata metadata;
+    metadata.fExecutor = executor;
+    SkDynamicMemoryWStream stream;
+    auto doc = SkPDF::MakeDocument(&stream, metadata);
+    for (const char* resource : {"fonts/Roboto-Regular.ttf", "fonts/Em.ttf", "fonts/ahem.ttf"}) {
+        SkFont font(ToolUtils::CreateTypefaceFromResource(resource), 24);
+        if (!font.getTypeface()) {
+            continue;
+        }
+        for (int page = 0; page < 3; ++page) {
+            SkCanvas* canvas = doc->beginPage(612, 792);
+            canvas->drawString("The quick brown fox", 36, 72, font, SkPaint());
+            canvas->drawString(resource, 36, 144, ToolUtils::DefaultFont(), SkPaint());
+            doc->endPage();
+        }
+    }
+    doc->close();
+    return stream.detachAsData();
+}
+
+// Fonts are subset on the executor, but their objects are numbered as they would be without one,
+// so only the order objects appear in the file may change.
+DEF_TEST(SkPDF_executor_fonts, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_executor_fonts, r);
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool();
+    sk_sp<SkData> serial = make_pdf_with_fonts(nullptr);
+    sk_sp<SkData> threaded = make_pdf_with_fonts(executor.get());
+    REPORTER_ASSERT(r, serial->size() == threaded->size());
+    REPORTER_ASSERT(r, contains(threaded->bytes(), threaded->size(), "/ToUnicode"));
+
+    // Every object has the same number either way, so both cross reference tables list the same
+    // number of objects.
+    auto xref_entry_count = [](const SkData& pdf) -> std::string {
+        std::string s((const char*)pdf.bytes(), pdf.size());
+        size_t start = s.rfind("\nxref\n");
+        size_t end = s.find("\n", start + strlen("\nxref\n"));
+        return start == std::string::npos || end == std::string::npos
+                       ? std::string()
+                       : s.substr(start, end - start);
+    };
+    REPORTER_ASSERT(r, !xref_entry_count(*serial).empty());
+    REPORTER_ASSERT(r, xref_entry_count(*serial) == xref_entry_count(*threaded));
+}
+
+static int count(const SkData& data, const char needle[]) {
+    std::string s((const char*)data.bytes(), data.size());
+    int n = 0;
+    for (size_t i = s.find(needle); i != std::string::npos; i = s.find(needle, i + 1)) {
+        ++n;
+    }
+    return n;
+}
+
+// Images are deduplicated by their pixels, not by their IDs.
+DEF_TEST(SkPDF_image_content_dedup, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_image_content_dedup, r);
+    SkBitmap pixels;
+    pixels.allocN32Pixels(64, 64);
+    pixels.eraseColor(SK_ColorBLUE);
+    pixels.erase(SK_ColorRED, SkIRect::MakeXYWH(16, 16, 8, 8));
+
+    auto make_pdf = [&](bool tweakEveryOther) {
+        SkDynamicMemoryWStream stream;
+        auto doc = SkPDF::MakeDocument(&stream);
+        for (int page = 0; page < 4; ++page) {
+            SkBitmap copy;
+            copy.allocPixels(pixels.info());
+            pixels.readPixels(copy.pixmap());
+            if (tweakEveryOther && (page & 1)) {
+                copy.erase(SK_ColorGREEN, SkIRect::MakeXYWH(63, 63, 1, 1));
+            }
+            SkCanvas* canvas = doc->beginPage(200, 200);
+            // Each copy is a new SkImage, with a new ID.
+            canvas->drawImage(SkImages::RasterFromBitmap(copy), 0, 0);
+            SkPaint paint;
+            paint.setShader(SkImages::RasterFromBitmap(copy)->makeShader(
+                    SkTileMode::kRepeat, SkTileMode::kRepeat, SkSamplingOptions()));
+            canvas->drawRect({0, 100, 200, 200}, paint);
+            doc->endPage();
+        }
+        doc->close();
+        return stream.detachAsData();
+    };
+    sk_sp<SkData> same = make_pdf(false);
+    sk_sp<SkData> different = make_pdf(true);
+    REPORTER_ASSERT(r, count(*same, "/Subtype /Image") == 1);
+    REPORTER_ASSERT(r, count(*same, "/PatternType 1") == 1);
+    REPORTER_ASSERT(r, count(*different, "/Subtype /Image") == 2);
+    REPORTER_ASSERT(r, count(*different, "/PatternType 1") == 2);
+    REPORTER_ASSERT(r, same->size() < different->size());
+}
+
+// An incremental document writes each page as it ends, and still builds a complete page tree.
+DEF_TEST(SkPDF_incremental, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_incremental, r);
+    auto written = [](const SkDynamicMemoryWStream& stream) {
+        sk_sp<SkData> data = SkData::MakeUninitialized(stream.bytesWritten());
+        stream.copyTo(data->writable_data());
+        return data;
+    };
+    SkPDF::Metadata metadata;
+    metadata.fIncremental = true;
+    SkDynamicMemoryWStream stream;
+    auto doc = SkPDF::MakeDocument(&stream, metadata);
+    constexpr int kPages = 20;
+    for (int page = 0; page < kPages; ++page) {
+        SkCanvas* canvas = doc->beginPage(612, 792);
+        canvas->drawString("page", 36, 72, ToolUtils::DefaultFont(), SkPaint());
+        doc->endPage();
+        REPORTER_ASSERT(r, count(*written(stream), "/Type /Page\n") == page + 1);
+    }
+    doc->close();
+    sk_sp<SkData> pdf = stream.detachAsData();
+    REPORTER_ASSERT(r, count(*pdf, "/Type /Page\n") == kPages);
+    REPORTER_ASSERT(r, contains(pdf->bytes(), pdf->size(), "/Count 20"));
+    // Each page's parent has up to 8 of them, so the tree has three leaves and a root.
+    REPORTER_ASSERT(r, count(*pdf, "/Type /Pages\n") == 4);
+}
+
+static sk_sp<SkData> make_text_pdf(bool objectStreams,
+                                   SkPDF::Metadata::CompressionLevel compression) {
+    SkPDF::Metadata metadata;
+    metadata.fObjectStreams = objectStreams;
+    metadata.fCompressionLevel = compression;
+    SkDynamicMemoryWStream stream;
+    auto doc = SkPDF::MakeDocument(&stream, metadata);
+    for (int page = 0; page < 30; ++page) {
+        SkCanvas* canvas = doc->beginPage(612, 792);
+        canvas->drawString("Hello", 36, 72, ToolUtils::DefaultFont(), SkPaint());
+        SkPaint paint;
+        paint.setColor(SkColorSetARGB(0x80, 0xFF, 0, 0));
+        canvas->drawRect({36, 100, 136, 200}, paint);
+        doc->endPage();
+    }
+    doc->close();
+    return stream.detachAsData();
+}
+
+// Follows every entry of the cross-reference stream to the object it locates.
+DEF_TEST(SkPDF_object_streams, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_object_streams, r);
+    // Without compression, the cross-reference stream can be read directly.
+    sk_sp<SkData> data = make_text_pdf(true, SkPDF::Metadata::CompressionLevel::None);
+    const std::string pdf((const char*)data->bytes(), data->size());
+    REPORTER_ASSERT(r, pdf.compare(0, 9, "%PDF-1.5\n") == 0);
+    REPORTER_ASSERT(r, pdf.find("\nxref\n") == std::string::npos);
+
+    size_t startxref = pdf.rfind("startxref\n");
+    REPORTER_ASSERT(r, startxref != std::string::npos);
+    if (startxref == std::string::npos) {
+        return;
+    }
+    const size_t xref = std::stoul(pdf.substr(startxref + strlen("startxref\n")));
+    REPORTER_ASSERT(r, pdf.find("/Type /XRef", xref) < startxref);
+    REPORTER_ASSERT(r, pdf.find("/W [1 4 2]", xref) < startxref);
+    const size_t size = std::stoul(pdf.substr(pdf.find("/Size ", xref) + strlen("/Size ")));
+    const size_t length = std::stoul(pdf.substr(pdf.find("/Length ", xref) + strlen("/Length ")));
+    const size_t entries = pdf.find(" stream\n", xref) + strlen(" stream\n");
+    REPORTER_ASSERT(r, length == 7 * size);
+    if (length != 7 * size || entries + length > pdf.size()) {
+        return;
+    }
+
+    auto field = [&](size_t i, int offset, int bytes) {
+        uint32_t value = 0;
+        for (int b = 0; b < bytes; ++b) {
+            value = (value << 8) | (uint8_t)pdf[entries + 7 * i + offset + b];
+        }
+        return value;
+    };
+    auto starts_object = [&](uint32_t offset, size_t number) {
+        std::string header = std::to_string(number) + " 0 obj\n";
+        return offset < pdf.size() && pdf.compare(offset, header.size(), header) == 0;
+    };
+    REPORTER_ASSERT(r, field(0, 0, 1) == 0);
+    int packed = 0;
+    for (size_t i = 1; i < size; ++i) {
+        uint32_t type = field(i, 0, 1);
+        uint32_t value = field(i, 1, 4);
+        if (type == 1) {
+            REPORTER_ASSERT(r, starts_object(value, i), "object %zu", i);
+        } else {
+            REPORTER_ASSERT(r, type == 2, "object %zu", i);
+            // 'value' is the number of the object stream holding this object.
+            REPORTER_ASSERT(r, value < size && field(value, 0, 1) == 1);
+            uint32_t objectStream = field(value, 1, 4);
+            REPORTER_ASSERT(r, starts_object(objectStream, value));
+            REPORTER_ASSERT(r, pdf.compare(pdf.find("<<", objectStream),
+                                           strlen("<</Type /ObjStm"), "<</Type /ObjStm") == 0);
+            ++packed;
+        }
+    }
+    REPORTER_ASSERT(r, packed > 0);
+
+    // Packing small objects together lets them compress better.
+    sk_sp<SkData> classic = make_text_pdf(false, SkPDF::Metadata::CompressionLevel::Default);
+    sk_sp<SkData> packedPDF = make_text_pdf(true, SkPDF::Metadata::CompressionLevel::Default);
+    REPORTER_ASSERT(r, packedPDF->size() < classic->size());
+}
+
+// A table row drawn as one text blob, with a run per cell, is shown in a single text object: the
+// font is selected once, and the cells on the row are positioned with TJ adjustments.
+DEF_TEST(SkPDF_text_run_coalescing, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_text_run_coalescing, r);
+    SkFont font = ToolUtils::DefaultFont();
+    SkTextBlobBuilder builder;
+    const char* cells[] = {"Name", "Quantity", "Price", "Total"};
+    for (int i = 0; i < 4; ++i) {
+        size_t len = strlen(cells[i]);
+        int glyphCount = font.countText(cells[i], len, SkTextEncoding::kUTF8);
+        const auto& run = builder.allocRun(font, glyphCount, 36 + 120 * i, 72);
+        font.textToGlyphs(cells[i], len, SkTextEncoding::kUTF8, run.glyphs, glyphCount);
+    }
+    sk_sp<SkTextBlob> row = builder.make();
+    REPORTER_ASSERT(r, row);
+    if (!row) {
+        return;
+    }
+
+    SkDynamicMemoryWStream stream;
+    SkPDF::Metadata metadata;
+    metadata.fCompressionLevel = SkPDF::Metadata::CompressionLevel::None;
+    auto doc = SkPDF::MakeDocument(&stream, metadata);
+    doc->beginPage(612, 792)->drawTextBlob(row, 0, 0, SkPaint());
+    doc->close();
+    sk_sp<SkData> data = stream.detachAsData();
+
+    REPORTER_ASSERT(r, count(*data, "BT\n") == 1);
+    REPORTER_ASSERT(r, count(*data, " Tf\n") == 1);
+    REPORTER_ASSERT(r, count(*data, "] TJ\n") == 1);
+    REPORTER_ASSERT(r, count(*data, " Td ") == 1);
+}
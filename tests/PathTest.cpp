@@ -24,6 +24,7 @@
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkRegion.h"
 #include "include/core/SkScalar.h"
+#include "include/core/SkSerialProcs.h"
 #include "include/core/SkSize.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkStrokeRec.h"
@@ -5196,6 +5197,75 @@ DEF_TEST(PathRefSerialization, reporter) {
     }
 }
 
+static sk_sp<SkData> write_path(const SkPath& path, int precisionBits) {
+    SkSerialProcs procs;
+    procs.fPathPrecisionBits = precisionBits;
+    SkBinaryWriteBuffer buffer(procs);
+    buffer.writePath(path);
+    return buffer.snapshotAsData();
+}
+
+static SkPath read_path(const SkData& data) {
+    SkPath path;
+    SkReadBuffer buffer(data.data(), data.size());
+    buffer.readPath(&path);
+    return buffer.isValid() && buffer.eof() ? path : SkPath();
+}
+
+DEF_TEST(PathQuantizedSerialization, reporter) {
+    SkRandom rand;
+    SkPath path;
+    path.setFillType(SkPathFillType::kEvenOdd);
+    for (int contour = 0; contour < 20; contour++) {
+        path.moveTo(rand.nextRangeF(-500, 500), rand.nextRangeF(-500, 500));
+        for (int i = 0; i < 10; i++) {
+            path.rLineTo(rand.nextRangeF(-3, 3), rand.nextRangeF(-3, 3));
+        }
+        path.rCubicTo(3.1f, 4.1f, 5.9f, 2.6f, 5.3f, 5.8f);
+        path.rConicTo(9.7f, 9.3f, 2.3f, 8.4f, 0.6f);
+        path.close();
+    }
+
+    sk_sp<SkData> exact = write_path(path, 0),
+                  quantized = write_path(path, 4);
+    REPORTER_ASSERT(reporter, quantized->size() * 2 < exact->size(),
+                    "%zu vs %zu", quantized->size(), exact->size());
+    REPORTER_ASSERT(reporter, read_path(*exact) == path);
+
+    SkPath readBack = read_path(*quantized);
+    REPORTER_ASSERT(reporter, readBack.getFillType() == path.getFillType());
+    REPORTER_ASSERT(reporter, readBack.countVerbs() == path.countVerbs());
+    REPORTER_ASSERT(reporter, readBack.countPoints() == path.countPoints());
+    if (readBack.countVerbs() != path.countVerbs() ||
+        readBack.countPoints() != path.countPoints()) {
+        return;
+    }
+    REPORTER_ASSERT(reporter, !memcmp(SkPathPriv::VerbData(readBack), SkPathPriv::VerbData(path),
+                                      path.countVerbs()));
+    for (int i = 0; i < path.countPoints(); i++) {
+        const SkPoint d = readBack.getPoint(i) - path.getPoint(i);
+        REPORTER_ASSERT(reporter, std::abs(d.fX) <= 1 / 32.f && std::abs(d.fY) <= 1 / 32.f);
+    }
+    REPORTER_ASSERT(reporter, SkPathPriv::ConicWeightCnt(readBack) == 20 &&
+                              SkPathPriv::ConicWeightData(readBack)[0] == 0.6f);
+
+    // Quantizing again changes nothing.
+    REPORTER_ASSERT(reporter, write_path(readBack, 4)->equals(quantized.get()));
+
+    // Truncated data is rejected.
+    SkPath truncated;
+    REPORTER_ASSERT(reporter, !truncated.readFromMemory(quantized->data(), quantized->size() - 4));
+
+    // Paths that can't be quantized, or that are written more compactly already, stay exact.
+    SkPath huge = path;
+    huge.lineTo(1e30f, 0);
+    REPORTER_ASSERT(reporter, read_path(*write_path(huge, 4)) == huge);
+    const SkPath rrect = SkPath::RRect(SkRRect::MakeRectXY({0.3f, 0.6f, 10.1f, 20.7f}, 2, 3));
+    REPORTER_ASSERT(reporter, write_path(rrect, 4)->equals(write_path(rrect, 0).get()));
+    const SkPath rect = SkPath::Rect({0.3f, 0.6f, 10.1f, 20.7f});
+    REPORTER_ASSERT(reporter, read_path(*write_path(rect, 4)) == rect);
+}
+
 DEF_TEST(NonFinitePathIteration, reporter) {
     SkPath path;
     path.moveTo(SK_ScalarInfinity, SK_ScalarInfinity);
@@ -0,0 +1,186 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkData.h"
+#include "include/core/SkFont.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPictureRecorder.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkTextBlob.h"
+#include "include/utils/SkPictureDelta.h"
+#include "tests/Test.h"
+#include "tools/ToolUtils.h"
+#include "tools/fonts/FontToolUtils.h"
+
+// A grid of circles, one of them highlighted, with a square that moves across them.
+static sk_sp<SkPicture> make_frame(int frame) {
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(64, 64));
+    canvas->drawColor(SK_ColorWHITE);
+
+    const SkPath circle = SkPath::Circle(8, 8, 6);
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    for (int i = 0; i < 16; i++) {
+        paint.setColor(i == frame % 16 ? SK_ColorRED : SK_ColorBLUE);
+        canvas->save();
+        canvas->translate((i % 4) * 16, (i / 4) * 16);
+        canvas->clipRect(SkRect::MakeWH(16, 16));
+        canvas->drawPath(circle, paint);
+        canvas->restore();
+    }
+
+    canvas->saveLayerAlphaf(nullptr, 0.5f);
+    paint.setColor(SK_ColorGREEN);
+    canvas->drawRect(SkRect::MakeXYWH(frame * 4, frame * 2, 12, 12), paint);
+    canvas->restore();
+    return recorder.finishRecordingAsPicture();
+}
+
+// An image, a text blob and a nested picture, which stay the same, and a square that moves.
+static sk_sp<SkPicture> make_resource_frame(int frame,
+                                            const sk_sp<SkImage>& image,
+                                            const sk_sp<SkTextBlob>& blob,
+                                            const sk_sp<SkPicture>& nested) {
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(64, 64));
+    canvas->drawColor(SK_ColorWHITE);
+    canvas->drawImage(image, 0, 0);
+    canvas->drawTextBlob(blob, 4, 40, SkPaint());
+    canvas->translate(32, 0);
+    canvas->drawPicture(nested);
+    canvas->translate(-32, 0);
+    SkPaint paint;
+    paint.setColor(SK_ColorRED);
+    canvas->drawRect(SkRect::MakeXYWH(frame * 4, 48, 8, 8), paint);
+    return recorder.finishRecordingAsPicture();
+}
+
+static bool draw_same(const SkPicture* expected, const SkPicture* actual) {
+    SkBitmap expectedBitmap, actualBitmap;
+    expectedBitmap.allocN32Pixels(64, 64);
+    actualBitmap.allocN32Pixels(64, 64);
+    expectedBitmap.eraseColor(SK_ColorTRANSPARENT);
+    actualBitmap.eraseColor(SK_ColorTRANSPARENT);
+    SkCanvas(expectedBitmap).drawPicture(expected);
+    SkCanvas(actualBitmap).drawPicture(actual);
+    return ToolUtils::equal_pixels(expectedBitmap, actualBitmap);
+}
+
+DEF_TEST(PictureDelta_RoundTrip, r) {
+    SkPictureDeltaEncoder encoder;
+    SkPictureDeltaDecoder decoder;
+    size_t keyFrameBytes = 0;
+    for (int frame = 0; frame < 6; frame++) {
+        sk_sp<SkPicture> picture = make_frame(frame);
+        sk_sp<SkData> delta = encoder.encode(picture.get());
+        if (frame == 0) {
+            keyFrameBytes = delta->size();
+        } else {
+            // Only the two highlighted circles and the square change.
+            REPORTER_ASSERT(r, delta->size() < keyFrameBytes / 2,
+                            "%zu vs %zu", delta->size(), keyFrameBytes);
+        }
+
+        sk_sp<SkPicture> decoded = decoder.decode(delta->data(), delta->size());
+        REPORTER_ASSERT(r, decoded);
+        if (!decoded) {
+            return;
+        }
+        REPORTER_ASSERT(r, decoded->cullRect() == picture->cullRect());
+        REPORTER_ASSERT(r, draw_same(picture.get(), decoded.get()));
+    }
+}
+
+DEF_TEST(PictureDelta_Resources, r) {
+    SkFont font = ToolUtils::DefaultFont();
+    font.setSize(12);
+    sk_sp<SkTextBlob> blob = SkTextBlob::MakeFromString("Delta", font);
+
+    SkPictureDeltaEncoder encoder;
+    SkPictureDeltaDecoder decoder;
+    size_t keyFrameBytes = 0;
+    for (int frame = 0; frame < 4; frame++) {
+        // Each frame has its own copies of the image and nested picture, as frames read back from
+        // a file do. They match by content.
+        SkBitmap bitmap;
+        bitmap.allocN32Pixels(16, 16);
+        bitmap.eraseColor(SK_ColorMAGENTA);
+        bitmap.erase(SK_ColorCYAN, SkIRect::MakeWH(8, 8));
+        sk_sp<SkImage> image = bitmap.asImage();
+
+        SkPictureRecorder nestedRecorder;
+        SkCanvas* nestedCanvas = nestedRecorder.beginRecording(SkRect::MakeWH(32, 32));
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        paint.setColor(SK_ColorBLUE);
+        nestedCanvas->drawOval({4, 4, 28, 20}, paint);
+        nestedCanvas->drawCircle(16, 24, 4, paint);
+        sk_sp<SkPicture> nested = nestedRecorder.finishRecordingAsPicture();
+
+        sk_sp<SkPicture> picture = make_resource_frame(frame, image, blob, nested);
+        sk_sp<SkData> delta = encoder.encode(picture.get());
+        if (frame == 0) {
+            keyFrameBytes = delta->size();
+        } else {
+            // The image, text and nested picture are referred to, not sent again.
+            REPORTER_ASSERT(r, delta->size() < keyFrameBytes / 2,
+                            "%zu vs %zu", delta->size(), keyFrameBytes);
+        }
+
+        sk_sp<SkPicture> decoded = decoder.decode(delta->data(), delta->size());
+        REPORTER_ASSERT(r, decoded);
+        if (!decoded) {
+            return;
+        }
+        REPORTER_ASSERT(r, draw_same(picture.get(), decoded.get()), "frame %d", frame);
+    }
+}
+
+DEF_TEST(PictureDelta_Identical, r) {
+    SkPictureDeltaEncoder encoder;
+    SkPictureDeltaDecoder decoder;
+    sk_sp<SkPicture> picture = make_frame(3);
+    sk_sp<SkData> keyFrame = encoder.encode(picture.get());
+    sk_sp<SkData> delta = encoder.encode(make_frame(3).get());
+    REPORTER_ASSERT(r, delta->size() * 10 < keyFrame->size());
+
+    REPORTER_ASSERT(r, decoder.decode(keyFrame->data(), keyFrame->size()));
+    sk_sp<SkPicture> decoded = decoder.decode(delta->data(), delta->size());
+    REPORTER_ASSERT(r, decoded && draw_same(picture.get(), decoded.get()));
+}
+
+DEF_TEST(PictureDelta_Mismatch, r) {
+    SkPictureDeltaEncoder encoder;
+    SkPictureDeltaDecoder decoder;
+    sk_sp<SkData> frame0 = encoder.encode(make_frame(0).get());
+    sk_sp<SkData> frame1 = encoder.encode(make_frame(1).get());
+
+    // A delta can't be decoded without the picture it was encoded against...
+    REPORTER_ASSERT(r, !decoder.decode(frame1->data(), frame1->size()));
+    REPORTER_ASSERT(r, decoder.decode(frame0->data(), frame0->size()));
+    sk_sp<SkData> frame2 = encoder.encode(make_frame(2).get());
+    REPORTER_ASSERT(r, !decoder.decode(frame2->data(), frame2->size()));
+
+    // ... but one encoded after a reset can.
+    encoder.reset();
+    sk_sp<SkPicture> picture = make_frame(3);
+    sk_sp<SkData> frame3 = encoder.encode(picture.get());
+    sk_sp<SkPicture> decoded = decoder.decode(frame3->data(), frame3->size());
+    REPORTER_ASSERT(r, decoded && draw_same(picture.get(), decoded.get()));
+
+    // Garbage is rejected.
+    REPORTER_ASSERT(r, !decoder.decode(frame3->data(), frame3->size() / 2));
+    REPORTER_ASSERT(r, !decoder.decode(nullptr, 0));
+}
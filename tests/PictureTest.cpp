@@ -11,6 +11,8 @@
 #include "include/core/SkClipOp.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkData.h"
+#include "include/core/SkDrawable.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFont.h"
 #include "include/core/SkFontStyle.h"
 #include "include/core/SkImage.h" // IWYU pragma: keep
@@ -26,17 +28,22 @@
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSamplingOptions.h"
 #include "include/core/SkScalar.h"
+#include "include/core/SkSerialProcs.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkTypeface.h"
 #include "include/core/SkTypes.h"
 #include "src/base/SkRandom.h"
 #include "src/core/SkBigPicture.h"
+#include "src/core/SkPictureData.h"
 #include "src/core/SkPicturePriv.h"
 #include "src/core/SkRectPriv.h"
+#include "src/core/SkTaskGroup.h"
 #include "tests/Test.h"
+#include "tools/ToolUtils.h"
 #include "tools/fonts/FontToolUtils.h"
 
 #include <cstddef>
+#include <cstring>
 #include <memory>
 #include <vector>
 
@@ -924,3 +931,211 @@ DEF_TEST(Picture_nested_op_count, r) {
     check(make_pic(10, leaf1),  10,  10);
     check(make_pic(10, leaf10), 10, 100);
 }
+
+static SkBitmap draw_picture(const SkPicture* pic) {
+    SkBitmap bm;
+    bm.allocN32Pixels(100, 100);
+    bm.eraseColor(SK_ColorWHITE);
+    SkCanvas canvas(bm);
+    canvas.drawPicture(pic);
+    return bm;
+}
+
+DEF_TEST(Picture_MakeFromDataInPlace, r) {
+    SkPictureRecorder rec;
+    SkCanvas* c = rec.beginRecording({0,0, 100,100});
+    for (int i = 0; i < 4; i++) {
+        SkPath path;
+        path.moveTo(10*i, 0).lineTo(10*i + 30, 50).quadTo(50, 90, 10*i, 100).close();
+        c->drawPath(path, SkPaint(SkColor4f{0.25f*i, 0, 1, 1}));
+    }
+    sk_sp<SkPicture> inner = rec.finishRecordingAsPicture();
+
+    c = rec.beginRecording({0,0, 100,100});
+    c->drawString("Hello", 10, 60, ToolUtils::DefaultPortableFont(), SkPaint());
+    c->save();
+    c->translate(20, 20);
+    c->clipPath(SkPath::Circle(40, 40, 30), true);
+    c->drawPicture(inner);
+    c->restore();
+    c->drawPicture(inner);
+    sk_sp<SkPicture> outer = rec.finishRecordingAsPicture();
+
+    sk_sp<SkData> data = outer->serialize();
+    REPORTER_ASSERT(r, data);
+
+    sk_sp<SkPicture> copied = SkPicture::MakeFromData(data.get());
+    sk_sp<SkPicture> inPlace = SkPicture::MakeFromDataInPlace(data);
+    REPORTER_ASSERT(r, copied && inPlace);
+    if (!copied || !inPlace) {
+        return;
+    }
+    REPORTER_ASSERT(r, inPlace->cullRect() == outer->cullRect());
+    REPORTER_ASSERT(r, inPlace->approximateOpCount(true) > inPlace->approximateOpCount(false));
+
+    // The picture keeps the data it plays back from alive, and paths only need to be parsed once.
+    data = nullptr;
+    const SkBitmap expected = draw_picture(copied.get());
+    REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected, draw_picture(inPlace.get())));
+    REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected, draw_picture(inPlace.get())));
+
+    // It serializes like any other picture.
+    sk_sp<SkPicture> reserialized = SkPicture::MakeFromData(inPlace->serialize().get());
+    REPORTER_ASSERT(r, reserialized);
+    if (reserialized) {
+        REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected, draw_picture(reserialized.get())));
+    }
+
+    REPORTER_ASSERT(r, !SkPicture::MakeFromDataInPlace(nullptr));
+}
+
+DEF_TEST(Picture_MakeFromDataInPlace_invalid, r) {
+    SkPictureRecorder rec;
+    SkCanvas* c = rec.beginRecording({0,0, 100,100});
+    c->drawPath(SkPath::Circle(50, 50, 40), SkPaint());
+    c->drawRect({10,10, 20,20}, SkPaint());
+    sk_sp<SkData> data = rec.finishRecordingAsPicture()->serialize();
+
+    // Truncated data must either fail to load or draw safely.
+    for (size_t size = 0; size < data->size(); size++) {
+        if (sk_sp<SkPicture> pic = SkPicture::MakeFromDataInPlace(
+                    SkData::MakeSubset(data.get(), 0, size))) {
+            draw_picture(pic.get());
+        }
+    }
+
+    // Find the op data, and replace the first op with one of an unknown type.
+    const uint32_t readerTag = SK_PICT_READER_TAG;
+    size_t offset = 0;
+    while (offset + 12 <= data->size() && memcmp(data->bytes() + offset, &readerTag, 4)) {
+        offset++;
+    }
+    REPORTER_ASSERT(r, offset + 12 <= data->size());
+    if (offset + 12 > data->size()) {
+        return;
+    }
+    sk_sp<SkData> corrupt = SkData::MakeWithCopy(data->data(), data->size());
+    const uint32_t badOp = (0xffu << 24) | 4;
+    memcpy((char*)corrupt->writable_data() + offset + 8, &badOp, 4);
+    REPORTER_ASSERT(r, !SkPicture::MakeFromDataInPlace(corrupt));
+
+    // An op that claims to extend beyond the end of the op data is rejected too.
+    const uint32_t longOp = (DRAW_RECT << 24) | 0xfffff0;
+    memcpy((char*)corrupt->writable_data() + offset + 8, &longOp, 4);
+    REPORTER_ASSERT(r, !SkPicture::MakeFromDataInPlace(corrupt));
+}
+
+DEF_TEST(Picture_QuantizedPaths, r) {
+    SkPictureRecorder rec;
+    SkCanvas* c = rec.beginRecording({0,0, 100,100});
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    for (int i = 0; i < 4; i++) {
+        // On whole pixels, so that quantizing them changes nothing.
+        SkPath zigzag;
+        zigzag.moveTo(0, 10 + 20*i);
+        for (int x = 0; x <= 100; x += 5) {
+            zigzag.lineTo(x, 10 + 20*i + (x % 10));
+        }
+        paint.setColor(SkColor4f{0.25f*i, 0, 1, 1});
+        paint.setStyle(SkPaint::kStroke_Style);
+        c->drawPath(zigzag, paint);
+    }
+    // Rects stay exact, even off whole pixels.
+    paint.setStyle(SkPaint::kFill_Style);
+    c->drawPath(SkPath::Rect({10.3f, 20.6f, 40.1f, 50.7f}), paint);
+    sk_sp<SkPicture> picture = rec.finishRecordingAsPicture();
+
+    SkSerialProcs procs;
+    procs.fPathPrecisionBits = 4;
+    sk_sp<SkData> quantized = picture->serialize(&procs);
+    REPORTER_ASSERT(r, quantized->size() < picture->serialize()->size());
+
+    const SkBitmap expected = draw_picture(picture.get());
+    sk_sp<SkPicture> copied = SkPicture::MakeFromData(quantized.get());
+    sk_sp<SkPicture> inPlace = SkPicture::MakeFromDataInPlace(quantized);
+    REPORTER_ASSERT(r, copied && inPlace);
+    if (!copied || !inPlace) {
+        return;
+    }
+    REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected, draw_picture(copied.get())));
+    REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected, draw_picture(inPlace.get())));
+}
+
+namespace {
+class RectDrawable : public SkDrawable {
+public:
+    RectDrawable(const SkRect& rect, SkColor color) : fRect(rect), fColor(color) {}
+
+protected:
+    SkRect onGetBounds() override { return fRect; }
+    void onDraw(SkCanvas* canvas) override {
+        SkPaint paint;
+        paint.setColor(fColor);
+        canvas->drawRect(fRect, paint);
+    }
+
+private:
+    SkRect  fRect;
+    SkColor fColor;
+};
+}  // namespace
+
+// Draws into one 32x32 quadrant of a 64x64 picture, leaving its translate unbalanced.
+static void draw_quadrant(SkCanvas* canvas, int quadrant) {
+    static constexpr SkColor kColors[] = {SK_ColorRED, SK_ColorGREEN, SK_ColorBLUE, SK_ColorCYAN};
+    canvas->translate((quadrant % 2) * 32.0f, (quadrant / 2) * 32.0f);
+    SkPaint paint;
+    paint.setColor(kColors[quadrant]);
+    canvas->drawRect(SkRect::MakeLTRB(2, 2, 30, 14), paint);
+    sk_sp<SkDrawable> drawable =
+            sk_make_sp<RectDrawable>(SkRect::MakeLTRB(2, 18, 30, 30), kColors[3 - quadrant]);
+    canvas->drawDrawable(drawable.get());
+}
+
+DEF_TEST(Picture_concatenated, r) {
+    SkPictureRecorder whole;
+    SkCanvas* canvas = whole.beginRecording(SkRect::MakeWH(64, 64));
+    for (int i = 0; i < 4; i++) {
+        canvas->save();
+        draw_quadrant(canvas, i);
+        canvas->restore();
+    }
+    sk_sp<SkPicture> expected = whole.finishRecordingAsPicture();
+
+    std::unique_ptr<SkExecutor> pool = SkExecutor::MakeFIFOThreadPool(4);
+    for (SkExecutor* executor : {(SkExecutor*)nullptr, pool.get()}) {
+        SkRTreeFactory factory;
+        SkPictureRecorder recorders[4];
+        SkPictureRecorder* parts[4];
+        SkTaskGroup recording(*pool);
+        recording.batch(4, [&](int i) {
+            const SkRect quadrant = SkRect::MakeXYWH((i % 2) * 32.0f, (i / 2) * 32.0f, 32, 32);
+            draw_quadrant(recorders[i].beginRecording(quadrant, &factory), i);
+            parts[i] = &recorders[i];
+        });
+        recording.wait();
+        sk_sp<SkPicture> actual =
+                SkPictureRecorder::FinishRecordingAsConcatenatedPicture(parts, executor);
+
+        REPORTER_ASSERT(r, actual->cullRect() == SkRect::MakeWH(64, 64));
+        SkBitmap expectedBitmap, actualBitmap;
+        expectedBitmap.allocN32Pixels(64, 64);
+        actualBitmap.allocN32Pixels(64, 64);
+        expectedBitmap.eraseColor(SK_ColorWHITE);
+        actualBitmap.eraseColor(SK_ColorWHITE);
+        SkCanvas(expectedBitmap).drawPicture(expected);
+        SkCanvas(actualBitmap).drawPicture(actual);
+        REPORTER_ASSERT(r, ToolUtils::equal_pixels(expectedBitmap, actualBitmap));
+
+        // The concatenated BBH finds only the ops of the parts a query touches.
+        const SkBigPicture* big = SkPicturePriv::AsSkBigPicture(actual);
+        REPORTER_ASSERT(r, big && big->bbh());
+        std::vector<int> first, last;
+        big->bbh()->search(SkRect::MakeLTRB(0, 0, 32, 32), &first);
+        big->bbh()->search(SkRect::MakeLTRB(32, 32, 64, 64), &last);
+        REPORTER_ASSERT(r, !first.empty() && first.front() == 0);
+        REPORTER_ASSERT(r, !last.empty() && last.front() > first.back());
+        REPORTER_ASSERT(r, last.back() == big->record()->count() - 1);
+    }
+}
@@ -9,6 +9,7 @@
 #include "include/core/SkTypes.h"
 #include "include/private/base/SkTemplates.h"
 #include "src/base/SkRandom.h"
+#include "src/core/SkPackedRTree.h"
 #include "src/core/SkRTree.h"
 #include "tests/Test.h"
 
@@ -53,7 +54,7 @@ static bool verify_query(SkRect query, SkRect rects[], const std::vector<int>& f
 }
 
 static void run_queries(skiatest::Reporter* reporter, SkRandom& rand, SkRect rects[],
-                        const SkRTree& tree) {
+                        const SkBBoxHierarchy& tree) {
     for (size_t i = 0; i < NUM_QUERIES; ++i) {
         std::vector<int> hits;
         SkRect query = random_rect(rand);
@@ -97,3 +98,40 @@ DEF_TEST(RTree, reporter) {
                                   expectedDepthMax >= rtree.getDepth());
     }
 }
+
+DEF_TEST(PackedRTree, reporter) {
+    SkRandom rand;
+    AutoTArray<SkRect> rects(NUM_RECTS);
+    for (size_t i = 0; i < NUM_ITERATIONS; ++i) {
+        SkPackedRTree rtree;
+        REPORTER_ASSERT(reporter, 0 == rtree.getCount());
+
+        for (int j = 0; j < NUM_RECTS; j++) {
+            rects[j] = random_rect(rand);
+        }
+        // Empty rects are never found.
+        rects[i % NUM_RECTS].setEmpty();
+
+        rtree.insert(rects.data(), NUM_RECTS);
+
+        run_queries(reporter, rand, rects.data(), rtree);
+        REPORTER_ASSERT(reporter, NUM_RECTS - 1 == rtree.getCount());
+        // 199 rects fill 25 leaves, under 4 nodes, under the root.
+        REPORTER_ASSERT(reporter, 3 == rtree.getDepth());
+    }
+
+    // Trees of one node, and of no nodes.
+    for (int count : {0, 1, SkPackedRTree::kChildren}) {
+        SkPackedRTree rtree;
+        rtree.insert(rects.data(), count);
+        REPORTER_ASSERT(reporter, count == rtree.getCount());
+        REPORTER_ASSERT(reporter, (count ? 1 : 0) == rtree.getDepth());
+
+        std::vector<int> hits;
+        rtree.search({0, 0, 1000, 1000}, &hits);
+        REPORTER_ASSERT(reporter, count == (int)hits.size());
+        hits.clear();
+        rtree.search(SkRect::MakeEmpty(), &hits);
+        REPORTER_ASSERT(reporter, hits.empty());
+    }
+}
@@ -6,6 +6,7 @@
  */
 
 #include "include/core/SkBBHFactory.h"
+#include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkImageFilter.h"
@@ -14,6 +15,7 @@
 #include "include/core/SkMatrix.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkPicture.h"
+#include "include/core/SkPictureRecorder.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSurface.h"
@@ -25,6 +27,7 @@
 #include "src/core/SkRecords.h"
 #include "tests/RecordTestUtils.h"
 #include "tests/Test.h"
+#include "tools/ToolUtils.h"
 
 using namespace skia_private;
 
@@ -142,6 +145,94 @@ static bool sloppy_rect_eq(SkRect a, SkRect b) {
     return outset.contains(b) && !inset.contains(b);
 }
 
+static void draw_occlusion_scene(SkCanvas* canvas) {
+    SkPaint opaque;
+    opaque.setColor(SK_ColorBLUE);
+    SkPaint antiAliased;
+    antiAliased.setAntiAlias(true);
+
+    canvas->drawRect({10, 10, 20, 20}, opaque);              // 0: hidden by 6.
+    canvas->drawRect({30, 30, 40, 40}, antiAliased);         // 1: anti-aliased, hidden by 14.
+    canvas->save();                                          // 2
+        canvas->clipRect({0, 0, 50, 50});                    // 3
+        canvas->drawOval({20, 20, 30, 30}, opaque);          // 4: in a smaller clip, hidden by 6.
+    canvas->restore();                                       // 5
+    canvas->drawRect({0, 0, 60, 60}, opaque);                // 6: hidden by 14.
+    canvas->saveLayer(nullptr, nullptr);                     // 7
+        canvas->drawRect({0, 0, 100, 100}, antiAliased);     // 8: in a layer.
+    canvas->restore();                                       // 9
+    canvas->save();                                          // 10
+        canvas->clipRect({0, 0, 90, 90});                    // 11
+        canvas->drawPaint(opaque);                           // 12: in a smaller clip.
+    canvas->restore();                                       // 13
+    canvas->drawPaint(opaque);                               // 14
+    canvas->clipRect({0, 0, 80, 80}, true);                  // 15
+    canvas->drawRect({0, 0, 10, 10}, opaque);                // 16: in an anti-aliased clip.
+    canvas->drawPaint(opaque);                               // 17
+}
+
+DEF_TEST(RecordDraw_Occlusion, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, 100, 100);
+    draw_occlusion_scene(&recorder);
+    REPORTER_ASSERT(r, record.count() == 18);
+
+    AutoTArray<SkRect> bounds(record.count());
+    AutoTMalloc<SkBBoxHierarchy::Metadata> meta(record.count());
+    SkRecordFillBounds(SkRect::MakeWH(100, 100), record, bounds.data(), meta);
+    for (int i = 0; i < record.count(); i++) {
+        REPORTER_ASSERT(r, !meta[i].isOccluded);
+    }
+
+    SkRecordFillBounds(SkRect::MakeWH(100, 100), record, bounds.data(), meta, true);
+    for (int i = 0; i < record.count(); i++) {
+        const bool occluded = i == 0 || i == 1 || i == 4 || i == 6;
+        REPORTER_ASSERT(r, meta[i].isOccluded == occluded, "op %d", i);
+    }
+
+    // A layer that reads what's under it keeps those draws, even once something covers them.
+    SkRecord layers;
+    SkRecorder layerRecorder(&layers, 100, 100);
+    SkPaint opaque;
+    auto blur = SkImageFilters::Blur(5, 5, nullptr);
+    layerRecorder.drawRect({10, 10, 20, 20}, opaque);                                  // 0
+    layerRecorder.saveLayer(SkCanvas::SaveLayerRec(nullptr, nullptr, blur.get(), 0));  // 1
+    layerRecorder.restore();                                                           // 2
+    layerRecorder.drawRect({30, 30, 40, 40}, opaque);                                  // 3
+    layerRecorder.saveLayer(SkCanvas::SaveLayerRec(
+            nullptr, nullptr, SkCanvas::kInitWithPrevious_SaveLayerFlag));             // 4
+    layerRecorder.restore();                                                           // 5
+    layerRecorder.drawRect({50, 50, 60, 60}, opaque);                                  // 6: hidden.
+    layerRecorder.drawPaint(opaque);                                                   // 7
+    REPORTER_ASSERT(r, layers.count() == 8);
+
+    AutoTArray<SkRect> layerBounds(layers.count());
+    AutoTMalloc<SkBBoxHierarchy::Metadata> layerMeta(layers.count());
+    SkRecordFillBounds(SkRect::MakeWH(100, 100), layers, layerBounds.data(), layerMeta, true);
+    for (int i = 0; i < layers.count(); i++) {
+        REPORTER_ASSERT(r, layerMeta[i].isOccluded == (i == 6), "op %d", i);
+    }
+}
+
+DEF_TEST(RecordDraw_OcclusionPlayback, r) {
+    auto draw = [](bool cullOccluded) {
+        SkRTreeFactory factory;
+        SkPictureRecorder recorder;
+        recorder.setCullOccludedDraws(cullOccluded);
+        draw_occlusion_scene(recorder.beginRecording(SkRect::MakeWH(100, 100), &factory));
+        sk_sp<SkPicture> picture = recorder.finishRecordingAsPicture();
+
+        SkBitmap bitmap;
+        bitmap.allocN32Pixels(100, 100);
+        bitmap.eraseColor(SK_ColorWHITE);
+        SkCanvas canvas(bitmap);
+        canvas.clipRect({5, 5, 95, 95});
+        canvas.drawPicture(picture);
+        return bitmap;
+    };
+    REPORTER_ASSERT(r, ToolUtils::equal_pixels(draw(false), draw(true)));
+}
+
 // TODO This would be nice, but we can't get it right today.
 #if 0
 DEF_TEST(RecordDraw_BasicBounds, r) {
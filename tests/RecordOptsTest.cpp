@@ -9,13 +9,17 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkColorFilter.h"
+#include "include/core/SkImage.h"
 #include "include/core/SkImageFilter.h"
 #include "include/core/SkImageInfo.h"
+#include "include/core/SkM44.h"
+#include "include/core/SkMatrix.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkPicture.h"
 #include "include/core/SkPictureRecorder.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkSamplingOptions.h"
 #include "include/core/SkScalar.h"
 #include "include/core/SkSurface.h"
 #include "include/effects/SkImageFilters.h"
@@ -25,6 +29,7 @@
 #include "src/core/SkRecords.h"
 #include "tests/RecordTestUtils.h"
 #include "tests/Test.h"
+#include "tools/ToolUtils.h"
 
 #include <array>
 #include <cstddef>
@@ -359,6 +364,151 @@ DEF_TEST(RecordOpts_MergeSvgOpacityAndFilterLayers, r) {
     index += 4;
 }
 
+DEF_TEST(RecordOpts_NoopRedundantMatrices, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+    SkRect rect = SkRect::MakeWH(10, 10);
+
+    recorder.translate(10, 20);                  // Overwritten by the setMatrix().
+    recorder.translate(5, 5);                    // So is this.
+    recorder.setMatrix(SkMatrix::Scale(2, 2));
+    recorder.drawRect(rect, SkPaint());
+    recorder.save();
+        recorder.scale(3, 3);
+        recorder.drawRect(rect, SkPaint());
+        recorder.translate(1, 1);                // Restored before anything uses it.
+    recorder.restore();
+    recorder.concat(SkM44());                    // The identity.
+    recorder.drawRect(rect, SkPaint());
+
+    SkRecordNoopRedundantMatrices(&record);
+    assert_type<SkRecords::NoOp>(r, record, 0);
+    assert_type<SkRecords::NoOp>(r, record, 1);
+    assert_type<SkRecords::SetM44>(r, record, 2);
+    assert_type<SkRecords::DrawRect>(r, record, 3);
+    assert_type<SkRecords::Save>(r, record, 4);
+    assert_type<SkRecords::Scale>(r, record, 5);
+    assert_type<SkRecords::DrawRect>(r, record, 6);
+    assert_type<SkRecords::NoOp>(r, record, 7);
+    assert_type<SkRecords::Restore>(r, record, 8);
+    assert_type<SkRecords::NoOp>(r, record, 9);
+    assert_type<SkRecords::DrawRect>(r, record, 10);
+}
+
+DEF_TEST(RecordOpts_NoopOccludedDraws, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    SkPaint opaque;
+    SkPaint antiAliased;
+    antiAliased.setAntiAlias(true);
+    SkPaint translucent;
+    translucent.setColor(0x80000000);
+
+    recorder.drawRect({10, 10, 20, 20}, opaque);        // 0: hidden by 4.
+    recorder.drawOval({30, 30, 40, 40}, opaque);        // 1: hidden by 4.
+    recorder.drawRect({15, 15, 25, 25}, antiAliased);   // 2: might show at its edges.
+    recorder.drawRect({90, 90, 110, 110}, opaque);      // 3: not entirely under 4.
+    recorder.drawRect({0, 0, 100, 100}, opaque);        // 4
+    recorder.drawRect({10, 10, 20, 20}, opaque);        // 5: shows through 6.
+    recorder.drawRect({0, 0, 100, 100}, translucent);   // 6
+
+    recorder.clipRect({0, 0, 200, 200});                // 7
+    recorder.translate(50, 50);                         // 8
+    recorder.drawRect({0, 0, 10, 10}, opaque);          // 9: hidden by 10.
+    recorder.drawRect({-50, -50, 50, 50}, opaque);      // 10
+
+    recorder.clipRect({-50, -50, 150, 150});            // 11
+    recorder.drawRect({0, 0, 10, 10}, antiAliased);     // 12: hidden by 13.
+    recorder.drawPaint(opaque);                         // 13
+
+    recorder.clipRect({0, 0, 50, 50}, true);            // 14
+    recorder.drawRect({10, 10, 20, 20}, opaque);        // 15: shows at the edges of the clip.
+    recorder.drawPaint(opaque);                         // 16
+
+    SkRecordNoopOccludedDraws(&record);
+    assert_type<SkRecords::NoOp>    (r, record,  0);
+    assert_type<SkRecords::NoOp>    (r, record,  1);
+    assert_type<SkRecords::DrawRect>(r, record,  2);
+    assert_type<SkRecords::DrawRect>(r, record,  3);
+    assert_type<SkRecords::DrawRect>(r, record,  4);
+    assert_type<SkRecords::DrawRect>(r, record,  5);
+    assert_type<SkRecords::DrawRect>(r, record,  6);
+    assert_type<SkRecords::NoOp>    (r, record,  9);
+    assert_type<SkRecords::DrawRect>(r, record, 10);
+    assert_type<SkRecords::NoOp>    (r, record, 12);
+    assert_type<SkRecords::DrawPaint>(r, record, 13);
+    assert_type<SkRecords::DrawRect>(r, record, 15);
+    assert_type<SkRecords::DrawPaint>(r, record, 16);
+}
+
+DEF_TEST(RecordOpts_DropOccludedDrawsRecorder, r) {
+    auto record = [](bool drop) {
+        SkPictureRecorder recorder;
+        recorder.setDropOccludedDraws(drop);
+        SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(100, 100));
+        SkPaint paint;
+        paint.setColor(SK_ColorRED);
+        canvas->drawRect({10, 10, 20, 20}, paint);       // Hidden.
+        canvas->drawOval({30, 30, 40, 40}, paint);       // Hidden.
+        paint.setAntiAlias(true);
+        canvas->drawRect({15, 15, 25, 25}, paint);       // Might show at its edges.
+        paint.setAntiAlias(false);
+        paint.setColor(SK_ColorBLUE);
+        canvas->drawRect({0, 0, 50, 50}, paint);
+        return recorder.finishRecordingAsPicture();
+    };
+    sk_sp<SkPicture> kept = record(false),
+                     dropped = record(true);
+    REPORTER_ASSERT(r, kept->approximateOpCount() == 4);
+    REPORTER_ASSERT(r, dropped->approximateOpCount() == 2);
+
+    auto draw = [](const sk_sp<SkPicture>& picture) {
+        sk_sp<SkSurface> surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(100, 100));
+        surface->getCanvas()->clear(SK_ColorWHITE);
+        surface->getCanvas()->drawPicture(picture);
+        return surface->makeImageSnapshot();
+    };
+    REPORTER_ASSERT(r, ToolUtils::equal_pixels(draw(kept).get(), draw(dropped).get()));
+}
+
+DEF_TEST(RecordOpts_MergeDrawImageRects, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    sk_sp<SkImage> image = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(20, 20))
+                                   ->makeImageSnapshot();
+    const SkRect src = SkRect::MakeWH(20, 20);
+    const SkSamplingOptions sampling;
+    SkPaint translucent;
+    translucent.setAlphaf(0.5f);
+
+    // Four tiles of a 40x40 square, then one far away.
+    for (SkPoint p : {SkPoint{0, 0}, {20, 0}, {0, 20}, {20, 20}, {1000, 1000}}) {
+        recorder.drawImageRect(image, src, src.makeOffset(p), sampling, nullptr,
+                               SkCanvas::kFast_SrcRectConstraint);
+    }
+    recorder.clipRect(SkRect::MakeWH(100, 100));
+    // Different paints.
+    recorder.drawImageRect(image, src, src, sampling, nullptr, SkCanvas::kFast_SrcRectConstraint);
+    recorder.drawImageRect(image, src, src, sampling, &translucent,
+                           SkCanvas::kFast_SrcRectConstraint);
+
+    SkRecordMergeDrawImageRects(&record);
+    auto set = assert_type<SkRecords::DrawEdgeAAImageSet>(r, record, 0);
+    REPORTER_ASSERT(r, set->count == 4);
+    REPORTER_ASSERT(r, !set->paint);
+    REPORTER_ASSERT(r, set->set[3].fImage == image);
+    REPORTER_ASSERT(r, set->set[3].fDstRect == SkRect::MakeXYWH(20, 20, 20, 20));
+    REPORTER_ASSERT(r, set->set[3].fAAFlags == SkCanvas::kNone_QuadAAFlags);
+    for (int i = 1; i < 4; i++) {
+        assert_type<SkRecords::NoOp>(r, record, i);
+    }
+    assert_type<SkRecords::DrawImageRect>(r, record, 4);
+    assert_type<SkRecords::DrawImageRect>(r, record, 6);
+    assert_type<SkRecords::DrawImageRect>(r, record, 7);
+}
+
 static void do_draw(SkCanvas* canvas, SkColor color, bool doLayer) {
     canvas->drawColor(SK_ColorWHITE);
 
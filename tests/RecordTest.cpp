@@ -5,12 +5,21 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
 #include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPictureRecorder.h"
+#include "include/core/SkPoint.h"
 #include "include/core/SkRect.h"
 #include "src/core/SkRecord.h"
+#include "src/core/SkRecorder.h"
 #include "src/core/SkRecords.h"
 #include "tests/RecordTestUtils.h"
 #include "tests/Test.h"
+#include "tools/ToolUtils.h"
 
 #include <cstdint>
 #include <new>
@@ -117,3 +126,73 @@ DEF_TEST(Record_Alignment, r) {
         REPORTER_ASSERT(r, is_aligned(record.alloc<uint64_t>()));
     }
 }
+
+DEF_TEST(Record_compact, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, 100, 100);
+
+    const SkRect bounds = SkRect::MakeLTRB(10, 10, 90, 90);
+    SkPaint layerPaint;
+    layerPaint.setAlpha(0x80);
+    recorder.saveLayer(&bounds, &layerPaint);
+    const SkPoint pts[] = {{1, 2}, {3, 4}, {5, 6}};
+    recorder.drawPoints(SkCanvas::kPolygon_PointMode, 3, pts, SkPaint());
+    SkPath path = SkPath::Circle(50, 50, 20);
+    recorder.drawPath(path, SkPaint());
+    recorder.drawPath(SkPath::Circle(50, 50, 20), SkPaint());
+    recorder.restore();
+    REPORTER_ASSERT(r, record.count() == 5);
+
+    const size_t before = record.bytesUsed();
+    record.compact();
+    REPORTER_ASSERT(r, record.count() == 5);
+    REPORTER_ASSERT(r, record.bytesUsed() <= before);
+
+    auto saveLayer = assert_type<SkRecords::SaveLayer>(r, record, 0);
+    REPORTER_ASSERT(r, *saveLayer->bounds == bounds);
+    REPORTER_ASSERT(r, saveLayer->paint->getAlpha() == 0x80);
+
+    auto points = assert_type<SkRecords::DrawPoints>(r, record, 1);
+    REPORTER_ASSERT(r, points->count == 3);
+    REPORTER_ASSERT(r, points->pts[2] == pts[2]);
+
+    // The second path was recorded separately, but now shares the first's points.
+    auto first  = assert_type<SkRecords::DrawPath>(r, record, 2),
+         second = assert_type<SkRecords::DrawPath>(r, record, 3);
+    REPORTER_ASSERT(r, first->path == path);
+    REPORTER_ASSERT(r, first->path.getGenerationID() == second->path.getGenerationID());
+
+    assert_type<SkRecords::Restore>(r, record, 4);
+}
+
+DEF_TEST(Record_compact_Picture, r) {
+    auto record = [](bool compact) {
+        SkPictureRecorder recorder;
+        recorder.setCompactRecording(compact);
+        SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(64, 64));
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        for (int i = 0; i < 20; i++) {
+            paint.setColor(i % 2 ? SK_ColorRED : SK_ColorBLUE);
+            canvas->save();
+            canvas->translate(i * 3.0f, 0);
+            canvas->drawPath(SkPath::Circle(5, 5 + i * 2.0f, 4), paint);
+            canvas->drawRect(SkRect::MakeXYWH(0, i * 3.0f, 4, 2), paint);
+            canvas->restore();
+        }
+        return recorder.finishRecordingAsPicture();
+    };
+    sk_sp<SkPicture> loose     = record(false),
+                     compacted = record(true);
+    REPORTER_ASSERT(r, loose->approximateOpCount() == compacted->approximateOpCount());
+    REPORTER_ASSERT(r, compacted->approximateBytesUsed() < loose->approximateBytesUsed());
+
+    SkBitmap expected, actual;
+    expected.allocN32Pixels(64, 64);
+    actual.allocN32Pixels(64, 64);
+    expected.eraseColor(SK_ColorWHITE);
+    actual.eraseColor(SK_ColorWHITE);
+    SkCanvas(expected).drawPicture(loose);
+    SkCanvas(actual).drawPicture(compacted);
+    REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected, actual));
+}
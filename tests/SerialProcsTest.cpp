@@ -5,16 +5,19 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkData.h"
 #include "include/core/SkDataTable.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFont.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkPicture.h"
 #include "include/core/SkPictureRecorder.h"
+#include "include/core/SkPixmap.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSamplingOptions.h"
@@ -32,9 +35,12 @@
 #include "tools/fonts/FontToolUtils.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <functional>
 #include <iterator>
+#include <memory>
+#include <optional>
 
 static sk_sp<SkImage> picture_to_image(const sk_sp<SkPicture>& pic) {
     SkIRect r = pic->cullRect().round();
@@ -234,3 +240,91 @@ DEF_TEST(serial_typeface, reporter) {
     REPORTER_ASSERT(reporter, counter == 2);
 }
 
+static sk_sp<SkImage> make_solid_image(SkColor color) {
+    SkBitmap bm;
+    bm.allocN32Pixels(16, 16);
+    bm.eraseColor(color);
+    bm.setImmutable();
+    return bm.asImage();
+}
+
+DEF_TEST(serial_procs_image_executor, reporter) {
+    // The nested picture needs enough ops that drawPicture() doesn't unroll it.
+    auto nested = make_pic([](SkCanvas* c) {
+        for (int i = 0; i < 20; ++i) {
+            c->drawImage(make_solid_image(SkColorSetRGB(0, 10*i, 255)), 8*i, 100);
+        }
+    });
+    auto pic = make_pic([nested](SkCanvas* c) {
+        for (int i = 0; i < 16; ++i) {
+            c->drawImage(make_solid_image(SkColorSetRGB(16*i, 255 - 16*i, 0)),
+                         16*(i % 4), 16*(i / 4));
+        }
+        c->drawPicture(nested);
+    });
+
+    SkSerialProcs sprocs;
+    sprocs.fImageProc = [](SkImage* img, void*) -> sk_sp<SkData> {
+        return SkPngEncoder::Encode(nullptr, img, {});
+    };
+    sk_sp<SkData> data = pic->serialize(&sprocs);
+    REPORTER_ASSERT(reporter, data);
+
+    // Decode every image to raster up front, counting the decodes.
+    std::atomic<int> decodes{0};
+    SkDeserialProcs dprocs;
+    dprocs.fImageDataProc = [](sk_sp<SkData> encoded, std::optional<SkAlphaType> alphaType,
+                               void* ctx) -> sk_sp<SkImage> {
+        ++*(std::atomic<int>*)ctx;
+        sk_sp<SkImage> image = SkImages::DeferredFromEncodedData(std::move(encoded), alphaType);
+        return image ? image->makeRasterImage() : nullptr;
+    };
+    dprocs.fImageCtx = &decodes;
+
+    sk_sp<SkPicture> serial = SkPicture::MakeFromData(data.get(), &dprocs);
+    REPORTER_ASSERT(reporter, serial);
+    const int serialDecodes = decodes.exchange(0);
+    REPORTER_ASSERT(reporter, serialDecodes == 36, "%d decodes", serialDecodes);
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    dprocs.fExecutor = executor.get();
+    sk_sp<SkPicture> threaded = SkPicture::MakeFromData(data.get(), &dprocs);
+    REPORTER_ASSERT(reporter, threaded);
+    REPORTER_ASSERT(reporter, decodes == serialDecodes);
+    if (serial && threaded) {
+        REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(picture_to_image(serial).get(),
+                                                          picture_to_image(threaded).get()));
+    }
+}
+
+DEF_TEST(serial_procs_image_executor_mipmaps, reporter) {
+    // A plain image read after a mipmapped one must not pick up the first one's levels.
+    sk_sp<SkImage> mipmapped = make_solid_image(SK_ColorRED)->withDefaultMipmaps();
+    sk_sp<SkImage> plain = make_solid_image(SK_ColorGREEN);
+    REPORTER_ASSERT(reporter, mipmapped->hasMipmaps() && !plain->hasMipmaps());
+    const SkSamplingOptions sampling(SkFilterMode::kNearest, SkMipmapMode::kNearest);
+    auto pic = make_pic([&](SkCanvas* c) {
+        c->drawImageRect(mipmapped, SkRect::MakeXYWH(0, 0, 4, 4), sampling);
+        c->drawImageRect(plain, SkRect::MakeXYWH(8, 0, 4, 4), sampling);
+    });
+
+    SkSerialProcs sprocs;
+    sprocs.fImageProc = [](SkImage* img, void*) -> sk_sp<SkData> {
+        return SkPngEncoder::Encode(nullptr, img, {});
+    };
+    sk_sp<SkData> data = pic->serialize(&sprocs);
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(2);
+    SkDeserialProcs dprocs;
+    dprocs.fExecutor = executor.get();
+    sk_sp<SkPicture> threaded = SkPicture::MakeFromData(data.get(), &dprocs);
+    REPORTER_ASSERT(reporter, threaded);
+    if (!threaded) {
+        return;
+    }
+    SkPixmap pixmap;
+    sk_sp<SkImage> image = picture_to_image(threaded);
+    REPORTER_ASSERT(reporter, image->peekPixels(&pixmap));
+    REPORTER_ASSERT(reporter, pixmap.getColor(1, 1) == SK_ColorRED);
+    REPORTER_ASSERT(reporter, pixmap.getColor(9, 1) == SK_ColorGREEN);
+}
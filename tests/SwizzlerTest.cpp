@@ -16,6 +16,7 @@
 
 #include <cstdint>
 #include <cstring>
+#include <iterator>
 #include <memory>
 
 static void check_fill(skiatest::Reporter* r,
@@ -160,6 +161,53 @@ DEF_TEST(PublicSwizzleOpts, r) {
     REPORTER_ASSERT(r, dst == 0xFA04B0CE);
 }
 
+DEF_TEST(SwizzleOptsSampled, r) {
+    // Compare each sampled swizzle against its unsampled counterpart run one pixel at a time.
+    // The widths straddle the 8 pixel vector loop to exercise the tails.
+    static constexpr int kMaxWidth = 19;
+    uint8_t src[kMaxWidth * 8 * 4];
+    for (size_t i = 0; i < std::size(src); i++) {
+        src[i] = (uint8_t)(i * 37 + 11);
+    }
+
+    struct {
+        SkOpts::Swizzle_8888_sampled sampled;
+        SkOpts::Swizzle_8888_u32     fn_u32;
+        SkOpts::Swizzle_8888_u8      fn_u8;
+        int                          bpp;
+    } kSwizzles[] = {
+        { SkOpts::RGBA_to_BGRA_sampled, SkOpts::RGBA_to_BGRA, nullptr,              4 },
+        { SkOpts::RGBA_to_rgbA_sampled, SkOpts::RGBA_to_rgbA, nullptr,              4 },
+        { SkOpts::RGBA_to_bgrA_sampled, SkOpts::RGBA_to_bgrA, nullptr,              4 },
+        { SkOpts::RGB_to_RGB1_sampled,  nullptr,              SkOpts::RGB_to_RGB1,  3 },
+        { SkOpts::RGB_to_BGR1_sampled,  nullptr,              SkOpts::RGB_to_BGR1,  3 },
+        { SkOpts::gray_to_RGB1_sampled, nullptr,              SkOpts::gray_to_RGB1, 1 },
+    };
+
+    for (const auto& swizzle : kSwizzles) {
+        for (int sampleX : {2, 4, 8}) {
+            for (int width = 1; width <= kMaxWidth; width++) {
+                uint32_t dst[kMaxWidth];
+                swizzle.sampled(dst, src, width, sampleX);
+                for (int x = 0; x < width; x++) {
+                    const uint8_t* px = src + x * sampleX * swizzle.bpp;
+                    uint32_t expected;
+                    if (swizzle.fn_u32) {
+                        uint32_t px32;
+                        memcpy(&px32, px, 4);
+                        swizzle.fn_u32(&expected, &px32, 1);
+                    } else {
+                        swizzle.fn_u8(&expected, px, 1);
+                    }
+                    REPORTER_ASSERT(r, dst[x] == expected,
+                                    "sampleX %d width %d x %d: %08x != %08x",
+                                    sampleX, width, x, dst[x], expected);
+                }
+            }
+        }
+    }
+}
+
 using fn_reciprocal = float (*)(float);
 static void test_reciprocal_alpha(
         skiatest::Reporter* reporter,
@@ -35,6 +35,7 @@ CORE_TESTS = [
     "CubicMapTest.cpp",
     "DashPathEffectTest.cpp",
     "DataRefTest.cpp",
+    "DecodedImageCacheTest.cpp",
     "DequeTest.cpp",
     "DescriptorTest.cpp",
     "DrawBitmapRectTest.cpp",
@@ -87,6 +88,7 @@ CORE_TESTS = [
     "PathCoverageTest.cpp",
     "PathMeasureTest.cpp",
     "PictureBBHTest.cpp",
+    "PictureDeltaTest.cpp",
     "PictureShaderTest.cpp",
     "PixelRefTest.cpp",
     "Point3Test.cpp",
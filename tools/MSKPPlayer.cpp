@@ -11,6 +11,7 @@
 #include "include/core/SkCanvasVirtualEnforcer.h"
 #include "include/core/SkPicture.h"
 #include "include/core/SkPictureRecorder.h"
+#include "include/core/SkStream.h"
 #include "include/core/SkSurface.h"
 #include "include/gpu/GrDirectContext.h"
 #include "include/private/base/SkTArray.h"
@@ -384,30 +385,35 @@ private:
 ///////////////////////////////////////////////////////////////////////////////
 
 std::unique_ptr<MSKPPlayer> MSKPPlayer::Make(SkStreamSeekable* stream) {
+    if (!stream) {
+        return nullptr;
+    }
     auto deserialContext = std::make_unique<SkSharingDeserialContext>();
     SkDeserialProcs procs;
     procs.fImageProc = SkSharingDeserialContext::deserializeImage;
     procs.fImageCtx = deserialContext.get();
 
-    int pageCount = SkMultiPictureDocument::ReadPageCount(stream);
-    if (!pageCount) {
-        return nullptr;
-    }
-    std::vector<SkDocumentPage> pages(pageCount);
-    if (!SkMultiPictureDocument::Read(stream, pages.data(), pageCount, &procs)) {
+    // The sharing procs need the pages read in order, and each is only read once, so there's no
+    // need to keep any but the current one.
+    auto reader = SkMultiPictureDocument::Reader::Make(stream->duplicate(), &procs,
+                                                       /*maxCachedPages=*/1);
+    if (!reader) {
         return nullptr;
     }
     std::unique_ptr<MSKPPlayer> result(new MSKPPlayer);
-    result->fRootLayers.reserve(pages.size());
-    for (const auto& page : pages) {
-        SkISize dims = {SkScalarCeilToInt(page.fSize.width()),
-                        SkScalarCeilToInt(page.fSize.height())};
+    result->fRootLayers.reserve(reader->pageCount());
+    for (int i = 0; i < reader->pageCount(); ++i) {
+        sk_sp<SkPicture> page = reader->readPage(i);
+        if (!page) {
+            return nullptr;
+        }
+        SkISize dims = reader->pageSize(i).toCeil();
         result->fRootLayers.emplace_back();
         result->fRootLayers.back().fDimensions = dims;
         result->fMaxDimensions.fWidth  = std::max(dims.width() , result->fMaxDimensions.width() );
         result->fMaxDimensions.fHeight = std::max(dims.height(), result->fMaxDimensions.height());
         CmdRecordCanvas sc(&result->fRootLayers.back(), &result->fOffscreenLayers);
-        page.fPicture->playback(&sc);
+        page->playback(&sc);
     }
     return result;
 }